@@ -0,0 +1,102 @@
+#include "HMS_PN532_ComInterface.h"
+
+uint16_t HMS_PN532_Interface::encodeFrame(uint8_t *frame, const HMS_PN532_SegmentTypeDef *segments, uint8_t count, uint8_t tfi) {
+    uint16_t length = 1;                                                                                                        // TFI
+    for (uint8_t i = 0; i < count; i++) length += segments[i].len;
+
+    uint16_t pos = 0;
+    frame[pos++] = HMS_PN532_PREAMBLE;
+    frame[pos++] = HMS_PN532_STARTCODE1;
+    frame[pos++] = HMS_PN532_STARTCODE2;
+
+    if (length <= HMS_PN532_NORMAL_INFO_MAX) {
+        frame[pos++] = (uint8_t)length;
+        frame[pos++] = (uint8_t)(~length + 1);
+    } else {
+    #if HMS_PN532_EXTENDED_FRAMES
+        if (length > HMS_PN532_EXTENDED_INFO_MAX) return 0;
+        frame[pos++] = HMS_PN532_EXTENDED_LEN;                                                                                  // 00 00 FF FF FF LENm LENl LCS
+        frame[pos++] = HMS_PN532_EXTENDED_LEN;
+        frame[pos++] = (uint8_t)(length >> 8);
+        frame[pos++] = (uint8_t)length;
+        frame[pos++] = (uint8_t)(~((length >> 8) + length) + 1);
+    #else
+        return 0;
+    #endif
+    }
+
+    frame[pos++] = tfi;
+
+    uint8_t sum = tfi;
+    for (uint8_t i = 0; i < count; i++) {
+        const uint8_t *data = segments[i].data;
+        for (uint16_t j = 0; j < segments[i].len; j++) {
+            frame[pos++] = data[j];
+            sum += data[j];
+        }
+    }
+
+    frame[pos++] = (uint8_t)(~sum + 1);
+    frame[pos++] = HMS_PN532_POSTAMBLE;
+    return pos;                                                                                                                 // Frame length, 0 if the payload does not fit
+}
+
+uint16_t HMS_PN532_Interface::frameLength(const uint8_t *frame) {
+    if (frame[0] != HMS_PN532_PREAMBLE   ||
+        frame[1] != HMS_PN532_STARTCODE1 ||
+        frame[2] != HMS_PN532_STARTCODE2
+    )   return 0;
+
+    if (frameHeaderLength(frame) == 5) return 5 + frame[3] + 2;
+
+    uint16_t length = ((uint16_t)frame[5] << 8) | frame[6];
+    if (length > HMS_PN532_EXTENDED_INFO_MAX) return 0;                                                                         // Keeps a corrupt LENm/LENl from sizing a read
+    return 8 + length + 2;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface::parseFrame(const uint8_t *frame, uint8_t command, uint8_t *buffer, uint16_t len, uint16_t &resLen) {
+    if (frame[0] != HMS_PN532_PREAMBLE   ||                                                                                    // Validate frame header
+        frame[1] != HMS_PN532_STARTCODE1 ||
+        frame[2] != HMS_PN532_STARTCODE2
+    )   return HMS_PN532_INVALID_FRAME;
+
+    uint8_t headerLen = frameHeaderLength(frame);
+    uint16_t length;
+
+    if (headerLen == 5) {
+        length = frame[3];
+        if ((uint8_t)(length + frame[4]) != 0) return HMS_PN532_INVALID_FRAME;
+    } else {
+        length = ((uint16_t)frame[5] << 8) | frame[6];
+        if ((uint8_t)(frame[5] + frame[6] + frame[7]) != 0) return HMS_PN532_INVALID_FRAME;
+    }
+
+    if (length < 2) return HMS_PN532_INVALID_FRAME;
+
+    uint8_t tfi = frame[headerLen];
+    uint8_t cmd = frame[headerLen + 1];
+
+    if (tfi != HMS_PN532_PN532TOHOST || cmd != (uint8_t)(command + 1)) return HMS_PN532_INVALID_FRAME;
+
+    length -= 2;
+    if (length > len) return HMS_PN532_NO_SPACE;
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.debug("Frame CMD: %02X, DataLen: %u", cmd, length);
+    #endif
+
+    const uint8_t *payload = frame + headerLen + 2;
+    uint8_t sum = tfi + cmd;
+    for (uint16_t i = 0; i < length; i++) sum += payload[i];
+
+    if ((uint8_t)(sum + payload[length]) != 0) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("Checksum mismatch (sum=0x%02X, chk=0x%02X)", sum, payload[length]);
+        #endif
+        return HMS_PN532_INVALID_FRAME;
+    }
+
+    memcpy(buffer, payload, length);
+    resLen = length;
+    return HMS_PN532_OK;
+}
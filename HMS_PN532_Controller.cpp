@@ -1,15 +1,309 @@
 #include "HMS_PN532_Controller.h"
 
-HMS_PN532_Controller::HMS_PN532_Controller(HMS_PN532_Interface &interface) : interface(&interface) {}
+HMS_PN532_Controller::HMS_PN532_Controller(HMS_PN532_Interface &interface) : interface(&interface) {
+  #if HMS_PN532_THREAD_SAFE
+    #if defined(HMS_PLATFORM_ESP_IDF) || defined(HMS_PN532_ARDUINO_ESP32)
+      commandLock = xSemaphoreCreateRecursiveMutex();
+    #elif defined(HMS_PLATFORM_ZEPHYR)
+      k_mutex_init(&commandLock);
+    #endif
+  #endif
+}
+
+HMS_PN532_Controller::~HMS_PN532_Controller() {
+  #if HMS_PN532_THREAD_SAFE && (defined(HMS_PLATFORM_ESP_IDF) || defined(HMS_PN532_ARDUINO_ESP32))
+    if (commandLock) vSemaphoreDelete(commandLock);
+  #endif
+}
 
-HMS_PN532_Controller::~HMS_PN532_Controller() {}
+void HMS_PN532_Controller::lock() {
+  #if HMS_PN532_THREAD_SAFE
+    #if defined(HMS_PLATFORM_DESKTOP)
+      commandLock.lock();
+    #elif defined(HMS_PLATFORM_ESP_IDF) || defined(HMS_PN532_ARDUINO_ESP32)
+      xSemaphoreTakeRecursive(commandLock, portMAX_DELAY);
+    #elif defined(HMS_PLATFORM_ZEPHYR)
+      k_mutex_lock(&commandLock, K_FOREVER);
+    #endif
+  #endif
+}
+
+void HMS_PN532_Controller::unlock() {
+  #if HMS_PN532_THREAD_SAFE
+    #if defined(HMS_PLATFORM_DESKTOP)
+      commandLock.unlock();
+    #elif defined(HMS_PLATFORM_ESP_IDF) || defined(HMS_PN532_ARDUINO_ESP32)
+      xSemaphoreGiveRecursive(commandLock);
+    #elif defined(HMS_PLATFORM_ZEPHYR)
+      k_mutex_unlock(&commandLock);
+    #endif
+  #endif
+}
 
 void HMS_PN532_Controller::begin() {
+  HMS_PN532_ControllerLock guard(*this);
+  authSector = -1;
   interface->init();
   interface->wakeup();
 }
 
+HMS_PN532_CommandHandle HMS_PN532_Controller::submit(const HMS_PN532_CommandTypeDef &command) {
+  HMS_PN532_ControllerLock guard(*this);
+  HMS_PN532_CommandSlotTypeDef *slot = nullptr;
+
+  for (uint8_t i = 0; i < HMS_PN532_ASYNC_QUEUE_LEN; i++) {                                       // Prefer a free slot, else reclaim the oldest finished one
+    HMS_PN532_CommandSlotTypeDef *candidate = &commandSlots[i];
+    if (candidate->state == HMS_PN532_COMMAND_FREE) {
+      slot = candidate;
+      break;
+    }
+    if (candidate->state == HMS_PN532_COMMAND_DONE &&
+        (!slot || (int16_t)(candidate->handle - slot->handle) < 0)) {
+      slot = candidate;
+    }
+  }
+
+  if (!slot) {
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.warn("Command queue full");
+    #endif
+    return 0;
+  }
+
+  slot->command     = command;
+  slot->handle      = nextHandle++;
+  slot->state       = HMS_PN532_COMMAND_QUEUED;
+  slot->status      = HMS_PN532_BUSY;
+  slot->responseLen = 0;
+  if (nextHandle == 0) nextHandle = 1;
+
+  return slot->handle;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::poll() {
+  HMS_PN532_ControllerLock guard(*this);
+  if (!activeSlot) return startNext() ? HMS_PN532_BUSY : HMS_PN532_OK;
+
+  uint16_t timeoutMs = activeSlot->command.timeoutMs;
+  uint32_t elapsed   = interface->pn532Millis() - activeSlot->startedAt;
+
+  if (!interface->isResponseReady()) {
+    if (timeoutMs != 0 && elapsed >= timeoutMs) {
+      #if HMS_PN532_METRICS_ENABLED
+        interface->getMetrics().recordTimeout(activeSlot->code);
+      #endif
+      completeCommand(activeSlot, HMS_PN532_TIMEOUT, 0);
+    }
+    return HMS_PN532_BUSY;
+  }
+
+  finishActive();                                                                                 // Response is ready, this only covers a frame still arriving
+  return HMS_PN532_BUSY;
+}
+
+bool HMS_PN532_Controller::startNext() {
+  for (uint8_t i = 0; i < HMS_PN532_ASYNC_QUEUE_LEN; i++) {                                       // Oldest queued command goes next
+    HMS_PN532_CommandSlotTypeDef *candidate = &commandSlots[i];
+    if (candidate->state == HMS_PN532_COMMAND_QUEUED &&
+        (!activeSlot || (int16_t)(candidate->handle - activeSlot->handle) < 0)) {
+      activeSlot = candidate;
+    }
+  }
+  if (!activeSlot) return false;
+
+  #if HMS_PN532_METRICS_ENABLED
+    uint16_t bytesOut = 0;
+    activeSlot->code  = 0;
+    for (uint8_t i = activeSlot->command.segmentCount; i > 0; i--) {                               // First byte of the first non-empty segment is the command code
+      const HMS_PN532_SegmentTypeDef &segment = activeSlot->command.segments[i - 1];
+      bytesOut += segment.len;
+      if (segment.len) activeSlot->code = segment.data[0];
+    }
+    uint32_t writeStart = interface->pn532Micros();
+  #endif
+
+  HMS_PN532_StatusTypeDef status = interface->write(activeSlot->command.segments, activeSlot->command.segmentCount);
+
+  #if HMS_PN532_METRICS_ENABLED
+    activeSlot->ackedAtUs = interface->pn532Micros();
+    interface->getMetrics().recordWrite(activeSlot->code, bytesOut, status, activeSlot->ackedAtUs - writeStart);
+  #endif
+
+  if (status != HMS_PN532_OK) {                                                                   // No ACK, the PN532 never started it
+    completeCommand(activeSlot, status, 0);
+    return true;
+  }
+
+  activeSlot->state     = HMS_PN532_COMMAND_PENDING;
+  activeSlot->startedAt = interface->pn532Millis();
+  return true;
+}
+
+void HMS_PN532_Controller::finishActive() {
+  uint16_t timeoutMs   = activeSlot->command.timeoutMs;
+  uint32_t elapsed     = interface->pn532Millis() - activeSlot->startedAt;
+  uint16_t readTimeout = 0;                                                                       // What is left of the command timeout, 0 still waits forever
+
+  if (timeoutMs != 0) readTimeout = (elapsed < timeoutMs) ? (uint16_t)(timeoutMs - elapsed) : 1;
+
+  uint16_t responseLen = 0;
+  HMS_PN532_StatusTypeDef status;
+
+  #if HMS_PN532_METRICS_ENABLED
+    status = interface->waitResponseReady(readTimeout);                                           // Waited apart from read(), so ready and transfer are timed separately
+    uint32_t readStart = interface->pn532Micros();
+
+    if (status != HMS_PN532_OK) {
+      interface->getMetrics().recordRead(activeSlot->code, 0, status, readStart - activeSlot->ackedAtUs, 0);
+      completeCommand(activeSlot, status, 0);
+      return;
+    }
+
+    elapsed = interface->pn532Millis() - activeSlot->startedAt;
+    if (timeoutMs != 0) readTimeout = (elapsed < timeoutMs) ? (uint16_t)(timeoutMs - elapsed) : 1;
+  #endif
+
+  status = interface->read(activeSlot->command.response, activeSlot->command.responseSize, responseLen, readTimeout);
+
+  #if HMS_PN532_METRICS_ENABLED
+    interface->getMetrics().recordRead(
+      activeSlot->code, status == HMS_PN532_OK ? responseLen + 2 : 0, status, readStart - activeSlot->ackedAtUs, interface->pn532Micros() - readStart
+    );                                                                                            // +2: TFI and response code
+  #endif
+
+  completeCommand(activeSlot, status, responseLen);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::waitUntil(HMS_PN532_CommandHandle handle, uint32_t timeoutMs, uint16_t *responseLen) {
+  uint32_t start = interface->pn532Millis();
+
+  while (true) {
+    HMS_PN532_StatusTypeDef status = getCommandStatus(handle, responseLen);
+    if (status != HMS_PN532_BUSY) return status;
+
+    if (poll() == HMS_PN532_BUSY) {
+      status = getCommandStatus(handle, responseLen);
+      if (status != HMS_PN532_BUSY) return status;
+    }
+
+    if (timeoutMs != 0 && (interface->pn532Millis() - start) >= timeoutMs) return HMS_PN532_TIMEOUT;
+    interface->pn532Delay(1);
+  }
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::getCommandStatus(HMS_PN532_CommandHandle handle, uint16_t *responseLen) {
+  HMS_PN532_ControllerLock guard(*this);
+  HMS_PN532_CommandSlotTypeDef *slot = findSlot(handle);
+
+  if (!slot) return HMS_PN532_NOT_FOUND;                                                          // Unknown, or its slot was reclaimed
+  if (slot->state != HMS_PN532_COMMAND_DONE) return HMS_PN532_BUSY;
+
+  if (responseLen) *responseLen = slot->responseLen;
+  return slot->status;
+}
+
+HMS_PN532_CommandSlotTypeDef *HMS_PN532_Controller::findSlot(HMS_PN532_CommandHandle handle) {
+  if (handle == 0) return nullptr;
+
+  for (uint8_t i = 0; i < HMS_PN532_ASYNC_QUEUE_LEN; i++) {
+    if (commandSlots[i].state != HMS_PN532_COMMAND_FREE && commandSlots[i].handle == handle) return &commandSlots[i];
+  }
+  return nullptr;
+}
+
+void HMS_PN532_Controller::completeCommand(HMS_PN532_CommandSlotTypeDef *slot, HMS_PN532_StatusTypeDef status, uint16_t responseLen) {
+  slot->state       = HMS_PN532_COMMAND_DONE;
+  slot->status      = status;
+  slot->responseLen = responseLen;
+  if (slot == activeSlot) activeSlot = nullptr;
+
+  #if HMS_PN532_DEBUG_ENABLED
+    if (status != HMS_PN532_OK) pn532Logger.debug("Command %u finished with status %d", slot->handle, status);
+  #endif
+
+  if (slot->command.callback) {                                                                   // Last, so the callback may submit the next command
+    slot->command.callback(slot->handle, status, slot->command.response, responseLen, slot->command.context);
+  }
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::transceive(
+  const HMS_PN532_SegmentTypeDef *segments, uint8_t count, uint8_t *response, uint16_t responseSize,
+  uint16_t timeoutMs, uint16_t *responseLen
+) {
+  HMS_PN532_ControllerLock guard(*this);
+  HMS_PN532_CommandTypeDef command = { segments, count, response, responseSize, timeoutMs, nullptr, nullptr };
+  uint8_t head[4] = { 0 };                                                                        // Code, Tg, MIFARE command, block
+  uint8_t headLen = 0;
+
+  for (uint8_t i = 0; i < count && headLen < sizeof(head); i++) {                                // Copied now, the response may overwrite the request
+    for (uint16_t j = 0; j < segments[i].len && headLen < sizeof(head); j++) head[headLen++] = segments[i].data[j];
+  }
+
+  HMS_PN532_CommandHandle handle = submit(command);
+  if (handle == 0) return HMS_PN532_BUSY;
+
+  uint16_t received = 0;
+  HMS_PN532_StatusTypeDef status;
+  while ((status = getCommandStatus(handle, &received)) == HMS_PN532_BUSY) {                      // Commands submitted earlier still run first, in order
+    if (!activeSlot) startNext();
+    else finishActive();                                                                          // Blocks inside the interface: IRQ wait or its own status polling
+  }
+
+  HMS_PN532_CommandSlotTypeDef *slot = findSlot(handle);
+  if (slot) slot->state = HMS_PN532_COMMAND_FREE;                                                 // Result consumed, nobody else holds this handle
+
+  if (responseLen) *responseLen = received;
+  trackAuthState(head, status, response, received);
+  return status;
+}
+
+void HMS_PN532_Controller::trackAuthState(
+  const uint8_t *frame, HMS_PN532_StatusTypeDef status, const uint8_t *response, uint16_t responseLen
+) {
+  if (authSector < 0) return;
+
+  switch (frame[0]) {
+    case HMS_PN532_COMMAND_DIAGNOSE:
+    case HMS_PN532_COMMAND_GETFIRMWAREVERSION:
+    case HMS_PN532_COMMAND_GETGENERALSTATUS:
+    case HMS_PN532_COMMAND_READREGISTER:
+    case HMS_PN532_COMMAND_READGPIO:
+    case HMS_PN532_COMMAND_WRITEGPIO:
+      return;                                                                                     // Never reach the card
+
+    case HMS_PN532_COMMAND_INDATAEXCHANGE:
+      if (frame[2] == HMS_PN532_MIFARE_CMD_AUTH_A || frame[2] == HMS_PN532_MIFARE_CMD_AUTH_B) break;  // mifareclassicAuthenticateBlock() re-arms it
+      if (frame[2] == HMS_PN532_MIFARE_CMD_WRITE && mifareclassicIsTrailerBlock(frame[3]) == HMS_PN532_OK) break;    // Keys or access bits may have changed
+      if (status == HMS_PN532_OK && responseLen > 0 && (response[0] & 0x3f) == 0) return;
+      break;                                                                                      // A failed exchange halts a Classic card
+
+    default:
+      break;                                                                                      // New targets, InSelect/InRelease, RF field, PowerDown, raw frames
+  }
+
+  authSector = -1;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::transceive(uint16_t requestLen, uint16_t timeoutMs, uint16_t *responseLen) {
+  const HMS_PN532_SegmentTypeDef request = { pn532_packetbuffer, requestLen };
+  return transceive(&request, 1, pn532_packetbuffer, sizeof(pn532_packetbuffer), timeoutMs, responseLen);
+}
+
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareultralightReadPage (uint8_t page, uint8_t *buffer) {
+    HMS_PN532_ControllerLock guard(*this);
+    HMS_PN532_ResponseView view;
+
+    if (mifareultralightReadPage(page, view) != HMS_PN532_OK) {
+        return HMS_PN532_ERROR;
+    }
+
+    view.copyTo(buffer, 4);
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareultralightReadPage (uint8_t page, HMS_PN532_ResponseView &buffer) {
+    HMS_PN532_ControllerLock guard(*this);
+
     if (page >= 64) {
       #if HMS_PN532_DEBUG_ENABLED
         pn532Logger.error("Page value out of range");
@@ -17,68 +311,75 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareultralightReadPage (uint8_t
         return HMS_PN532_ERROR;
     }
 
+    if (mifareultralightReadPages(page, buffer) != HMS_PN532_OK) {
+        return HMS_PN532_ERROR;
+    }
+
+    buffer = HMS_PN532_ResponseView(buffer.data(), 4);                          /* First of the four pages READ returned */
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareultralightReadPages (uint8_t page, uint8_t *buffer) {
+    HMS_PN532_ControllerLock guard(*this);
+    HMS_PN532_ResponseView view;
+
+    if (mifareultralightReadPages(page, view) != HMS_PN532_OK) {
+        return HMS_PN532_ERROR;
+    }
+
+    view.copyTo(buffer, 16);
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareultralightReadPages (uint8_t page, HMS_PN532_ResponseView &buffer) {
+    HMS_PN532_ControllerLock guard(*this);
+    uint16_t responseLen = 0;
+
     /* Prepare the command */
     pn532_packetbuffer[0] = HMS_PN532_COMMAND_INDATAEXCHANGE;
-    pn532_packetbuffer[1] = 1;                   /* Card number */
+    pn532_packetbuffer[1] = inListedTag;         /* Card number */
     pn532_packetbuffer[2] = HMS_PN532_MIFARE_CMD_READ;     /* Mifare Read command = 0x30 */
-    pn532_packetbuffer[3] = page;                /* Page Number (0..63 in most cases) */
+    pn532_packetbuffer[3] = page;                /* First page, the tag rolls over past its last one */
 
-    /* Send the command */
-    if (interface->write(pn532_packetbuffer, 4) != HMS_PN532_OK) {
+    /* Send the command and read the response packet */
+    if (transceive(4, 1000, &responseLen) != HMS_PN532_OK || responseLen < 17) {
         return HMS_PN532_ERROR;
     }
 
-    /* Read the response packet */
-    interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer));
-
-    /* If byte 8 isn't 0x00 we probably have an error */
-    if (pn532_packetbuffer[0] == 0x00) {
-        /* Copy the 4 data bytes to the output buffer         */
-        /* Block content starts at byte 9 of a valid response */
-        /* Note that the command actually reads 16 bytes or 4  */
-        /* pages at a time ... we simply discard the last 12  */
-        /* bytes                                              */
-        memcpy (buffer, pn532_packetbuffer + 1, 4);
-    } else {
+    /* If the status byte isn't 0x00 the tag NAKed the read */
+    if (pn532_packetbuffer[0] != 0x00) {
         return HMS_PN532_ERROR;
     }
 
-    // Return OK signal
+    buffer = HMS_PN532_ResponseView(pn532_packetbuffer + 1, 16);                /* Pages page .. page + 3, in place */
     return HMS_PN532_OK;
 }
 
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareultralightWritePage (uint8_t page, uint8_t *buffer) {
+  HMS_PN532_ControllerLock guard(*this);
   /* Prepare the first command */
   pn532_packetbuffer[0] = HMS_PN532_COMMAND_INDATAEXCHANGE;
-  pn532_packetbuffer[1] = 1;                           /* Card number */
+  pn532_packetbuffer[1] = inListedTag;                 /* Card number */
   pn532_packetbuffer[2] = HMS_PN532_MIFARE_CMD_WRITE_ULTRALIGHT; /* Mifare UL Write cmd = 0xA2 */
   pn532_packetbuffer[3] = page;                        /* page Number (0..63) */
   memcpy (pn532_packetbuffer + 4, buffer, 4);          /* Data Payload */
 
-  /* Send the command */
-  if (interface->write(pn532_packetbuffer, 8) != HMS_PN532_OK) {
-    return HMS_PN532_ERROR;
-  }
-
-  /* Read the response packet */
-  return interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer));
+  /* Send the command and read the response packet */
+  return transceive(8);
 }
 
 
 uint32_t HMS_PN532_Controller::getFirmwareVersion() {
+    HMS_PN532_ControllerLock guard(*this);
     uint32_t response;
 
     pn532_packetbuffer[0] = HMS_PN532_COMMAND_GETFIRMWAREVERSION;
 
-    if (interface->write(pn532_packetbuffer, 1) != HMS_PN532_OK) {
+    if (transceive(1) != HMS_PN532_OK) {
         return 0;
     }
 
-    if (interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer)) != HMS_PN532_OK) {  // read data packet
-      return 0;
-    }
-
     response = pn532_packetbuffer[0];
     response <<= 8;
     response |= pn532_packetbuffer[1];
@@ -91,6 +392,7 @@ uint32_t HMS_PN532_Controller::getFirmwareVersion() {
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::samConfig() {
+    HMS_PN532_ControllerLock guard(*this);
     pn532_packetbuffer[0] = HMS_PN532_COMMAND_SAMCONFIGURATION;
     pn532_packetbuffer[1] = 0x01;                       // normal mode;
     pn532_packetbuffer[2] = 0x14;                       // timeout 50ms * 20 = 1 second
@@ -100,20 +402,15 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::samConfig() {
         pn532Logger.debug("Configurating SAM");
     #endif
 
-    if (interface->write(pn532_packetbuffer, 4) != HMS_PN532_OK)
-        return HMS_PN532_ERROR;
-
-    return interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer));
+    return transceive(4);
 }
 
 uint8_t HMS_PN532_Controller::readGPIO() {
+    HMS_PN532_ControllerLock guard(*this);
     pn532_packetbuffer[0] = HMS_PN532_COMMAND_READGPIO;
 
     // Send the READGPIO command (0x0C)
-    if (interface->write(pn532_packetbuffer, 1) != HMS_PN532_OK)
-        return 0x0;
-
-    if (interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer)) != HMS_PN532_OK)
+    if (transceive(1) != HMS_PN532_OK)
         return 0x0;
    /* READGPIO response without prefix and suffix should be in the following format:
 
@@ -134,6 +431,7 @@ uint8_t HMS_PN532_Controller::readGPIO() {
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::writeGPIO(uint8_t pinstate) {
+    HMS_PN532_ControllerLock guard(*this);
     // Make sure pinstate does not try to toggle P32 or P34
     pinstate |= (1 << HMS_PN532_GPIO_P32) | (1 << HMS_PN532_GPIO_P34);
 
@@ -147,25 +445,18 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::writeGPIO(uint8_t pinstate) {
     #endif
 
     // Send the WRITEGPIO command (0x0E)
-    if (interface->write(pn532_packetbuffer, 3) != HMS_PN532_OK)
-        return HMS_PN532_ERROR;
-
-    return interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer));
+    return transceive(3);
 }
 
 uint32_t HMS_PN532_Controller::readRegister(uint16_t registerAddress) {
+    HMS_PN532_ControllerLock guard(*this);
     uint32_t response;
 
     pn532_packetbuffer[0] = HMS_PN532_COMMAND_READREGISTER;
     pn532_packetbuffer[1] = (registerAddress >> 8) & 0xFF;
     pn532_packetbuffer[2] = registerAddress & 0xFF;
 
-    if (interface->write(pn532_packetbuffer, 3) != HMS_PN532_OK) {
-        return 0;
-    }
-
-    // read data packet
-    if (interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer)) != HMS_PN532_OK) {
+    if (transceive(3) != HMS_PN532_OK) {
         return 0;
     }
 
@@ -175,6 +466,7 @@ uint32_t HMS_PN532_Controller::readRegister(uint16_t registerAddress) {
 }
 
 uint32_t HMS_PN532_Controller::writeRegister(uint16_t registerAddress, uint8_t value) {
+    HMS_PN532_ControllerLock guard(*this);
     uint32_t response;
 
     pn532_packetbuffer[0] = HMS_PN532_COMMAND_WRITEREGISTER;
@@ -183,12 +475,7 @@ uint32_t HMS_PN532_Controller::writeRegister(uint16_t registerAddress, uint8_t v
     pn532_packetbuffer[3] = value;
 
 
-    if (interface->write(pn532_packetbuffer, 4) != HMS_PN532_OK) {
-        return 0;
-    }
-
-    // read data packet
-    if (interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer)) != HMS_PN532_OK) {
+    if (transceive(4) != HMS_PN532_OK) {
         return 0;
     }
 
@@ -198,31 +485,49 @@ uint32_t HMS_PN532_Controller::writeRegister(uint16_t registerAddress, uint8_t v
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::setRFField(uint8_t autoRFCA, uint8_t rFOnOff) {
+  HMS_PN532_ControllerLock guard(*this);
   pn532_packetbuffer[0] = HMS_PN532_COMMAND_RFCONFIGURATION;
   pn532_packetbuffer[1] = 1;
   pn532_packetbuffer[2] = 0x00 | autoRFCA | rFOnOff;  
 
-  if (interface->write(pn532_packetbuffer, 3) != HMS_PN532_OK) {
-      return HMS_PN532_ERROR;
-  }
-
-  return interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer));
+  return transceive(3);
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::setPassiveActivationRetries(uint8_t maxRetries) {
+  HMS_PN532_ControllerLock guard(*this);
   pn532_packetbuffer[0] = HMS_PN532_COMMAND_RFCONFIGURATION;
   pn532_packetbuffer[1] = 5;    // Config item 5 (MaxRetries)
   pn532_packetbuffer[2] = 0xFF; // MxRtyATR (default = 0xFF)
   pn532_packetbuffer[3] = 0x01; // MxRtyPSL (default = 0x01)
   pn532_packetbuffer[4] = maxRetries;
 
-  if (interface->write(pn532_packetbuffer, 5) != HMS_PN532_OK)
+  return transceive(5);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::powerDown(uint8_t wakeUpEnable, bool generateIrq) {
+  HMS_PN532_ControllerLock guard(*this);
+  uint16_t responseLen = 0;
+
+  pn532_packetbuffer[0] = HMS_PN532_COMMAND_POWERDOWN;
+  pn532_packetbuffer[1] = wakeUpEnable;
+  pn532_packetbuffer[2] = generateIrq ? 0x01 : 0x00;  // Pull P70_IRQ low on wake-up
+
+  if (transceive(3, 1000, &responseLen) != HMS_PN532_OK || responseLen < 1) {
     return HMS_PN532_ERROR;
+  }
+
+  if (pn532_packetbuffer[0] & 0x3F) {                   // Error code, e.g. a wake-up source that is not allowed
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("PowerDown refused, status 0x%02X", pn532_packetbuffer[0]);
+    #endif
+    return HMS_PN532_ERROR;
+  }
 
-  return interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer));
+  return HMS_PN532_OK;
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::inListPassiveTarget() {
+  HMS_PN532_ControllerLock guard(*this);
   pn532_packetbuffer[0] = HMS_PN532_COMMAND_INLISTPASSIVETARGET;
   pn532_packetbuffer[1] = 1;
   pn532_packetbuffer[2] = 0;
@@ -231,11 +536,7 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::inListPassiveTarget() {
       pn532Logger.debug("inList passive target");
   #endif
 
-  if (interface->write(pn532_packetbuffer, 3) != HMS_PN532_OK) {
-    return HMS_PN532_ERROR;
-  };
-
-  if (interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer), 30000) != HMS_PN532_OK) {
+  if (transceive(3, 30000) != HMS_PN532_OK) {
     return HMS_PN532_ERROR;
   }
 
@@ -248,48 +549,176 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::inListPassiveTarget() {
   return HMS_PN532_OK;
 }
 
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::inDataExchange(uint8_t *send, uint16_t sendLength, uint8_t *response, uint16_t *responseLength) {
+  HMS_PN532_ControllerLock guard(*this);
+  HMS_PN532_ResponseView view;
+
+  if (inDataExchange(send, sendLength, view) != HMS_PN532_OK) {
+    return HMS_PN532_ERROR;
+  }
+
+  if (view.size() > *responseLength) {
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("inDataExchange: %u byte response, %u byte buffer", view.size(), *responseLength);
+    #endif
+    return HMS_PN532_ERROR;
+  }
+
+  *responseLength = view.copyTo(response, *responseLength);                                        // The only copy, straight past the status byte
+  return HMS_PN532_OK;
+}
+
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::inDataExchange(uint8_t *send, uint8_t sendLength, uint8_t *response, uint8_t *responseLength) {
-  uint8_t i;
+  HMS_PN532_ControllerLock guard(*this);
+  uint16_t length = *responseLength;
+  HMS_PN532_StatusTypeDef status = inDataExchange(send, (uint16_t)sendLength, response, &length);
+  *responseLength = (uint8_t)length;
+  return status;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::inDataExchange(const uint8_t *send, uint16_t sendLength, HMS_PN532_ResponseView &response) {
+  HMS_PN532_ControllerLock guard(*this);
+  uint16_t resLen = 0;
+
+  if (sendLength + 3 > interface->maxInformationLength()) {
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("inDataExchange: %u bytes do not fit one frame", sendLength);
+    #endif
+    return HMS_PN532_INVALID_COMMAND;
+  }
 
-  pn532_packetbuffer[0] = 0x40; // PN532_COMMAND_INDATAEXCHANGE;
+  pn532_packetbuffer[0] = HMS_PN532_COMMAND_INDATAEXCHANGE;
   pn532_packetbuffer[1] = inListedTag;
 
-  if (interface->write(pn532_packetbuffer, 2) != HMS_PN532_OK) {
+  const HMS_PN532_SegmentTypeDef segments[] = {
+    { pn532_packetbuffer, 2          },
+    { send,               sendLength }
+  };
+
+  if (transceive(segments, 2, pn532_packetbuffer, sizeof(pn532_packetbuffer), 1000, &resLen) != HMS_PN532_OK || resLen == 0) {
     return HMS_PN532_ERROR;
   }
 
-  if (interface->read(response, *responseLength, 1000) != HMS_PN532_OK) {
+  if ((pn532_packetbuffer[0] & 0x3f) != 0) {
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("inDataExchange: status is not ok");
+    #endif
     return HMS_PN532_ERROR;
   }
 
-  if ((response[0] & 0x3f) != 0) {
+  response = HMS_PN532_ResponseView(pn532_packetbuffer + 1, resLen - 1);                          // Status byte skipped, nothing shifted
+  return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::inCommunicateThru(
+  const uint8_t *send, uint16_t sendLength, uint8_t *response, uint16_t responseSize, uint16_t *responseLength, uint16_t timeout
+) {
+  HMS_PN532_ControllerLock guard(*this);
+  HMS_PN532_ResponseView view;
+
+  if (inCommunicateThru(send, sendLength, view, timeout) != HMS_PN532_OK) {
+    return HMS_PN532_ERROR;
+  }
+
+  if (view.size() > responseSize) {
     #if HMS_PN532_DEBUG_ENABLED
-      pn532Logger.error("inDataExchange: status is not ok");
+      pn532Logger.error("inCommunicateThru: %u byte response, %u byte buffer", view.size(), responseSize);
+    #endif
+    return HMS_PN532_ERROR;
+  }
+
+  *responseLength = view.copyTo(response, responseSize);
+  return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::inCommunicateThru(
+  const uint8_t *send, uint16_t sendLength, HMS_PN532_ResponseView &response, uint16_t timeout
+) {
+  HMS_PN532_ControllerLock guard(*this);
+  uint16_t resLen = 0;
+  const uint8_t command = HMS_PN532_COMMAND_INCOMMUNICATETHRU;
+
+  if (sendLength + 2 > interface->maxInformationLength()) {
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("inCommunicateThru: %u bytes do not fit one frame", sendLength);
+    #endif
+    return HMS_PN532_INVALID_COMMAND;
+  }
+
+  const HMS_PN532_SegmentTypeDef segments[] = {
+    { &command, 1          },
+    { send,     sendLength }
+  };
+
+  if (transceive(segments, 2, pn532_packetbuffer, sizeof(pn532_packetbuffer), timeout, &resLen) != HMS_PN532_OK || resLen == 0) {
+    return HMS_PN532_ERROR;
+  }
+
+  if ((pn532_packetbuffer[0] & 0x3f) != 0) {                                                    // 0x01 when the tag stays silent, e.g. it NAKed
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("inCommunicateThru: status 0x%02X", pn532_packetbuffer[0]);
     #endif
     return HMS_PN532_ERROR;
   }
 
-  for (uint8_t i = 0; i < *responseLength; i++) {
-    response[i] = response[i + 1];
+  response = HMS_PN532_ResponseView(pn532_packetbuffer + 1, resLen - 1);                          // Status byte skipped, nothing shifted
+  return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::ntagGetVersion(uint8_t *version) {
+  HMS_PN532_ControllerLock guard(*this);
+  HMS_PN532_ResponseView response;
+  const uint8_t command = HMS_PN532_NTAG_CMD_GET_VERSION;
+
+  if (inCommunicateThru(&command, 1, response) != HMS_PN532_OK || response.size() != 8) {
+    return HMS_PN532_ERROR;
+  }
+
+  response.copyTo(version, 8);
+  return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::ntagFastRead(uint8_t startPage, uint8_t endPage, uint8_t *buffer, uint16_t bufferSize) {
+  HMS_PN532_ControllerLock guard(*this);
+  uint16_t bytes         = (uint16_t)(endPage - startPage + 1) * 4;
+  uint16_t framePages    = (interface->maxInformationLength() - 3) / 4;                          // TFI, response code and status ride along
+  uint16_t bufferPages   = (sizeof(pn532_packetbuffer) - 1) / 4;                                  // The status byte lands in the packet buffer too
+  uint8_t  pagesPerFrame = (uint8_t)((framePages < bufferPages) ? framePages : bufferPages);
+
+  if (endPage < startPage || bufferSize < bytes) {
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("FAST_READ of pages %u-%u needs %u bytes of buffer", startPage, endPage, bytes);
+    #endif
+    return HMS_PN532_ERROR;
+  }
+
+  uint16_t offset = 0;
+  for (uint16_t page = startPage; page <= endPage; page += pagesPerFrame) {
+    uint8_t  last     = (page + pagesPerFrame - 1 < endPage) ? (uint8_t)(page + pagesPerFrame - 1) : endPage;
+    uint16_t expected = (uint16_t)(last - page + 1) * 4;
+    uint16_t received = 0;
+    const uint8_t command[] = { HMS_PN532_NTAG_CMD_FAST_READ, (uint8_t)page, last };
+
+    if (inCommunicateThru(command, sizeof(command), &buffer[offset], expected, &received) != HMS_PN532_OK || received != expected) {
+      return HMS_PN532_ERROR;
+    }
+    offset += expected;
   }
 
   return HMS_PN532_OK;
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::inRelease(const uint8_t relevantTarget){
+    HMS_PN532_ControllerLock guard(*this);
 
     pn532_packetbuffer[0] = HMS_PN532_COMMAND_INRELEASE;
     pn532_packetbuffer[1] = relevantTarget;
 
-    if (interface->write(pn532_packetbuffer, 2) != HMS_PN532_OK) {
-        return HMS_PN532_ERROR;
-    }
-
-    // read data packet
-    return interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer));
+    return transceive(2);
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::tgInitAsTarget(uint16_t timeout) {
+  HMS_PN532_ControllerLock guard(*this);
   const uint8_t command[] = {
     HMS_PN532_COMMAND_TGINITASTARGET,
     0,
@@ -309,61 +738,69 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::tgInitAsTarget(uint16_t timeout) {
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::tgInitAsTarget(const uint8_t* command, const uint8_t len, const uint16_t timeout) {
-  if (interface->write(command, len) != HMS_PN532_OK) {
+  HMS_PN532_ControllerLock guard(*this);
+  const HMS_PN532_SegmentTypeDef request = { command, len };
+  return transceive(&request, 1, pn532_packetbuffer, sizeof(pn532_packetbuffer), timeout);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::tgGetData(uint8_t *buf, uint16_t len) {
+  HMS_PN532_ControllerLock guard(*this);
+  HMS_PN532_ResponseView data;
+
+  if (tgGetData(data) != HMS_PN532_OK) {
+    return HMS_PN532_ERROR;
+  }
+
+  if (data.size() > len) {
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("tgGetData: %u byte response, %u byte buffer", data.size(), len);
+    #endif
     return HMS_PN532_ERROR;
   }
 
-  return interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer), timeout);
+  data.copyTo(buf, len);                                                                          // Only the bytes received, not the whole buffer
+  return HMS_PN532_OK;
 }
 
-HMS_PN532_StatusTypeDef HMS_PN532_Controller::tgGetData(uint8_t *buf, uint8_t len) {
-  buf[0] = HMS_PN532_COMMAND_TGGETDATA;
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::tgGetData(HMS_PN532_ResponseView &data) {
+  HMS_PN532_ControllerLock guard(*this);
+  uint16_t resLen = 0;
 
-  if (interface->write(buf, 1) != HMS_PN532_OK) {
-    return HMS_PN532_ERROR;
-  }
+  pn532_packetbuffer[0] = HMS_PN532_COMMAND_TGGETDATA;
 
-  if (interface->read(buf, len, 3000) != HMS_PN532_OK) {
+  if (transceive(1, 3000, &resLen) != HMS_PN532_OK || resLen == 0) {
     return HMS_PN532_ERROR;
   }
 
-  if (buf[0] != 0) {
+  if (pn532_packetbuffer[0] != 0) {
     #if HMS_PN532_DEBUG_ENABLED
       pn532Logger.error("tgGetData: status is not ok");
     #endif
     return HMS_PN532_ERROR;
   }
 
-  memmove(buf, buf + 1, len - 1);
-
+  data = HMS_PN532_ResponseView(pn532_packetbuffer + 1, resLen - 1);
   return HMS_PN532_OK;
 }
 
-HMS_PN532_StatusTypeDef HMS_PN532_Controller::tgSetData(const uint8_t *header, uint8_t hlen, const uint8_t *body, uint8_t blen) {
-  if (hlen > (sizeof(pn532_packetbuffer) - 1)) {
-    if ((body != 0) || (header == pn532_packetbuffer)) {
-        #if HMS_PN532_DEBUG_ENABLED
-          pn532Logger.error("tgSetData:buffer too small");
-        #endif
-        return HMS_PN532_ERROR;
-      }
-
-    pn532_packetbuffer[0] = HMS_PN532_COMMAND_TGSETDATA;
-    if (interface->write(pn532_packetbuffer, 1) != HMS_PN532_OK) {
-      return HMS_PN532_ERROR;
-    }
-  } else {
-    for (int8_t i = hlen - 1; i >= 0; i--){
-      pn532_packetbuffer[i + 1] = header[i];
-    }
-    pn532_packetbuffer[0] = HMS_PN532_COMMAND_TGSETDATA;
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::tgSetData(const uint8_t *header, uint16_t hlen, const uint8_t *body, uint16_t blen) {
+  HMS_PN532_ControllerLock guard(*this);
+  static const uint8_t command = HMS_PN532_COMMAND_TGSETDATA;
 
-    if (interface->write(pn532_packetbuffer, hlen + 1) != HMS_PN532_OK) {
-      return HMS_PN532_ERROR;
-    }
+  if (hlen + blen + 2 > interface->maxInformationLength()) {                                       // TFI and command ride in the same frame
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("tgSetData: %u bytes do not fit one frame", hlen + blen);
+    #endif
+    return HMS_PN532_INVALID_COMMAND;
   }
 
-  if (interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer), 3000) != HMS_PN532_OK) {
+  const HMS_PN532_SegmentTypeDef segments[] = {                                                   // Sent as-is, no staging copy into pn532_packetbuffer
+    { &command, 1    },
+    { header,   hlen },
+    { body,     blen }
+  };
+
+  if (transceive(segments, 3, pn532_packetbuffer, sizeof(pn532_packetbuffer), 3000) != HMS_PN532_OK) {
     return HMS_PN532_ERROR;
   }
 
@@ -375,6 +812,7 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::tgSetData(const uint8_t *header, u
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaRelease() {
+    HMS_PN532_ControllerLock guard(*this);
     pn532_packetbuffer[0] = HMS_PN532_COMMAND_INRELEASE;
     pn532_packetbuffer[1] = 0x00;                                                                   // All target
 
@@ -382,19 +820,13 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaRelease() {
         pn532Logger.debug("Release all FeliCa target");
     #endif
 
-    if(interface->write(pn532_packetbuffer, 2) != HMS_PN532_OK) {
-        #if HMS_PN532_DEBUG_ENABLED
-            pn532Logger.error("No ACK");
-        #endif
-        return HMS_PN532_INVALID_ACK;  // no ACK
-    }
-
-  // Wait card response
-    if(interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer), 1000) != HMS_PN532_OK) {
+  // Send and wait card response
+    HMS_PN532_StatusTypeDef status = transceive(2, 1000);
+    if(status != HMS_PN532_OK) {
         #if HMS_PN532_DEBUG_ENABLED
                 pn532Logger.error("Could not receive response");
         #endif
-        return HMS_PN532_TIMEOUT;
+        return status;                                                                              // HMS_PN532_INVALID_ACK or HMS_PN532_TIMEOUT
     }
 
   // Check status (pn532_packetbuffer[0])
@@ -409,6 +841,7 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaRelease() {
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaRequestResponse(uint8_t * mode) {
+  HMS_PN532_ControllerLock guard(*this);
   uint8_t cmd[9];
   cmd[0] = HMS_PN532_FELICA_CMD_REQUEST_RESPONSE;
   memcpy(&cmd[1], felicaIDm, 8);
@@ -435,6 +868,7 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaRequestResponse(uint8_t * mo
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaRequestSystemCode(uint8_t * numSystemCode, uint16_t *systemCodeList) {
+  HMS_PN532_ControllerLock guard(*this);
   uint8_t cmd[9];
   cmd[0] = HMS_PN532_FELICA_CMD_REQUEST_SYSTEM_CODE;
   memcpy(&cmd[1], felicaIDm, 8);
@@ -466,6 +900,7 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaRequestSystemCode(uint8_t *
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaRequestService(uint8_t numNode, uint16_t *nodeCodeList, uint16_t *keyVersions) {
+  HMS_PN532_ControllerLock guard(*this);
   if (numNode > HMS_PN532_FELICA_REQ_SERVICE_MAX_NODE_NUM) {
     #if HMS_PN532_DEBUG_ENABLED
         pn532Logger.error("numNode is too large");
@@ -511,6 +946,7 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaRequestService(uint8_t numNo
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaSendCommand (const uint8_t *command, uint8_t commandlength, uint8_t *response, uint8_t *responseLength) {
+    HMS_PN532_ControllerLock guard(*this);
     if (commandlength > 0xFE) {
         #if HMS_PN532_DEBUG_ENABLED
             pn532Logger.error("Command length too long");
@@ -522,19 +958,18 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaSendCommand (const uint8_t *
     pn532_packetbuffer[1] = inListedTag;
     pn532_packetbuffer[2] = commandlength + 1;
 
-    if (interface->write(pn532_packetbuffer, 3, command, commandlength) != HMS_PN532_OK) {
-        #if HMS_PN532_DEBUG_ENABLED
-            pn532Logger.error("Could not send FeliCa command");
-        #endif
-        return HMS_PN532_INVALID_ACK;
-    }
+    const HMS_PN532_SegmentTypeDef segments[] = {
+        { pn532_packetbuffer, 3             },
+        { command,            commandlength }
+    };
 
-    // Wait card response
-    if (interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer), 200) != HMS_PN532_OK) {
+    // Send and wait card response
+    HMS_PN532_StatusTypeDef status = transceive(segments, 2, pn532_packetbuffer, sizeof(pn532_packetbuffer), 200);
+    if (status != HMS_PN532_OK) {
         #if HMS_PN532_DEBUG_ENABLED
-            pn532Logger.error("Could not receive response");
+            pn532Logger.error("FeliCa command failed: %d", status);
         #endif
-        return HMS_PN532_INVALID_FRAME;
+        return status;
     }
 
   // Check status (pn532_packetbuffer[0])
@@ -553,6 +988,7 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaSendCommand (const uint8_t *
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaPolling(uint16_t systemCode, uint8_t requestCode, uint8_t * idm, uint8_t * pmm, uint16_t *systemCodeResponse, uint16_t timeout) {
+  HMS_PN532_ControllerLock guard(*this);
   pn532_packetbuffer[0] = HMS_PN532_COMMAND_INLISTPASSIVETARGET;
   pn532_packetbuffer[1] = 1;
   pn532_packetbuffer[2] = 1;
@@ -562,16 +998,10 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaPolling(uint16_t systemCode,
   pn532_packetbuffer[6] = requestCode;
   pn532_packetbuffer[7] = 0;
 
-  if (interface->write(pn532_packetbuffer, 8) != HMS_PN532_OK) {
-    #if HMS_PN532_DEBUG_ENABLED
-      pn532Logger.error("Could not send Polling command");  
-    #endif
-    return HMS_PN532_INVALID_ACK;
-  }
-
-  if (interface->read(pn532_packetbuffer, 22, timeout) != HMS_PN532_OK) {
+  const HMS_PN532_SegmentTypeDef request = { pn532_packetbuffer, 8 };
+  if (transceive(&request, 1, pn532_packetbuffer, 22, timeout) != HMS_PN532_OK) {
     #if HMS_PN532_DEBUG_ENABLED
-      pn532Logger.error("Could not receive response");
+      pn532Logger.error("Could not receive Polling response");
     #endif
     return HMS_PN532_INVALID_ACK;
   }
@@ -620,6 +1050,7 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaPolling(uint16_t systemCode,
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaReadWithoutEncryption(uint8_t numService, const uint16_t *serviceCodeList, uint8_t numBlock, const uint16_t *blockList, uint8_t blockData[][16]) {
+    HMS_PN532_ControllerLock guard(*this);
     if (numService > HMS_PN532_FELICA_READ_MAX_SERVICE_NUM) {
         #if HMS_PN532_DEBUG_ENABLED
             pn532Logger.error("numService is too large");
@@ -687,6 +1118,7 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaReadWithoutEncryption(uint8_
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::felicaWriteWithoutEncryption(uint8_t numService, const uint16_t *serviceCodeList, uint8_t numBlock, const uint16_t *blockList, uint8_t blockData[][16]) {
+    HMS_PN532_ControllerLock guard(*this);
     if (numService > HMS_PN532_FELICA_WRITE_MAX_SERVICE_NUM) {
         #if HMS_PN532_DEBUG_ENABLED
             pn532Logger.error("numService is too large");
@@ -770,51 +1202,74 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareclassicIsTrailerBlock (uint3
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareclassicReadDataBlock (uint8_t blockNumber, uint8_t *data) {
+  HMS_PN532_ControllerLock guard(*this);
+  HMS_PN532_ResponseView view;
+
+  if (mifareclassicReadDataBlock(blockNumber, view) != HMS_PN532_OK) {
+    return HMS_PN532_ERROR;
+  }
+
+  view.copyTo(data, 16);
+  return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareclassicReadDataBlock (uint8_t blockNumber, HMS_PN532_ResponseView &data) {
+  HMS_PN532_ControllerLock guard(*this);
+  uint16_t responseLen = 0;
+
   #if HMS_PN532_DEBUG_ENABLED
     pn532Logger.debug("Trying to read 16 bytes from block %d", blockNumber);
   #endif
 
   /* Prepare the command */
   pn532_packetbuffer[0] = HMS_PN532_COMMAND_INDATAEXCHANGE;
-  pn532_packetbuffer[1] = HMS_PN532_MAX_CARD_NUM_SCAN;                                                                                            // Card number
+  pn532_packetbuffer[1] = inListedTag;                                                                                                            // Tg
   pn532_packetbuffer[2] = HMS_PN532_MIFARE_CMD_READ;                                                                                              // Mifare Read command = 0x30
   pn532_packetbuffer[3] = blockNumber;                                                                                                            // Block Number (0..63 for 1K, 0..255 for 4K)
 
-  if (interface->write(pn532_packetbuffer, 4) != HMS_PN532_OK) {                                                                                  // Send the command
+  if (transceive(4, 1000, &responseLen) != HMS_PN532_OK || responseLen < 17) {                                                                     // Send the command, read the response packet
     return HMS_PN532_ERROR;
   }
 
-  interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer));                                                                                // Read the response packet
-
   if (pn532_packetbuffer[0] != 0x00) {
     return HMS_PN532_ERROR;
   }
 
-  memcpy (data, pn532_packetbuffer + 1, 16);
+  data = HMS_PN532_ResponseView(pn532_packetbuffer + 1, 16);                                                                                       // Block stays in the receive buffer
   return HMS_PN532_OK;
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareclassicAuthenticateBlock (uint8_t *uid, uint8_t uidLen, uint32_t blockNumber, uint8_t keyNumber, uint8_t *keyData) {
+  HMS_PN532_ControllerLock guard(*this);
   uint8_t index;
+  int16_t sector = (blockNumber < 128) ? (int16_t)(blockNumber / 4) : (int16_t)(32 + (blockNumber - 128) / 16);
+
+  if (uidLen > sizeof(this->uid)) uidLen = sizeof(this->uid);
+  if (authSector == sector && authKeyNumber == keyNumber && authTg == inListedTag && this->uidLen == uidLen &&
+      memcmp(this->uid, uid, uidLen) == 0 && memcmp(this->key, keyData, 6) == 0
+  ) {
+    authsSkipped++;
+    return HMS_PN532_OK;                                                                                                                        // Crypto1 session on that sector is still open
+  }
 
+  authSector = -1;
   memcpy (this->key, keyData, 6);                                                                                                               // Cache the key and uid data
   memcpy (this->uid, uid, uidLen);
   this->uidLen = uidLen;
 
   /* Prepare the authentication command */
   pn532_packetbuffer[0] = HMS_PN532_COMMAND_INDATAEXCHANGE;                                                                                     // Data Exchange Header
-  pn532_packetbuffer[1] = HMS_PN532_MAX_CARD_NUM_SCAN;                                                                                          // Max card numbers
+  pn532_packetbuffer[1] = inListedTag;                                                                                                          // Tg
   pn532_packetbuffer[2] = (keyNumber) ? HMS_PN532_MIFARE_CMD_AUTH_B : HMS_PN532_MIFARE_CMD_AUTH_A;
   pn532_packetbuffer[3] = blockNumber;                                                                                                          // Block Number (1K = 0..63, 4K = 0..255
  
   memcpy (pn532_packetbuffer + 4, this->key, 6);
-  for (index = 0; index < this->uidLen; index++) {
-    pn532_packetbuffer[10 + index] = this->uid[index];                                                                                          // 4 bytes card ID
+  uint8_t uidOffset = (this->uidLen > 4) ? this->uidLen - 4 : 0;                                                                              // 7-byte UID cards authenticate with UID3..UID6
+  for (index = 0; index < 4 && index < this->uidLen; index++) {
+    pn532_packetbuffer[10 + index] = this->uid[uidOffset + index];                                                                              // 4 bytes card ID
   }
 
-  if (interface->write(pn532_packetbuffer, 10 + this->uidLen) != HMS_PN532_OK)  return HMS_PN532_ERROR;
-
-  interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer));                                                                              // Read the response packet
+  if (transceive(10 + index) != HMS_PN532_OK)  return HMS_PN532_ERROR;                                                                        // Send the command, read the response packet
 
   if (pn532_packetbuffer[0] != 0x00) {                                                                                                          // Success would be bytes 5-7: 0xD5 0x41 0x00 (Mifare auth error is technically byte 7: 0x14)
     #if HMS_PN532_DEBUG_ENABLED
@@ -823,19 +1278,22 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareclassicAuthenticateBlock (ui
     return HMS_PN532_ERROR;
   }
 
+  authSector    = sector;
+  authKeyNumber = keyNumber;
+  authTg        = inListedTag;
   return HMS_PN532_OK;
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::readPassiveTargetID(uint8_t cardbaudrate, uint8_t *uid, uint8_t &uidLength, uint16_t timeout) {
+  HMS_PN532_ControllerLock guard(*this);
+  uint16_t responseLen = 0;
+
   pn532_packetbuffer[2] = cardbaudrate;
   pn532_packetbuffer[1] = HMS_PN532_MAX_CARD_NUM_SCAN;
   pn532_packetbuffer[0] = HMS_PN532_COMMAND_INLISTPASSIVETARGET;
   
-  if (interface->write(pn532_packetbuffer, 3) != HMS_PN532_OK) {
-    return HMS_PN532_ERROR;                                                                                                                         // command failed
-  }
-
-  if (interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer), timeout) != HMS_PN532_OK) {                                                   // read data packet
+  targetCount = 0;
+  if (transceive(3, timeout, &responseLen) != HMS_PN532_OK) {                                                                                     // command failed or no data packet
     return HMS_PN532_ERROR;
   }
 
@@ -854,58 +1312,295 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::readPassiveTargetID(uint8_t cardba
       └─────────────────────────────────────────────────────────────────────┘
     */
 
-  if (pn532_packetbuffer[0] != HMS_PN532_MAX_CARD_NUM_SCAN)
+  if (pn532_packetbuffer[0] == 0 || parseTargets(responseLen) != HMS_PN532_OK)
     return HMS_PN532_NOT_FOUND;
 
-  uint16_t sens_res = pn532_packetbuffer[2];
-  sens_res <<= 8;
-  sens_res |= pn532_packetbuffer[3];
+  #if HMS_PN532_DEBUG_ENABLED
+    pn532Logger.debug("ATQA: 0x%04X", targets[0].atqa);
+    pn532Logger.debug("SAK: 0x%02X", targets[0].sak);
+    pn532Logger.debug("UID Length: %d", targets[0].uidLength);
+  #endif
+
+  uidLength = targets[0].uidLength;
+  memcpy(uid, targets[0].uid, uidLength);
+
+  return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::inListPassiveTargets(uint8_t maxTargets, uint16_t timeout) {
+  HMS_PN532_ControllerLock guard(*this);
+  uint16_t responseLen = 0;
+
+  if (maxTargets == 0 || maxTargets > HMS_PN532_MAX_TARGETS) {
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("InListPassiveTarget supports 1 to %d targets", HMS_PN532_MAX_TARGETS);
+    #endif
+    return HMS_PN532_ERROR;
+  }
+
+  pn532_packetbuffer[0] = HMS_PN532_COMMAND_INLISTPASSIVETARGET;
+  pn532_packetbuffer[1] = maxTargets;
+  pn532_packetbuffer[2] = HMS_PN532_MIFARE_ISO14443A;
+
+  targetCount = 0;
+  if (transceive(3, timeout, &responseLen) != HMS_PN532_OK) {
+    return HMS_PN532_ERROR;
+  }
+
+  if (pn532_packetbuffer[0] == 0) {
+    return HMS_PN532_NOT_FOUND;
+  }
 
   #if HMS_PN532_DEBUG_ENABLED
-    pn532Logger.debug("ATQA: 0x%04X", sens_res);
-    pn532Logger.debug("SAK: 0x%02X", pn532_packetbuffer[4]);
-    pn532Logger.debug("UID Length: %d", pn532_packetbuffer[5]);
+    pn532Logger.debug("%d target(s) listed", pn532_packetbuffer[0]);
   #endif
 
-  uidLength = pn532_packetbuffer[5];
+  return parseTargets(responseLen);
+}
 
-  for (uint8_t i = 0; i < pn532_packetbuffer[5]; i++) {
-    uid[i] = pn532_packetbuffer[6 + i];
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::parseTargets(uint16_t responseLen) {
+  uint16_t pos = 1;
+
+  targetCount = 0;
+  for (uint8_t i = 0; i < pn532_packetbuffer[0] && targetCount < HMS_PN532_MAX_TARGETS; i++) {
+    HMS_PN532_TargetTypeDef &target = targets[targetCount];
+    if (pos + 5 > responseLen) break;                                                         // Tg, SENS_RES, SEL_RES, NFCID length
+
+    uint8_t nfcidLen = pn532_packetbuffer[pos + 4];
+    if (nfcidLen > sizeof(target.uid) || pos + 5 + nfcidLen > responseLen) break;
+
+    target.tg        = pn532_packetbuffer[pos];
+    target.atqa      = (uint16_t)((pn532_packetbuffer[pos + 1] << 8) | pn532_packetbuffer[pos + 2]);
+    target.sak       = pn532_packetbuffer[pos + 3];
+    target.uidLength = nfcidLen;
+    memcpy(target.uid, &pn532_packetbuffer[pos + 5], nfcidLen);
+    pos += 5 + nfcidLen;
+
+    target.atsLength = 0;
+    if ((target.sak & 0x20) && pos < responseLen) {                                           // ATS of an ISO14443-4 target, its length byte counts itself
+      uint8_t tl = pn532_packetbuffer[pos];
+      target.atsLength = (tl <= sizeof(target.ats) && pos + tl <= responseLen) ? tl : 0;
+      memcpy(target.ats, &pn532_packetbuffer[pos], target.atsLength);
+      pos += tl;
+    }
+    targetCount++;
   }
 
+  if (targetCount == 0) {
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("Malformed InListPassiveTarget response");
+    #endif
+    return HMS_PN532_ERROR;
+  }
+
+  inListedTag = targets[0].tg;
+  return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::inSelect(uint8_t tg) {
+  HMS_PN532_ControllerLock guard(*this);
+
+  pn532_packetbuffer[0] = HMS_PN532_COMMAND_INSELECT;
+  pn532_packetbuffer[1] = tg;
+
+  if (transceive(2) != HMS_PN532_OK) {
+    return HMS_PN532_ERROR;
+  }
+
+  if (pn532_packetbuffer[0] & 0x3F) {                                                         // 0x27 when nothing is listed under tg, 0x01 when it left the field
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("InSelect of target %d failed, status 0x%02X", tg, pn532_packetbuffer[0]);
+    #endif
+    return HMS_PN532_ERROR;
+  }
+
+  inListedTag = tg;
+  return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::inDeselect(uint8_t tg) {
+  HMS_PN532_ControllerLock guard(*this);
+
+  pn532_packetbuffer[0] = HMS_PN532_COMMAND_INDESELECT;
+  pn532_packetbuffer[1] = tg;
+
+  if (transceive(2) != HMS_PN532_OK) {
+    return HMS_PN532_ERROR;
+  }
+
+  return (pn532_packetbuffer[0] & 0x3F) ? HMS_PN532_ERROR : HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::diagnosePresence() {
+  HMS_PN532_ControllerLock guard(*this);
+
+  pn532_packetbuffer[0] = HMS_PN532_COMMAND_DIAGNOSE;
+  pn532_packetbuffer[1] = HMS_PN532_DIAGNOSE_PRESENCE;
+
+  if (transceive(2) != HMS_PN532_OK) {
+    return HMS_PN532_ERROR;
+  }
+
+  return (pn532_packetbuffer[0] & 0x3F) ? HMS_PN532_NOT_FOUND : HMS_PN532_OK;                // 0x01 when the target no longer answers
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::inAutoPoll(
+  const uint8_t *types, uint8_t typeCount, uint8_t pollCount, uint8_t period,
+  HMS_PN532_AutoPollTargetTypeDef &target, uint16_t timeout
+) {
+  HMS_PN532_ControllerLock guard(*this);
+  uint16_t responseLen = 0;
+
+  if (typeCount == 0 || typeCount > HMS_PN532_AUTOPOLL_MAX_TYPES || pollCount == 0 || period == 0 || period > 0x0F) {
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("InAutoPoll parameters out of range");
+    #endif
+    return HMS_PN532_ERROR;
+  }
+
+  if (timeout == 0 && pollCount != HMS_PN532_AUTOPOLL_FOREVER) {                                 // Every round: the period, then one attempt per type
+    uint32_t worstCase = (uint32_t)pollCount * (period * HMS_PN532_AUTOPOLL_PERIOD_MS + typeCount * 50) + 1000;
+    timeout = (worstCase > 0xFFFF) ? 0xFFFF : (uint16_t)worstCase;
+  }
+
+  pn532_packetbuffer[0] = HMS_PN532_COMMAND_INAUTOPOLL;
+  pn532_packetbuffer[1] = pollCount;
+  pn532_packetbuffer[2] = period;
+  memcpy(&pn532_packetbuffer[3], types, typeCount);
+
+  targetCount = 0;                                                                              // The PN532 replaces its listing, the type A table goes stale
+  if (transceive(3 + typeCount, timeout, &responseLen) != HMS_PN532_OK || responseLen < 1) {
+    return HMS_PN532_ERROR;
+  }
+
+    /*
+      ┌─────────────────────────────────────────────────────────────────────┐
+      │ Note: InAutoPoll response, one entry per target found (at most 2)   │
+      │                                                                     │
+      │  Byte         │ Description                                         │
+      │ --------------│------------------------------------------           │
+      │  b0           │ Targets found                                       │
+      │  b1           │ Type of the first target                            │
+      │  b2           │ Length of its target data                           │
+      │  b3..         │ Target data, as InListPassiveTarget for that type   │
+      └─────────────────────────────────────────────────────────────────────┘
+    */
+
+  if (pn532_packetbuffer[0] == 0) return HMS_PN532_NOT_FOUND;
+  if (responseLen < 3 || responseLen < 3 + pn532_packetbuffer[2]) return HMS_PN532_INVALID_FRAME;
+
+  const uint8_t *data = &pn532_packetbuffer[3];
+  uint8_t dataLen = pn532_packetbuffer[2];
+
+  memset(&target, 0, sizeof(target));
+  target.type       = pn532_packetbuffer[1];
+  target.tg         = data[0];
+  target.systemCode = 0xFFFF;
+  inListedTag       = target.tg;
+
+  switch (target.type) {
+    case HMS_PN532_AUTOPOLL_GENERIC_106A:
+    case HMS_PN532_AUTOPOLL_MIFARE:
+    case HMS_PN532_AUTOPOLL_ISO14443_4A:                                                          // Tg, SENS_RES, SEL_RES, NFCIDLength, NFCID1, [ATS]
+      if (dataLen < 5 || data[4] > sizeof(target.uid) || dataLen < 5 + data[4]) return HMS_PN532_INVALID_FRAME;
+      target.atqa      = (uint16_t)((data[1] << 8) | data[2]);
+      target.sak       = data[3];
+      target.uidLength = data[4];
+      memcpy(target.uid, &data[5], target.uidLength);
+      if ((target.sak & 0x20) && dataLen > 5 + target.uidLength) {
+        uint8_t tl = data[5 + target.uidLength];
+        target.atsLength = (tl <= sizeof(target.ats) && 5 + target.uidLength + tl <= dataLen) ? tl : 0;
+        memcpy(target.ats, &data[5 + target.uidLength], target.atsLength);
+      }
+      break;
+
+    case HMS_PN532_AUTOPOLL_GENERIC_212:
+    case HMS_PN532_AUTOPOLL_GENERIC_424:
+    case HMS_PN532_AUTOPOLL_FELICA_212:
+    case HMS_PN532_AUTOPOLL_FELICA_424:                                                           // Tg, POL_RES length, 0x01, IDm, PMm, [system code]
+      if (dataLen < 19) return HMS_PN532_INVALID_FRAME;
+      target.uidLength = 8;
+      memcpy(target.uid, &data[3], 8);
+      memcpy(target.pmm, &data[11], 8);
+      memcpy(felicaIDm, target.uid, 8);
+      memcpy(felicaPMm, target.pmm, 8);
+      if (data[1] >= 20 && dataLen >= 21) target.systemCode = (uint16_t)((data[19] << 8) | data[20]);
+      break;
+
+    case HMS_PN532_AUTOPOLL_ISO14443B_106:
+    case HMS_PN532_AUTOPOLL_ISO14443_4B:                                                          // Tg, ATQB (0x50, PUPI, ...), ATTRIB_RES
+      if (dataLen < 6) return HMS_PN532_INVALID_FRAME;
+      target.uidLength = 4;
+      memcpy(target.uid, &data[2], 4);
+      break;
+
+    case HMS_PN532_AUTOPOLL_JEWEL_106:                                                            // Tg, SENS_RES, JEWELID
+      if (dataLen < 7) return HMS_PN532_INVALID_FRAME;
+      target.atqa      = (uint16_t)((data[1] << 8) | data[2]);
+      target.uidLength = 4;
+      memcpy(target.uid, &data[3], 4);
+      break;
+
+    default:
+      #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.warn("InAutoPoll target type 0x%02X not decoded", target.type);
+      #endif
+      break;
+  }
+
+  #if HMS_PN532_DEBUG_ENABLED
+    pn532Logger.debug("InAutoPoll found type 0x%02X, UID length %d", target.type, target.uidLength);
+  #endif
+
   return HMS_PN532_OK;
 }
 
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareclassicWriteDataBlock (uint8_t blockNumber, uint8_t *data) {
+  HMS_PN532_ControllerLock guard(*this);
   /* Prepare the first command */
   pn532_packetbuffer[0] = HMS_PN532_COMMAND_INDATAEXCHANGE;
-  pn532_packetbuffer[1] = 1;                      /* Card number */
+  pn532_packetbuffer[1] = inListedTag;            /* Card number */
   pn532_packetbuffer[2] = HMS_PN532_MIFARE_CMD_WRITE;       /* Mifare Write command = 0xA0 */
   pn532_packetbuffer[3] = blockNumber;            /* Block Number (0..63 for 1K, 0..255 for 4K) */
   memcpy (pn532_packetbuffer + 4, data, 16);        /* Data Payload */
 
-  /* Send the command */
-  if (interface->write(pn532_packetbuffer, 20) != HMS_PN532_OK) {
+  /* Send the command and read the response packet */
+  if (transceive(20) != HMS_PN532_OK) return HMS_PN532_ERROR;
+
+  if (pn532_packetbuffer[0] & 0x3f) {                                                             // 0x14 when the sector is not unlocked
+    #if HMS_PN532_DEBUG_ENABLED
+      pn532Logger.error("Write of block %d failed, status 0x%02X", blockNumber, pn532_packetbuffer[0]);
+    #endif
     return HMS_PN532_ERROR;
   }
-
-  /* Read the response packet */
-  return interface->read(pn532_packetbuffer, sizeof(pn532_packetbuffer));
+  return HMS_PN532_OK;
 }
 
-HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareclassicFormatNDEF (void) {
-  uint8_t sectorbuffer1[16] = {0x14, 0x01, 0x03, 0xE1, 0x03, 0xE1, 0x03, 0xE1, 0x03, 0xE1, 0x03, 0xE1, 0x03, 0xE1, 0x03, 0xE1};
-  uint8_t sectorbuffer2[16] = {0x03, 0xE1, 0x03, 0xE1, 0x03, 0xE1, 0x03, 0xE1, 0x03, 0xE1, 0x03, 0xE1, 0x03, 0xE1, 0x03, 0xE1};
+HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareclassicFormatNDEF (uint8_t sectors) {
+  HMS_PN532_ControllerLock guard(*this);
+  uint8_t mad[32] = {0x00, 0x01};                                                                 // Blocks 1 and 2: CRC, info byte, one AID per sector 1-15
   uint8_t sectorbuffer3[16] = {0xA0, 0xA1, 0xA2, 0xA3, 0xA4, 0xA5, 0x78, 0x77, 0x88, 0xC1, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF};
 
   // Note 0xA0 0xA1 0xA2 0xA3 0xA4 0xA5 must be used for key A
   // for the MAD sector in NDEF records (sector 0)
 
+  for (uint8_t sector = 1; sector < 16; sector++) {                                               // NDEF AID 0xE103, sectors the card does not have stay free
+    mad[2 * sector]     = (sector < sectors) ? 0x03 : 0x00;
+    mad[2 * sector + 1] = (sector < sectors) ? 0xE1 : 0x00;
+  }
+
+  uint8_t crc = 0xC7;                                                                             // MAD CRC-8, polynomial 0x1D, over everything after the CRC byte
+  for (uint8_t i = 1; i < sizeof(mad); i++) {
+    crc ^= mad[i];
+    for (uint8_t bit = 0; bit < 8; bit++) crc = (crc & 0x80) ? (uint8_t)((crc << 1) ^ 0x1D) : (uint8_t)(crc << 1);
+  }
+  mad[0] = crc;
+
   // Write block 1 and 2 to the card
-  if (mifareclassicWriteDataBlock (1, sectorbuffer1) != HMS_PN532_OK)
+  if (mifareclassicWriteDataBlock (1, &mad[0]) != HMS_PN532_OK)
       return HMS_PN532_ERROR;
-  if (mifareclassicWriteDataBlock (2, sectorbuffer2) != HMS_PN532_OK)
+  if (mifareclassicWriteDataBlock (2, &mad[16]) != HMS_PN532_OK)
       return HMS_PN532_ERROR;
   // Write key A and access rights card
   if (mifareclassicWriteDataBlock (3, sectorbuffer3) != HMS_PN532_OK)
@@ -916,6 +1611,7 @@ HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareclassicFormatNDEF (void) {
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Controller::mifareclassicWriteNDEFURI (uint8_t sectorNumber, uint8_t uriIdentifier, const char *url) {
+    HMS_PN532_ControllerLock guard(*this);
     // Figure out how long the string is
     uint8_t len = strlen(url);
 
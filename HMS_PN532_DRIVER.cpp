@@ -8,9 +8,11 @@
   #include "HMS_PN532_Interface_I2C.h"
   HMS_PN532_Interface_I2C default_interface;
 #elif (HMS_PN532_COM_INTERFACE == HMS_PN532_SPI)
-  // #include "HMS_PN532_Interface_SPI.h"
+  #include "HMS_PN532_Interface_SPI.h"
+  HMS_PN532_Interface_SPI default_interface;
 #elif (HMS_PN532_COM_INTERFACE == HMS_PN532_UART)
-  // #include "HMS_PN532_Interface_UART.h"
+  #include "HMS_PN532_Interface_UART.h"
+  HMS_PN532_Interface_UART default_interface;
 #endif
 
 HMS_PN532::HMS_PN532(HMS_PN532_Interface *interface) {
@@ -19,13 +21,16 @@ HMS_PN532::HMS_PN532(HMS_PN532_Interface *interface) {
 }
 
 HMS_PN532::~HMS_PN532() {
+    delete pn532_controller;
+    pn532_controller = nullptr;
     if(pn532_interface) {
         delete pn532_interface;
-        pn532_controller = nullptr;
     }
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532::begin() {
+    HMS_PN532_ControllerLock guard(*pn532_controller);
+
     pn532_controller->begin();
     uint32_t versiondata = pn532_controller->getFirmwareVersion();
 
@@ -46,66 +51,355 @@ HMS_PN532_StatusTypeDef HMS_PN532::begin() {
     return HMS_PN532_OK;
 }
 
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: SAK decides the family, first match wins (NXP AN10833). ATQA  │
+  │       only has to show bit frame anticollision where the mask asks  │
+  │       for it, which keeps Jewel/Topaz (SAK 0x00, ATQA 0x0C00) out   │
+  │       of the Type 2 path. Any other SAK with bit 5 set is ISO-DEP.  │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+static const struct {
+    uint8_t                     sak;
+    uint16_t                    atqaMask;
+    uint16_t                    atqa;
+    HMS_PN532_TagFamilyTypeDef  family;
+} TAG_FAMILIES[] = {
+    { 0x00, 0x001F, 0x0004, HMS_PN532_TAG_FAMILY_ULTRALIGHT         },          // ATQA 0x0044
+    { 0x09, 0x0000, 0x0000, HMS_PN532_TAG_FAMILY_MIFARE_MINI        },
+    { 0x08, 0x0000, 0x0000, HMS_PN532_TAG_FAMILY_MIFARE_CLASSIC_1K  },          // ATQA 0x0004, 0x0044 with a 7-byte UID
+    { 0x88, 0x0000, 0x0000, HMS_PN532_TAG_FAMILY_MIFARE_CLASSIC_1K  },          // Infineon
+    { 0x18, 0x0000, 0x0000, HMS_PN532_TAG_FAMILY_MIFARE_CLASSIC_4K  },          // ATQA 0x0002, 0x0042 with a 7-byte UID
+    { 0x28, 0x0000, 0x0000, HMS_PN532_TAG_FAMILY_MIFARE_PLUS_SL1    },
+    { 0x38, 0x0000, 0x0000, HMS_PN532_TAG_FAMILY_MIFARE_PLUS_SL1    },
+};
+
+void HMS_PN532::setTypeA(uint16_t newAtqa, uint8_t newSak, const uint8_t *newAts, uint8_t newAtsLength) {
+    atqa      = newAtqa;
+    sak       = newSak;
+    atsLength = (newAtsLength <= sizeof(ats)) ? newAtsLength : 0;
+    memcpy(ats, newAts, atsLength);
+
+    tagFamily = (sak & 0x20) ? HMS_PN532_TAG_FAMILY_ISO_DEP : HMS_PN532_TAG_FAMILY_UNKNOWN;
+    for (const auto &known : TAG_FAMILIES) {
+        if (sak == known.sak && (atqa & known.atqaMask) == known.atqa) {
+            tagFamily = known.family;
+            break;
+        }
+    }
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.debug("ATQA 0x%04X SAK 0x%02X, tag family %d", atqa, sak, tagFamily);
+    #endif
+}
+
 HMS_PN532_TagTypeDef HMS_PN532::getTagType() {
-    switch(uidLength) {
-        case 4:
-            return HMS_PN532_TAG_TYPE_MIFARE_CLASSIC;
-        case 7:
+    switch(tagFamily) {
+        case HMS_PN532_TAG_FAMILY_ULTRALIGHT:
             return HMS_PN532_TAG_TYPE_2;
+        case HMS_PN532_TAG_FAMILY_MIFARE_MINI:
+        case HMS_PN532_TAG_FAMILY_MIFARE_CLASSIC_1K:
+        case HMS_PN532_TAG_FAMILY_MIFARE_CLASSIC_4K:
+            return HMS_PN532_TAG_TYPE_MIFARE_CLASSIC;
         default:
-            return HMS_PN532_TAG_TYPE_UNKNOWN;
+            return HMS_PN532_TAG_TYPE_UNKNOWN;                                                          // ISO-DEP, FeliCa, type B and Jewel have no NDEF driver here
+    }
+}
+
+uint8_t HMS_PN532::classicSectors() {
+    switch(tagFamily) {
+        case HMS_PN532_TAG_FAMILY_MIFARE_MINI:          return MIFARECLASSIC_SECTORS_MINI;
+        case HMS_PN532_TAG_FAMILY_MIFARE_CLASSIC_4K:    return MIFARECLASSIC_SECTORS_4K;
+        default:                                        return MIFARECLASSIC_SECTORS_1K;
     }
 }
 
+HMS_PN532_Type2InfoTypeDef *HMS_PN532::type2InfoSlot() {
+    for (Type2Slot &slot : type2Slots) {
+        if (slot.uidLength == uidLength && memcmp(slot.uid, uid, uidLength) == 0) return &slot.info;
+    }
+
+    Type2Slot &slot = type2Slots[type2Next];
+    type2Next = (type2Next + 1) % HMS_PN532_MAX_TARGETS;
+
+    memcpy(slot.uid, uid, uidLength);
+    slot.uidLength = uidLength;
+    slot.info      = {};                                                                                // Probed on first use
+    return &slot.info;
+}
+
+const HMS_PN532_Type2InfoTypeDef *HMS_PN532::getType2Info() {
+    HMS_PN532_ControllerLock guard(*pn532_controller);
+
+    if (getTagType() != HMS_PN532_TAG_TYPE_2) return nullptr;
+
+    HMS_PN532_MifareUltralight mifareUltralight = HMS_PN532_MifareUltralight(*pn532_controller, type2InfoSlot());
+    if (!mifareUltralight.identify()) return nullptr;
+    return &mifareUltralight.getInfo();
+}
+
 HMS_PN532_StatusTypeDef HMS_PN532::tagAvailable(unsigned long timeout) {
+    HMS_PN532_ControllerLock guard(*pn532_controller);
+
+    if (idling && resume() != HMS_PN532_OK) return HMS_PN532_ERROR;
     memset(uid, 0, sizeof(uid));
 
+    HMS_PN532_StatusTypeDef status;
+    targetType = HMS_PN532_AUTOPOLL_GENERIC_106A;
     if (timeout == 0) {
-        return pn532_controller->readPassiveTargetID(HMS_PN532_MIFARE_ISO14443A, uid, uidLength);
+        status = pn532_controller->readPassiveTargetID(HMS_PN532_MIFARE_ISO14443A, uid, uidLength);
     } else {
-        return pn532_controller->readPassiveTargetID(HMS_PN532_MIFARE_ISO14443A, uid, uidLength, timeout);
+        status = pn532_controller->readPassiveTargetID(HMS_PN532_MIFARE_ISO14443A, uid, uidLength, timeout);
+    }
+
+    tagPresent = (status == HMS_PN532_OK);
+    tagFamily  = HMS_PN532_TAG_FAMILY_UNKNOWN;
+    if (status == HMS_PN532_OK) {
+        const HMS_PN532_TargetTypeDef *target = pn532_controller->getTarget(0);
+        setTypeA(target->atqa, target->sak, target->ats, target->atsLength);
+    }
+    if (status == HMS_PN532_OK && wakePending) {
+        wakeToDetectUs = pn532_interface->pn532Micros() - wakeAtUs;
+        wakePending    = false;
+    }
+    return status;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532::autoPoll(const uint8_t *types, uint8_t typeCount, uint8_t pollCount, uint8_t period) {
+    HMS_PN532_ControllerLock guard(*pn532_controller);
+
+    if (idling && resume() != HMS_PN532_OK) return HMS_PN532_ERROR;
+    memset(uid, 0, sizeof(uid));
+    uidLength = 0;
+
+    tagPresent = false;
+    tagFamily  = HMS_PN532_TAG_FAMILY_UNKNOWN;
+    HMS_PN532_StatusTypeDef status = pn532_controller->inAutoPoll(types, typeCount, pollCount, period, autoPollTarget);
+    if (status != HMS_PN532_OK) return status;
+
+    tagPresent = true;
+    targetType = autoPollTarget.type;
+    uidLength  = (autoPollTarget.uidLength < sizeof(uid)) ? autoPollTarget.uidLength : sizeof(uid);
+    memcpy(uid, autoPollTarget.uid, uidLength);
+
+    atqa      = 0;
+    sak       = 0;
+    atsLength = 0;
+    if (targetType == HMS_PN532_AUTOPOLL_GENERIC_106A || targetType == HMS_PN532_AUTOPOLL_MIFARE ||
+        targetType == HMS_PN532_AUTOPOLL_ISO14443_4A
+    )   setTypeA(autoPollTarget.atqa, autoPollTarget.sak, autoPollTarget.ats, autoPollTarget.atsLength);
+
+    if (wakePending) {
+        wakeToDetectUs = pn532_interface->pn532Micros() - wakeAtUs;
+        wakePending    = false;
+    }
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532::idle(uint8_t wakeSources) {
+    HMS_PN532_ControllerLock guard(*pn532_controller);
+
+    if (idling) return HMS_PN532_OK;
+    if (wakeSources == 0) wakeSources = pn532_interface->hostWakeSource() | HMS_PN532_WAKEUP_RF;
+
+    if (pn532_controller->powerDown(wakeSources, true) != HMS_PN532_OK) return HMS_PN532_ERROR;
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.debug("PN532 idle, wake-up sources 0x%02X", wakeSources);
+    #endif
+
+    idling      = true;
+    wakePending = false;
+    tagPresent  = false;                                                                                // The RF field goes down, the PN532 forgets its targets
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532::resume() {
+    HMS_PN532_ControllerLock guard(*pn532_controller);
+
+    if (!idling) return HMS_PN532_OK;
+
+    uint32_t start = pn532_interface->pn532Micros();                                                    // Wake latency counts towards detection
+    if (pn532_interface->resume() != HMS_PN532_OK) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("PN532 did not wake up");
+        #endif
+        return HMS_PN532_ERROR;
     }
+
+    idling      = false;                                                                                // Configuration survives PowerDown, no begin() needed
+    wakePending = true;
+    wakeAtUs    = start;
+    return HMS_PN532_OK;
 }
 
 HMS_PN532_NFC_Tag HMS_PN532::readTag() {
+    HMS_PN532_ControllerLock guard(*pn532_controller);                                                   // Every block of the read as one sequence
+
+    #if HMS_PN532_TAG_CACHE_ENTRIES
+        HMS_PN532_TagTypeDef type = getTagType();
+        uint8_t check[16];
+        uint8_t checkLength = 0;
+
+        if (type != HMS_PN532_TAG_TYPE_UNKNOWN && readCacheCheck(type, check, checkLength) == HMS_PN532_OK) {
+            uint32_t now = pn532_interface->pn532Millis();
+            const HMS_PN532_NFC_Tag *cached = tagCache.lookup(uid, uidLength, type, check, checkLength, now);
+            if (cached) return *cached;
+
+            HMS_PN532_NFC_Tag tag = readTagFromCard();
+            if (tag.hasNdefMessage()) tagCache.store(tag, uid, uidLength, type, check, checkLength, now);
+            return tag;
+        }
+    #endif
+
+    return readTagFromCard();
+}
+
+#if HMS_PN532_TAG_CACHE_ENTRIES
+HMS_PN532_StatusTypeDef HMS_PN532::readCacheCheck(HMS_PN532_TagTypeDef type, uint8_t *check, uint8_t &checkLength) {
+    HMS_PN532_ResponseView view;
+
+    if (type == HMS_PN532_TAG_TYPE_2) {
+        if (pn532_controller->mifareultralightReadPage(MIFAREULTRALIGHT_DATA_START_PAGE, view) != HMS_PN532_OK) return HMS_PN532_ERROR;
+    } else {
+        uint8_t key[6] = { 0xD3, 0xF7, 0xD3, 0xF7, 0xD3, 0xF7 };                                         // NFC Forum key A of the NDEF sectors
+        if (pn532_controller->mifareclassicAuthenticateBlock(uid, uidLength, 4, 0, key) != HMS_PN532_OK ||
+            pn532_controller->mifareclassicReadDataBlock(4, view) != HMS_PN532_OK
+        )   return HMS_PN532_ERROR;
+    }
+
+    checkLength = (uint8_t)view.copyTo(check, 16);                                                      // Start of the NDEF TLV: type, length, first bytes
+    return HMS_PN532_OK;
+}
+#endif
+
+HMS_PN532_NFC_Tag HMS_PN532::readTagFromCard() {
     switch(getTagType()) {
         case HMS_PN532_TAG_TYPE_2: {
             #if HMS_PN532_DEBUG_ENABLED
                 pn532Logger.info("Card Type Mifare Ultralight");
             #endif
-            HMS_PN532_MifareUltralight mifareUltralight = HMS_PN532_MifareUltralight(*pn532_controller);
+            HMS_PN532_MifareUltralight mifareUltralight = HMS_PN532_MifareUltralight(*pn532_controller, type2InfoSlot());
             return mifareUltralight.readTag(uid, uidLength);
         }
         case HMS_PN532_TAG_TYPE_MIFARE_CLASSIC: {
             #if HMS_PN532_DEBUG_ENABLED
                 pn532Logger.info("Card Type Mifare Classic");
             #endif
-            HMS_PN532_MifareClassic mifareClassic = HMS_PN532_MifareClassic(*pn532_controller);
+            HMS_PN532_MifareClassic mifareClassic = HMS_PN532_MifareClassic(*pn532_controller, classicSectors());
             return mifareClassic.readTag(uid, uidLength);
         }
         default: {
             #if HMS_PN532_DEBUG_ENABLED
                 pn532Logger.warn("No driver for card type %d", getTagType());
             #endif
+            switch (targetType) {
+                case HMS_PN532_AUTOPOLL_GENERIC_212:
+                case HMS_PN532_AUTOPOLL_GENERIC_424:
+                case HMS_PN532_AUTOPOLL_FELICA_212:
+                case HMS_PN532_AUTOPOLL_FELICA_424:     return HMS_PN532_NFC_Tag(uid, uidLength, "FeliCa");
+                case HMS_PN532_AUTOPOLL_ISO14443B_106:
+                case HMS_PN532_AUTOPOLL_ISO14443_4B:    return HMS_PN532_NFC_Tag(uid, uidLength, "ISO14443B");
+                case HMS_PN532_AUTOPOLL_JEWEL_106:      return HMS_PN532_NFC_Tag(uid, uidLength, "Jewel");
+                default:                                break;
+            }
+            if (sak & 0x20) return HMS_PN532_NFC_Tag(uid, uidLength, "ISO14443-4");                   // No Type 4 NDEF driver, and no Classic or Type 2 attempt either
             return HMS_PN532_NFC_Tag(uid, uidLength);
         }
     }
 }
 
+uint8_t HMS_PN532::readTags(HMS_PN532_NFC_Tag *tags, uint8_t maxTags, unsigned long timeout) {
+    HMS_PN532_ControllerLock guard(*pn532_controller);
+
+    if (maxTags == 0) return 0;
+    if (idling && resume() != HMS_PN532_OK) return 0;
+
+    uint8_t maxTargets = (maxTags < HMS_PN532_MAX_TARGETS) ? maxTags : HMS_PN532_MAX_TARGETS;
+    tagPresent = (pn532_controller->inListPassiveTargets(maxTargets, timeout ? timeout : 1000) == HMS_PN532_OK);
+    if (!tagPresent) return 0;
+
+    if (wakePending) {
+        wakeToDetectUs = pn532_interface->pn532Micros() - wakeAtUs;
+        wakePending    = false;
+    }
+
+    uint8_t count = 0;
+    targetType = HMS_PN532_AUTOPOLL_GENERIC_106A;
+    for (uint8_t i = 0; i < pn532_controller->getTargetCount(); i++) {
+        const HMS_PN532_TargetTypeDef *target = pn532_controller->getTarget(i);
+        if (i > 0 && pn532_controller->inSelect(target->tg) != HMS_PN532_OK) continue;         // The first target is already selected
+
+        uidLength = target->uidLength;
+        memcpy(uid, target->uid, uidLength);
+        setTypeA(target->atqa, target->sak, target->ats, target->atsLength);
+        tags[count++] = readTag();
+    }
+    return count;
+}
+
+bool HMS_PN532::isTagStillPresent() {
+    HMS_PN532_ControllerLock guard(*pn532_controller);
+
+    if (!tagPresent) return false;
+
+    HMS_PN532_StatusTypeDef status;
+
+    switch (targetType) {
+        case HMS_PN532_AUTOPOLL_GENERIC_212:
+        case HMS_PN532_AUTOPOLL_GENERIC_424:
+        case HMS_PN532_AUTOPOLL_FELICA_212:
+        case HMS_PN532_AUTOPOLL_FELICA_424: {
+            uint8_t mode;
+            status = pn532_controller->felicaRequestResponse(&mode);
+            break;
+        }
+        default:
+            if (sak & 0x20) {                                                                               // ISO-DEP, the PN532 runs the presence test itself
+                status = pn532_controller->diagnosePresence();
+            } else if (getTagType() == HMS_PN532_TAG_TYPE_2) {
+                HMS_PN532_ResponseView page;
+                status = pn532_controller->mifareultralightReadPage(0, page);                              // Pages 0-3, no authentication needed
+            } else {
+                status = pn532_controller->inSelect(pn532_controller->getActiveTarget());                   // Classic reads need auth, a re-select is cheaper
+            }
+            break;
+    }
+
+    if (status == HMS_PN532_OK) return true;
+
+    tagPresent = false;
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.info("Tag removed");
+    #endif
+    if (tagRemovedCallback) tagRemovedCallback(uid, uidLength, tagRemovedContext);
+    return false;
+}
+
+void HMS_PN532::invalidateCurrentTag() {
+    #if HMS_PN532_TAG_CACHE_ENTRIES
+        tagCache.invalidate(uid, uidLength);                                                            // Called before every write: even a failed one may have changed blocks
+    #endif
+}
+
 HMS_PN532_StatusTypeDef HMS_PN532::cleanTag() {
+    HMS_PN532_ControllerLock guard(*pn532_controller);
+
+    invalidateCurrentTag();
+
     switch(getTagType()) {
         case HMS_PN532_TAG_TYPE_2: {
             #if HMS_PN532_DEBUG_ENABLED
                 pn532Logger.debug("Cleaning Mifare Ultralight");
             #endif
-            HMS_PN532_MifareUltralight mifareUltralight = HMS_PN532_MifareUltralight(*pn532_controller);
+            HMS_PN532_MifareUltralight mifareUltralight = HMS_PN532_MifareUltralight(*pn532_controller, type2InfoSlot());
             return mifareUltralight.cleanTag();
         }
         case HMS_PN532_TAG_TYPE_MIFARE_CLASSIC: {
             #if HMS_PN532_DEBUG_ENABLED
                 pn532Logger.debug("Cleaning Mifare Classic");
             #endif
-            HMS_PN532_MifareClassic mifareClassic = HMS_PN532_MifareClassic(*pn532_controller);
+            HMS_PN532_MifareClassic mifareClassic = HMS_PN532_MifareClassic(*pn532_controller, classicSectors());
             return mifareClassic.formatMifare(uid, uidLength);
         }
         default:
@@ -123,12 +417,16 @@ HMS_PN532_StatusTypeDef HMS_PN532::eraseTag() {
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532::formatTag() {
+    HMS_PN532_ControllerLock guard(*pn532_controller);
+
+    invalidateCurrentTag();
+
     switch(getTagType()) {
         case HMS_PN532_TAG_TYPE_MIFARE_CLASSIC: {
             #if HMS_PN532_DEBUG_ENABLED
                 pn532Logger.debug("Formatting Mifare Classic");
             #endif
-            HMS_PN532_MifareClassic mifareClassic = HMS_PN532_MifareClassic(*pn532_controller);
+            HMS_PN532_MifareClassic mifareClassic = HMS_PN532_MifareClassic(*pn532_controller, classicSectors());
             return mifareClassic.formatNDEF(uid, uidLength);
         }
         default: {
@@ -141,19 +439,23 @@ HMS_PN532_StatusTypeDef HMS_PN532::formatTag() {
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532::writeTag(HMS_PN532_NDEF_Message& ndefMessage) {
+    HMS_PN532_ControllerLock guard(*pn532_controller);
+
+    invalidateCurrentTag();
+
     switch(getTagType()) {
         case HMS_PN532_TAG_TYPE_2: {
             #if HMS_PN532_DEBUG_ENABLED
                 pn532Logger.debug("Writing Mifare Ultralight");
             #endif
-            HMS_PN532_MifareUltralight mifareUltralight = HMS_PN532_MifareUltralight(*pn532_controller);
+            HMS_PN532_MifareUltralight mifareUltralight = HMS_PN532_MifareUltralight(*pn532_controller, type2InfoSlot());
             return mifareUltralight.writeTag(ndefMessage, uid, uidLength);
         }
         case HMS_PN532_TAG_TYPE_MIFARE_CLASSIC: {
             #if HMS_PN532_DEBUG_ENABLED
                 pn532Logger.debug("Writing Mifare Classic");
             #endif
-            HMS_PN532_MifareClassic mifareClassic = HMS_PN532_MifareClassic(*pn532_controller);
+            HMS_PN532_MifareClassic mifareClassic = HMS_PN532_MifareClassic(*pn532_controller, classicSectors());
             return mifareClassic.writeTag(ndefMessage, uid, uidLength);
         }
         default:
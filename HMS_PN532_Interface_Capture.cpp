@@ -0,0 +1,293 @@
+#include "HMS_PN532_Interface_Capture.h"
+
+static const uint8_t CAPTURE_MAGIC[] = { 'P', 'N', 'C', 'P', HMS_PN532_CAPTURE_VERSION };
+
+static void putLE(uint8_t *out, uint32_t value, uint8_t bytes) {
+    for (uint8_t i = 0; i < bytes; i++) out[i] = (uint8_t)(value >> (8 * i));
+}
+
+static uint32_t getLE(const uint8_t *in, uint8_t bytes) {
+    uint32_t value = 0;
+    for (uint8_t i = 0; i < bytes; i++) value |= (uint32_t)in[i] << (8 * i);
+    return value;
+}
+
+bool HMS_PN532_CaptureStream::appendRecord(const HMS_PN532_CaptureRecordTypeDef &record, const HMS_PN532_SegmentTypeDef *segments, uint8_t count) {
+    uint16_t len = 0;
+    for (uint8_t i = 0; i < count; i++) {
+        uint16_t take = segments[i].len;
+        if (len + take > HMS_PN532_CAPTURE_DATA_MAX) take = HMS_PN532_CAPTURE_DATA_MAX - len;
+        memcpy(&scratch[HMS_PN532_CAPTURE_HEADER_LEN + len], segments[i].data, take);
+        len += take;
+    }
+
+    scratch[0] = record.type;
+    scratch[1] = (uint8_t)(int8_t)record.status;
+    putLE(&scratch[2], len, 2);
+    putLE(&scratch[4], record.timestampUs, 4);
+    putLE(&scratch[8], record.durationUs, 4);
+
+    return write(scratch, HMS_PN532_CAPTURE_HEADER_LEN + len);
+}
+
+bool HMS_PN532_CaptureStream::nextRecord(HMS_PN532_CaptureRecordTypeDef &record, uint8_t *data, uint16_t maxLen) {
+    uint8_t header[HMS_PN532_CAPTURE_HEADER_LEN];
+    if (read(header, sizeof(header)) != sizeof(header)) return false;
+
+    record.type         = header[0];
+    record.status       = (HMS_PN532_StatusTypeDef)(int8_t)header[1];
+    record.len          = (uint16_t)getLE(&header[2], 2);
+    record.timestampUs  = getLE(&header[4], 4);
+    record.durationUs   = getLE(&header[8], 4);
+
+    if (record.len > maxLen) return false;                                                                                      // Not written by a recorder with these limits
+    return read(data, record.len) == record.len;
+}
+
+bool HMS_PN532_CaptureBuffer::write(const uint8_t *data, uint32_t len) {
+    if (len > size - used) return false;
+    memcpy(&buffer[used], data, len);
+    used += len;
+    return true;
+}
+
+uint32_t HMS_PN532_CaptureBuffer::read(uint8_t *data, uint32_t len) {
+    if (len > used - position) len = used - position;
+    memcpy(data, &buffer[position], len);
+    position += len;
+    return len;
+}
+
+#if defined(HMS_PLATFORM_DESKTOP)
+HMS_PN532_CaptureFile::HMS_PN532_CaptureFile(const char *path, bool append) {
+    file = fopen(path, append ? "ab" : "rb");
+    #if HMS_PN532_DEBUG_ENABLED
+        if (!file) pn532Logger.error("Unable to open capture %s", path);
+    #endif
+}
+
+HMS_PN532_CaptureFile::~HMS_PN532_CaptureFile() {
+    if (file) fclose(file);
+}
+
+bool HMS_PN532_CaptureFile::write(const uint8_t *data, uint32_t len) {
+    if (!file || fwrite(data, 1, len, file) != len) return false;
+    fflush(file);                                                                                                               // A killed session keeps every record written so far
+    return true;
+}
+
+uint32_t HMS_PN532_CaptureFile::read(uint8_t *data, uint32_t len) {
+    if (!file) return 0;
+    return (uint32_t)fread(data, 1, len, file);
+}
+#endif
+
+void HMS_PN532_Interface_Recorder::record(
+    HMS_PN532_CaptureRecordType type, HMS_PN532_StatusTypeDef status, uint32_t startUs,
+    const HMS_PN532_SegmentTypeDef *segments, uint8_t count
+) {
+    if (!started) startSession();                                                                                               // init() may have run before the recorder was attached
+    if (truncated) return;                                                                                                      // Keep the capture a clean prefix of the session
+
+    HMS_PN532_CaptureRecordTypeDef entry;
+    entry.type          = type;
+    entry.status        = status;
+    entry.len           = 0;
+    entry.timestampUs   = startUs - sessionStart;
+    entry.durationUs    = pn532Micros() - startUs;
+
+    if (!stream->appendRecord(entry, segments, count)) {
+        truncated = true;
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.warn("Capture stream full, recording stopped");
+        #endif
+    }
+}
+
+void HMS_PN532_Interface_Recorder::startSession() {
+    started      = true;
+    sessionStart = pn532Micros();
+
+    const HMS_PN532_SegmentTypeDef magic = { CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC) };
+    HMS_PN532_CaptureRecordTypeDef session = { HMS_PN532_CAPTURE_SESSION, HMS_PN532_OK, 0, 0, 0 };
+    truncated = !stream->appendRecord(session, &magic, 1);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Recorder::init() {
+    startSession();
+
+    uint32_t start = pn532Micros();
+    HMS_PN532_StatusTypeDef status = inner->init();
+
+    uint8_t wakeSource = inner->hostWakeSource();                                                                               // Replay reports it back, idle() builds PowerDown from it
+    const HMS_PN532_SegmentTypeDef link = { &wakeSource, 1 };
+    record(HMS_PN532_CAPTURE_INIT, status, start, &link, 1);
+    return status;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Recorder::wakeup() {
+    uint32_t start = pn532Micros();
+    HMS_PN532_StatusTypeDef status = inner->wakeup();
+    record(HMS_PN532_CAPTURE_WAKEUP, status, start);
+    return status;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Recorder::resume() {
+    uint32_t start = pn532Micros();
+    HMS_PN532_StatusTypeDef status = inner->resume();
+    record(HMS_PN532_CAPTURE_RESUME, status, start);
+    return status;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Recorder::write(const HMS_PN532_SegmentTypeDef *segments, uint8_t count) {
+    uint32_t start = pn532Micros();
+    HMS_PN532_StatusTypeDef status = inner->write(segments, count);
+    record(HMS_PN532_CAPTURE_WRITE, status, start, segments, count);
+    return status;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Recorder::read(uint8_t* buffer, uint16_t len, uint16_t timeoutMs) {
+    uint32_t start = pn532Micros();
+    HMS_PN532_StatusTypeDef status = inner->read(buffer, len, timeoutMs);
+
+    const HMS_PN532_SegmentTypeDef response = { buffer, (uint16_t)(status == HMS_PN532_OK ? len : 0) };
+    record(HMS_PN532_CAPTURE_READ, status, start, &response, 1);
+    return status;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Recorder::read(uint8_t* buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs) {
+    uint32_t start = pn532Micros();
+    resLen = 0;
+    HMS_PN532_StatusTypeDef status = inner->read(buffer, len, resLen, timeoutMs);
+
+    const HMS_PN532_SegmentTypeDef response = { buffer, (uint16_t)(status == HMS_PN532_OK ? resLen : 0) };
+    record(HMS_PN532_CAPTURE_READ, status, start, &response, 1);
+    return status;
+}
+
+const HMS_PN532_CaptureRecordTypeDef *HMS_PN532_Interface_Replay::peek() {
+    while (!hasPending) {
+        if (!stream->nextRecord(pending, pendingData, sizeof(pendingData))) return nullptr;
+        if (pending.type != HMS_PN532_CAPTURE_SESSION) {
+            hasPending = true;
+            break;
+        }
+
+        if (pending.len != sizeof(CAPTURE_MAGIC) || memcmp(pendingData, CAPTURE_MAGIC, sizeof(CAPTURE_MAGIC) - 1) != 0 ||
+            pendingData[sizeof(CAPTURE_MAGIC) - 1] == 0 || pendingData[sizeof(CAPTURE_MAGIC) - 1] > HMS_PN532_CAPTURE_VERSION
+        ) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("Capture has an unknown format or version");
+        #endif
+            return nullptr;
+        }
+        recordedEnd  = 0;                                                                                                       // New session, new time base
+        previousType = HMS_PN532_CAPTURE_SESSION;
+    }
+    return &pending;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Replay::take(HMS_PN532_CaptureRecordType type, uint32_t startUs) {
+    const HMS_PN532_CaptureRecordTypeDef *next = peek();
+    if (!next) {
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.warn("Capture exhausted");
+    #endif
+        return HMS_PN532_TIMEOUT;
+    }
+
+    if (next->type != type) {
+        mismatches++;
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("Replay diverged: expected record %u, host issued %u", next->type, type);
+    #endif
+        return HMS_PN532_ERROR;
+    }
+
+    if (mode == HMS_PN532_REPLAY_TIMED) {
+        uint32_t target = startUs + next->durationUs;
+        if (type == HMS_PN532_CAPTURE_READ && previousType == HMS_PN532_CAPTURE_WRITE) {                                      // The PN532 kept working while the host was away
+            uint32_t deviceEnd = replayedEnd + (next->timestampUs + next->durationUs - recordedEnd);
+            if ((int32_t)(deviceEnd - target) > 0) target = deviceEnd;
+        }
+        pn532DelayUntilMicros(target);
+    }
+
+    hasPending   = false;
+    previousType = next->type;
+    recordedEnd  = next->timestampUs + next->durationUs;
+    replayedEnd  = pn532Micros();
+    return next->status;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Replay::init() {
+    const HMS_PN532_CaptureRecordTypeDef *next = peek();
+    if (next && next->type == HMS_PN532_CAPTURE_INIT) wakeSource = next->len ? pendingData[0] : 0;                              // Version 1 INIT records are empty
+    return take(HMS_PN532_CAPTURE_INIT, pn532Micros());
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Replay::wakeup() {
+    return take(HMS_PN532_CAPTURE_WAKEUP, pn532Micros());
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Replay::resume() {
+    return take(HMS_PN532_CAPTURE_RESUME, pn532Micros());
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Replay::write(const HMS_PN532_SegmentTypeDef *segments, uint8_t count) {
+    uint32_t start = pn532Micros();
+    const HMS_PN532_CaptureRecordTypeDef *next = peek();
+
+    if (next && next->type == HMS_PN532_CAPTURE_WRITE) {                                                                        // Same frame body as the one recorded?
+        uint16_t pos = 0;
+        bool same = true;
+        for (uint8_t i = 0; i < count && same; i++) {
+            if (pos + segments[i].len > next->len ||
+                memcmp(&pendingData[pos], segments[i].data, segments[i].len) != 0
+            )   same = false;
+            pos += segments[i].len;
+        }
+        if (!same || pos != next->len) {
+            mismatches++;
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("Replay diverged: host sent command 0x%02X, capture has 0x%02X",
+                count && segments[0].len ? segments[0].data[0] : 0, next->len ? pendingData[0] : 0);
+        #endif
+            return HMS_PN532_ERROR;
+        }
+    }
+
+    return take(HMS_PN532_CAPTURE_WRITE, start);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Replay::read(uint8_t* buffer, uint16_t len, uint16_t timeoutMs) {
+    uint16_t resLen = 0;
+    return read(buffer, len, resLen, timeoutMs);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Replay::read(uint8_t* buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs) {
+    (void)timeoutMs;                                                                                                            // The recorded status already says whether it timed out
+    uint32_t start = pn532Micros();
+    resLen = 0;
+
+    const HMS_PN532_CaptureRecordTypeDef *next = peek();
+    uint16_t available = (next && next->type == HMS_PN532_CAPTURE_READ) ? next->len : 0;
+
+    HMS_PN532_StatusTypeDef status = take(HMS_PN532_CAPTURE_READ, start);
+    if (status != HMS_PN532_OK) return status;
+
+    if (available > len) return HMS_PN532_NO_SPACE;
+    memcpy(buffer, pendingData, available);
+    resLen = available;
+    return HMS_PN532_OK;
+}
+
+bool HMS_PN532_Interface_Replay::isResponseReady() {
+    if (mode == HMS_PN532_REPLAY_FAST) return true;
+
+    const HMS_PN532_CaptureRecordTypeDef *next = peek();
+    if (!next || next->type != HMS_PN532_CAPTURE_READ || previousType != HMS_PN532_CAPTURE_WRITE) return true;
+
+    uint32_t readyAt = replayedEnd + (next->timestampUs - recordedEnd);
+    return (int32_t)(pn532Micros() - readyAt) >= 0;
+}
@@ -0,0 +1,900 @@
+#include "HMS_PN532_Interface_Emulator.h"
+
+#define EMULATOR_SYNTAX_ERROR   0xFFFF                                                                                          // execute(): answer with the application error frame
+
+static const uint8_t PN532_ERROR_FRAME[] = { 0x00, 0x00, 0xFF, 0x01, 0xFF, 0x7F, 0x81, 0x00 };
+static const uint8_t MIFARE_TRANSPORT_TRAILER[] = {
+    0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0x07, 0x80, 0x69, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF, 0xFF
+};                                                                                                                              // Key A, access bits, Key B
+static const uint8_t EMULATED_ATS[] = { 0x06, 0x75, 0x77, 0x81, 0x02, 0x80 };                                                  // TL, T0, TA, TB, TC, one historical byte
+static const struct {
+    uint32_t    memorySize;
+    uint8_t     version[8];
+    uint8_t     ccSize;                                                                                                         // As NXP ships them
+} EMULATED_TYPE2_VERSIONS[] = {
+    {  80, { 0x00, 0x04, 0x03, 0x01, 0x01, 0x00, 0x0B, 0x03 }, 0x06 },                                                         // Ultralight EV1 MF0UL11
+    { 164, { 0x00, 0x04, 0x03, 0x01, 0x01, 0x00, 0x0E, 0x03 }, 0x10 },                                                         // Ultralight EV1 MF0UL21
+    { 180, { 0x00, 0x04, 0x04, 0x02, 0x01, 0x00, 0x0F, 0x03 }, 0x12 },                                                         // NTAG213
+    { 540, { 0x00, 0x04, 0x04, 0x02, 0x01, 0x00, 0x11, 0x03 }, 0x3E },                                                         // NTAG215
+    { 924, { 0x00, 0x04, 0x04, 0x02, 0x01, 0x00, 0x13, 0x03 }, 0x6D },                                                         // NTAG216
+};
+
+const HMS_PN532_EmulatorTimingTypeDef HMS_PN532_Interface_Emulator::TIMING_NONE       = { 0,  0,   0,    0,  0,    0,     0    };
+const HMS_PN532_EmulatorTimingTypeDef HMS_PN532_Interface_Emulator::TIMING_I2C_100K   = { 90, 200, 1000, 94, 1000, 30000, 2000 };
+const HMS_PN532_EmulatorTimingTypeDef HMS_PN532_Interface_Emulator::TIMING_SPI_1M     = { 8,  200, 1000, 94, 1000, 30000, 2000 };
+const HMS_PN532_EmulatorTimingTypeDef HMS_PN532_Interface_Emulator::TIMING_HSU_115200 = { 87, 200, 1000, 94, 1000, 30000, 2000 };
+
+HMS_PN532_EmulatedCard::HMS_PN532_EmulatedCard(
+    HMS_PN532_EmulatedCardType type, const uint8_t *uid, uint8_t uidLen, uint8_t *memory, uint32_t memorySize
+) : cardType(type), cardMemory(memory), cardMemorySize(memorySize) {
+    cardUidLen = (uidLen > sizeof(cardUid)) ? sizeof(cardUid) : uidLen;
+    memcpy(cardUid, uid, cardUidLen);
+
+    memset(felicaIdm, 0, sizeof(felicaIdm));
+    memset(felicaPmm, 0, sizeof(felicaPmm));
+    memcpy(felicaIdm, uid, (cardUidLen < 8) ? cardUidLen : 8);                                                                 // FeliCa cards are addressed by IDm
+
+    ccSize = (uint8_t)((memorySize > 16) ? (memorySize - 16) / 8 : 0);
+    for (const auto &known : EMULATED_TYPE2_VERSIONS) {
+        if (type == HMS_PN532_EMULATED_MIFARE_ULTRALIGHT && memorySize == known.memorySize) {
+            memcpy(cardVersion, known.version, sizeof(cardVersion));
+            hasVersion = true;
+            ccSize     = known.ccSize;
+        }
+    }
+
+    switch (type) {
+        case HMS_PN532_EMULATED_MIFARE_CLASSIC_1K:  cardAtqa = 0x0004; cardSak = 0x08; break;
+        case HMS_PN532_EMULATED_MIFARE_CLASSIC_4K:  cardAtqa = 0x0002; cardSak = 0x18; break;
+        case HMS_PN532_EMULATED_MIFARE_ULTRALIGHT:  cardAtqa = 0x0044; cardSak = 0x00; break;
+        default:                                    cardAtqa = 0x0000; cardSak = 0x00; break;
+    }
+}
+
+void HMS_PN532_EmulatedCard::format() {
+    memset(cardMemory, 0, cardMemorySize);
+
+    if (cardType == HMS_PN532_EMULATED_MIFARE_CLASSIC_1K || cardType == HMS_PN532_EMULATED_MIFARE_CLASSIC_4K) {
+        uint8_t bcc = 0;
+        for (uint8_t i = 0; i < 4 && i < cardUidLen; i++) bcc ^= cardUid[i];
+        memcpy(cardMemory, cardUid, (cardUidLen < 4) ? cardUidLen : 4);                                                        // Block 0: UID, BCC, SAK, ATQA
+        cardMemory[4] = bcc;
+        cardMemory[5] = cardSak;
+        cardMemory[6] = (uint8_t)cardAtqa;
+        cardMemory[7] = (uint8_t)(cardAtqa >> 8);
+
+        for (uint32_t block = 0; (block + 1) * 16 <= cardMemorySize; block++) {
+            bool trailer = (block < 128) ? ((block & 3) == 3) : ((block & 15) == 15);
+            if (trailer) memcpy(&cardMemory[block * 16], MIFARE_TRANSPORT_TRAILER, 16);
+        }
+    } else if (cardType == HMS_PN532_EMULATED_MIFARE_ULTRALIGHT && cardMemorySize >= 24) {
+        cardMemory[0] = cardUid[0];                                                                                             // Pages 0-2: UID0-2, BCC0, UID3-6, BCC1
+        cardMemory[1] = cardUid[1];
+        cardMemory[2] = cardUid[2];
+        cardMemory[3] = 0x88 ^ cardUid[0] ^ cardUid[1] ^ cardUid[2];
+        memcpy(&cardMemory[4], &cardUid[3], 4);
+        cardMemory[8] = cardUid[3] ^ cardUid[4] ^ cardUid[5] ^ cardUid[6];
+
+        cardMemory[12] = 0xE1;                                                                                                  // Page 3: NDEF capability container
+        cardMemory[13] = 0x10;
+        cardMemory[14] = ccSize;
+        cardMemory[15] = 0x00;
+
+        cardMemory[16] = 0x03;                                                                                                  // Page 4: empty NDEF TLV + terminator
+        cardMemory[17] = 0x00;
+        cardMemory[18] = 0xFE;
+    }
+}
+
+bool HMS_PN532_EmulatedCard::loadImage(const uint8_t *image, uint32_t len) {
+    if (len > cardMemorySize) return false;
+    memcpy(cardMemory, image, len);
+    return true;
+}
+
+#if defined(HMS_PLATFORM_DESKTOP)
+bool HMS_PN532_EmulatedCard::loadImage(const char *path) {
+    FILE *file = fopen(path, "rb");
+    if (!file) {
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("Unable to open card image %s", path);
+    #endif
+        return false;
+    }
+
+    size_t len = fread(cardMemory, 1, cardMemorySize, file);
+    fclose(file);
+    return len > 0;
+}
+
+bool HMS_PN532_EmulatedCard::saveImage(const char *path) const {
+    FILE *file = fopen(path, "wb");
+    if (!file) return false;
+
+    size_t len = fwrite(cardMemory, 1, cardMemorySize, file);
+    fclose(file);
+    return len == cardMemorySize;
+}
+#endif
+
+void HMS_PN532_EmulatedCard::setVersion(const uint8_t *version) {
+    hasVersion = (version != nullptr);
+    if (version) memcpy(cardVersion, version, sizeof(cardVersion));
+}
+
+void HMS_PN532_EmulatedCard::setFelicaIds(const uint8_t *idm, const uint8_t *pmm, uint16_t systemCode) {
+    memcpy(felicaIdm, idm, 8);
+    memcpy(felicaPmm, pmm, 8);
+    felicaSystemCode = systemCode;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Emulator::init() {
+    responsePending = false;
+    targetActive    = false;
+    authSector      = -1;
+    maxRetries      = 0xFF;
+    poweredDown     = false;
+    wakeIrq         = false;
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.info("PN532 emulator initialized");
+    #endif
+
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Emulator::wakeup() {
+    pn532DelayUntilMicros(pn532Micros() + busTime(1) + timing.ackUs);
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Emulator::resume() {
+    uint32_t start = pn532Micros();
+
+    if (!poweredDown) {
+        pn532DelayUntilMicros(start + busTime(1));
+        return HMS_PN532_OK;
+    }
+    if (!(wakeSources & hostLink)) return HMS_PN532_ERROR;                                                                     // The PN532 ignores this link while powered down
+
+    poweredDown = false;
+    wakeIrq     = false;
+    pn532DelayUntilMicros(start + busTime(1) + timing.wakeUs);
+    return HMS_PN532_OK;
+}
+
+void HMS_PN532_Interface_Emulator::applyExternalField() {
+    if (!poweredDown || !(wakeSources & HMS_PN532_WAKEUP_RF)) return;
+
+    poweredDown = false;
+    wakeIrq     = wakeIrqEnabled;
+}
+
+void HMS_PN532_Interface_Emulator::insertCard(HMS_PN532_EmulatedCard *newCard) {
+    memset(field, 0, sizeof(field));
+    field[0]     = newCard;
+    card         = nullptr;
+    listedCount  = 0;
+    targetActive = false;                                                                                                       // A card entering the field starts unselected
+    authSector   = -1;
+}
+
+bool HMS_PN532_Interface_Emulator::addCard(HMS_PN532_EmulatedCard *newCard) {
+    for (uint8_t i = 0; i < HMS_PN532_MAX_TARGETS; i++) {
+        if (field[i]) continue;
+        field[i] = newCard;                                                                                                     // Joins the field unselected, the listing is kept
+        return true;
+    }
+    return false;
+}
+
+bool HMS_PN532_Interface_Emulator::inField(const HMS_PN532_EmulatedCard *target) const {
+    for (uint8_t i = 0; target && i < HMS_PN532_MAX_TARGETS; i++) {
+        if (field[i] == target) return true;
+    }
+    return false;
+}
+
+bool HMS_PN532_Interface_Emulator::selectTarget(uint8_t tg, uint32_t &busyUs) {
+    if (!targetActive || tg == 0 || tg > listedCount) return false;
+
+    if (card != listed[tg - 1]) {                                                                                               // The current target is halted, the new one is re-selected
+        card       = listed[tg - 1];
+        authSector = -1;
+        busyUs    += rfTime(9);                                                                                                 // HLTA + WUPA + SELECT
+    }
+    return true;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Emulator::checkFrame(const uint8_t *hostFrame, uint16_t len, const uint8_t *&body, uint16_t &bodyLen) {
+    uint16_t expected = frameLength(hostFrame);
+    if (expected == 0 || expected != len) return HMS_PN532_INVALID_FRAME;
+
+    uint8_t header = frameHeaderLength(hostFrame);
+    uint16_t infoLen = expected - header - 2;
+    uint8_t lcs = (header == 5) ? (uint8_t)(hostFrame[3] + hostFrame[4]) : (uint8_t)(hostFrame[5] + hostFrame[6] + hostFrame[7]);
+    if (lcs != 0 || infoLen < 2 || hostFrame[header] != HMS_PN532_HOSTTOPN532) return HMS_PN532_INVALID_FRAME;
+    if (infoLen > maxInfoLength) return HMS_PN532_INVALID_FRAME;                                                               // More than the modelled link carries
+
+    uint8_t sum = 0;
+    for (uint16_t i = 0; i <= infoLen; i++) sum += hostFrame[header + i];                                                     // TFI..PD plus DCS sums to zero
+    if (sum != 0 || hostFrame[header + infoLen + 1] != HMS_PN532_POSTAMBLE) return HMS_PN532_INVALID_FRAME;
+
+    body    = &hostFrame[header + 1];
+    bodyLen = infoLen - 1;
+    return HMS_PN532_OK;
+}
+
+#if defined(HMS_PLATFORM_DESKTOP)
+HMS_PN532_Interface_Emulator::~HMS_PN532_Interface_Emulator() {
+    enableReadyEvent(false);
+}
+
+void HMS_PN532_Interface_Emulator::enableReadyEvent(bool enable) {
+    if (enable == irqThread.joinable()) return;
+
+    if (enable) {
+        irqStop    = false;
+        irqPending = false;
+        irqEvent.reset();
+        irqThread  = std::thread(&HMS_PN532_Interface_Emulator::raiseReadyEvents, this);
+        setReadySignal(&irqEvent);
+        return;
+    }
+
+    {
+        std::lock_guard<std::mutex> guard(irqLock);
+        irqStop = true;
+    }
+    irqArmed.notify_all();
+    irqThread.join();
+    setReadySignal(nullptr);
+}
+
+void HMS_PN532_Interface_Emulator::scheduleReadyEvent(bool pending, uint32_t atUs) {
+    if (!irqThread.joinable()) return;
+
+    {
+        std::lock_guard<std::mutex> guard(irqLock);                                                                             // Drops an earlier, unread response's edge
+        irqEvent.reset();
+        irqAtUs    = atUs;
+        irqPending = pending;
+    }
+    irqArmed.notify_all();
+}
+
+void HMS_PN532_Interface_Emulator::raiseReadyEvents() {                                                                        // Stands in for the PN532 pulling IRQ low
+    std::unique_lock<std::mutex> guard(irqLock);
+
+    while (!irqStop) {
+        if (!irqPending) {
+            irqArmed.wait(guard);
+            continue;
+        }
+
+        int32_t remaining = (int32_t)(irqAtUs - pn532Micros());
+        if (remaining > 0) {
+            irqArmed.wait_for(guard, std::chrono::microseconds(remaining));                                                     // Re-armed or stopped meanwhile: start over
+            continue;
+        }
+
+        irqPending = false;
+        irqEvent.set();
+    }
+}
+#endif
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Emulator::write(const HMS_PN532_SegmentTypeDef *segments, uint8_t count) {
+    uint8_t hostFrame[HMS_PN532_FRAME_MAX_LEN];
+    uint16_t hostLen = encodeFrame(hostFrame, segments, count);
+
+    if (hostLen == 0) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("Frame too long for an information frame");
+        #endif
+        return HMS_PN532_INVALID_FRAME;
+    }
+
+    return writeRawFrame(hostFrame, hostLen);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Emulator::writeRawFrame(const uint8_t *hostFrame, uint16_t hostLen) {
+    uint32_t start = pn532Micros();
+    wakeIrq = false;
+    #if defined(HMS_PLATFORM_DESKTOP)
+        scheduleReadyEvent(false);
+    #endif
+
+    if (poweredDown) {                                                                                                          // The access may wake it, the frame itself is lost
+        if (wakeSources & hostLink) poweredDown = false;
+        pn532DelayUntilMicros(start + busTime(hostLen) + ((wakeSources & hostLink) ? timing.wakeUs : 0));
+        return HMS_PN532_TIMEOUT;
+    }
+
+    const uint8_t *body;
+    uint16_t bodyLen;
+    if (checkFrame(hostFrame, hostLen, body, bodyLen) != HMS_PN532_OK) {                                                        // A real PN532 would stay silent
+        pn532DelayUntilMicros(start + busTime(hostLen));
+        return HMS_PN532_TIMEOUT;
+    }
+
+    command = body[0];
+    commandCount++;
+    bytesOut += hostLen;
+    bytesIn  += 6;                                                                                                              // ACK
+
+    uint8_t out[HMS_PN532_EXTENDED_INFO_MAX];
+    uint32_t busyUs = 0;
+    uint16_t outLen = execute(body, bodyLen, out, busyUs);
+
+    responsePending = true;
+    responseNever   = (outLen == 0);
+    if (outLen == EMULATOR_SYNTAX_ERROR) {
+        memcpy(frame, PN532_ERROR_FRAME, sizeof(PN532_ERROR_FRAME));
+        frameLen = sizeof(PN532_ERROR_FRAME);
+    } else if (outLen) {
+        const HMS_PN532_SegmentTypeDef response = { out, outLen };
+        frameLen = encodeFrame(frame, &response, 1, HMS_PN532_PN532TOHOST);
+    }
+
+    pn532DelayUntilMicros(start + busTime(hostLen + 6) + timing.ackUs);                                                        // Frame in, ACK out
+    readyAtUs = pn532Micros() + timing.processingUs + busyUs;
+
+    #if defined(HMS_PLATFORM_DESKTOP)
+        scheduleReadyEvent(!responseNever, readyAtUs);
+    #endif
+    return HMS_PN532_OK;
+}
+
+bool HMS_PN532_Interface_Emulator::isResponseReady() {
+    #if defined(HMS_PLATFORM_DESKTOP)
+        if (irqThread.joinable()) return !poweredDown && irqEvent.isAsserted();
+    #endif
+    return !poweredDown && responsePending && !responseNever && (int32_t)(pn532Micros() - readyAtUs) >= 0;
+}
+
+bool HMS_PN532_Interface_Emulator::waitForResponse(uint16_t timeoutMs) {
+    #if defined(HMS_PLATFORM_DESKTOP)
+        if (irqThread.joinable()) return irqEvent.wait(timeoutMs);                                                              // Woken by raiseReadyEvents()
+    #endif
+
+    if (hostLink == HMS_PN532_WAKEUP_HSU) {                                                                                     // The frame just arrives on RX
+        pn532DelayUntilMicros(readyAtUs);
+        return true;
+    }
+
+    while (true) {                                                                                                              // Status read, then 1 ms, as the I2C and SPI transports do
+        pn532DelayUntilMicros(pn532Micros() + busTime(statusBytes()));
+        if ((int32_t)(pn532Micros() - readyAtUs) >= 0) return true;
+        pn532Delay(1);
+    }
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Emulator::read(uint8_t *buffer, uint16_t len, uint16_t timeoutMs) {
+    uint16_t resLen = 0;
+    return read(buffer, len, resLen, timeoutMs);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Emulator::read(uint8_t *buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs) {
+    resLen = 0;
+
+    HMS_PN532_StatusTypeDef status = takeResponse(timeoutMs);
+    if (status != HMS_PN532_OK) return status;
+
+    return parseFrame(frame, command, buffer, len, resLen);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Emulator::readRawFrame(uint8_t *buffer, uint16_t size, uint16_t &frameSize, uint16_t timeoutMs) {
+    frameSize = 0;
+
+    HMS_PN532_StatusTypeDef status = takeResponse(timeoutMs);
+    if (status != HMS_PN532_OK) return status;
+    if (frameLen > size) return HMS_PN532_NO_SPACE;
+
+    memcpy(buffer, frame, frameLen);
+    frameSize = frameLen;
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Emulator::waitResponseReady(uint16_t timeoutMs) {
+    uint32_t start = pn532Micros();
+
+    if (!responsePending || responseNever || (timeoutMs && (int32_t)(readyAtUs - start) > (int32_t)timeoutMs * 1000)) {
+        if (timeoutMs) pn532DelayUntilMicros(start + (uint32_t)timeoutMs * 1000);
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.warn("Timeout waiting for response");
+        #endif
+        return HMS_PN532_TIMEOUT;
+    }
+
+    return waitForResponse(timeoutMs) ? HMS_PN532_OK : HMS_PN532_TIMEOUT;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_Emulator::takeResponse(uint16_t timeoutMs) {
+    HMS_PN532_StatusTypeDef status = waitResponseReady(timeoutMs);
+    if (status != HMS_PN532_OK) return status;
+
+    pn532DelayUntilMicros(pn532Micros() + busTime(frameLen));
+    responsePending = false;
+    #if defined(HMS_PLATFORM_DESKTOP)
+        irqEvent.reset();                                                                                                       // The line goes high once the frame is read
+    #endif
+    bytesIn += frameLen;
+
+    if (powerDownPending) {
+        powerDownPending = false;
+        poweredDown      = true;
+        targetActive     = false;                                                                                               // The RF field goes down with it
+        authSector       = -1;
+    }
+
+    return HMS_PN532_OK;
+}
+
+uint16_t HMS_PN532_Interface_Emulator::execute(const uint8_t *body, uint16_t bodyLen, uint8_t *out, uint32_t &busyUs) {
+    out[0] = body[0] + 1;
+
+    switch (body[0]) {
+        case HMS_PN532_COMMAND_GETFIRMWAREVERSION:
+            out[1] = (uint8_t)(firmwareVersion >> 24);
+            out[2] = (uint8_t)(firmwareVersion >> 16);
+            out[3] = (uint8_t)(firmwareVersion >> 8);
+            out[4] = (uint8_t)firmwareVersion;
+            return 5;
+
+        case HMS_PN532_COMMAND_DIAGNOSE:
+            if (bodyLen < 2 || body[1] != HMS_PN532_DIAGNOSE_PRESENCE) return EMULATOR_SYNTAX_ERROR;                          // Only the presence test is modelled
+            if (!targetActive || !card) {
+                out[1] = 0x27;
+                return 2;
+            }
+            busyUs = inField(card) ? rfTime(4) : timing.pollCycleUs;                                                           // R(NAK) and its R(ACK), or a timeout
+            out[1] = inField(card) ? 0x00 : 0x01;
+            return 2;
+
+        case HMS_PN532_COMMAND_GETGENERALSTATUS: {
+            uint16_t pos = 1;
+            out[pos++] = 0x00;                                                                                                  // Last error
+            out[pos++] = 0x00;                                                                                                  // No external field, target mode is not modelled
+            out[pos++] = targetActive ? listedCount : 0;
+            for (uint8_t i = 0; targetActive && i < listedCount; i++) {
+                uint8_t baudrate = (listed[i]->getType() == HMS_PN532_EMULATED_FELICA) ? 0x01 : 0x00;
+                out[pos++] = (uint8_t)(i + 1);                                                                                  // Tg
+                out[pos++] = baudrate;                                                                                          // BrRx
+                out[pos++] = baudrate;                                                                                          // BrTx
+                out[pos++] = baudrate ? 0x10 : 0x00;                                                                            // Modulation type
+            }
+            out[pos++] = 0x00;                                                                                                  // SAM status
+            return pos;
+        }
+
+        case HMS_PN532_COMMAND_READREGISTER: {
+            uint16_t pos = 1;
+            for (uint16_t i = 1; i + 1 < bodyLen; i += 2) out[pos++] = 0x00;                                                    // No register file is modelled
+            return pos;
+        }
+
+        case HMS_PN532_COMMAND_READGPIO:
+            out[1] = 0xFF;                                                                                                      // P3, P7, interface mode pins
+            out[2] = 0xFF;
+            out[3] = 0x00;
+            return 4;
+
+        case HMS_PN532_COMMAND_WRITEREGISTER:
+        case HMS_PN532_COMMAND_WRITEGPIO:
+        case HMS_PN532_COMMAND_SETPARAMETERS:
+        case HMS_PN532_COMMAND_SAMCONFIGURATION:
+            return 1;
+
+        case HMS_PN532_COMMAND_SETSERIALBAUDRATE:                                                                              // The link switches rate once the host ACKs this, that part is the link's
+            if (bodyLen < 2 || body[1] > 0x08) return EMULATOR_SYNTAX_ERROR;
+            return 1;
+
+        case HMS_PN532_COMMAND_POWERDOWN:
+            if (bodyLen < 2) return EMULATOR_SYNTAX_ERROR;
+            wakeSources      = body[1];
+            wakeIrqEnabled   = (bodyLen >= 3 && (body[2] & 0x01));
+            powerDownPending = true;
+            out[1] = 0x00;
+            return 2;
+
+        case HMS_PN532_COMMAND_RFCONFIGURATION:
+            if (bodyLen >= 5 && body[1] == 0x05) maxRetries = body[4];                                                          // MxRtyATR, MxRtyPSL, MxRtyPassiveActivation
+            if (bodyLen >= 3 && body[1] == 0x01 && !(body[2] & 0x01)) targetActive = false;                                   // RF field switched off
+            return 1;
+
+        case HMS_PN532_COMMAND_INLISTPASSIVETARGET:
+            return inListPassiveTarget(body, bodyLen, out, busyUs);
+
+        case HMS_PN532_COMMAND_INAUTOPOLL:
+            return inAutoPoll(body, bodyLen, out, busyUs);
+
+        case HMS_PN532_COMMAND_INDATAEXCHANGE:
+            return inDataExchange(body, bodyLen, out, busyUs);
+
+        case HMS_PN532_COMMAND_INCOMMUNICATETHRU:
+            return inCommunicateThru(body, bodyLen, out, busyUs);
+
+        case HMS_PN532_COMMAND_INSELECT:
+            if (bodyLen < 2) return EMULATOR_SYNTAX_ERROR;
+            card   = nullptr;                                                                                                   // InSelect always re-selects, even the current target
+            out[1] = selectTarget(body[1], busyUs) ? (inField(card) ? 0x00 : 0x01) : 0x27;                                    // Timeout when the target has left
+            return 2;
+
+        case HMS_PN532_COMMAND_INDESELECT:
+            card       = nullptr;                                                                                               // Targets stay listed, InSelect or InDataExchange wakes them
+            authSector = -1;
+            out[1] = 0x00;
+            return 2;
+
+        case HMS_PN532_COMMAND_INRELEASE:
+            targetActive = false;
+            listedCount  = 0;
+            card         = nullptr;
+            authSector   = -1;
+            out[1] = 0x00;
+            return 2;
+
+        default:
+            #if HMS_PN532_DEBUG_ENABLED
+                pn532Logger.warn("Emulator: command 0x%02X is not modelled", body[0]);
+            #endif
+            return EMULATOR_SYNTAX_ERROR;
+    }
+}
+
+uint16_t HMS_PN532_Interface_Emulator::inAutoPoll(const uint8_t *body, uint16_t bodyLen, uint8_t *out, uint32_t &busyUs) {
+    if (bodyLen < 4 || bodyLen > 3 + HMS_PN532_AUTOPOLL_MAX_TYPES || body[1] == 0 || body[2] == 0 || body[2] > 0x0F) {
+        return EMULATOR_SYNTAX_ERROR;
+    }
+
+    uint8_t  pollCount = body[1];
+    uint32_t periodUs  = (uint32_t)body[2] * HMS_PN532_AUTOPOLL_PERIOD_MS * 1000;
+    const uint8_t *types = &body[3];
+    uint8_t typeCount = (uint8_t)(bodyLen - 3);
+
+    const HMS_PN532_EmulatedCard *first = field[0];
+    for (uint8_t i = 0; first && i < typeCount; i++) {                                                                         // The card answers in the first round it is polled
+        bool typeA  = types[i] == HMS_PN532_AUTOPOLL_GENERIC_106A || types[i] == HMS_PN532_AUTOPOLL_MIFARE;
+        bool felica = types[i] == HMS_PN532_AUTOPOLL_GENERIC_212 || types[i] == HMS_PN532_AUTOPOLL_GENERIC_424 ||
+                      types[i] == HMS_PN532_AUTOPOLL_FELICA_212  || types[i] == HMS_PN532_AUTOPOLL_FELICA_424;
+        if (!(typeA && first->getType() != HMS_PN532_EMULATED_FELICA) && !(felica && first->getType() == HMS_PN532_EMULATED_FELICA)) {
+            busyUs += timing.pollCycleUs;                                                                                       // One silent activation attempt
+            continue;
+        }
+
+        const uint8_t baudrate = typeA ? HMS_PN532_MIFARE_ISO14443A : ((types[i] & 0x0F) == 0x02 ? 0x02 : 0x01);
+        const uint8_t request[] = { HMS_PN532_COMMAND_INLISTPASSIVETARGET, 1, baudrate, 0x00, 0xFF, 0xFF, 0x00, 0x00 };
+        uint8_t listed[HMS_PN532_EXTENDED_INFO_MAX];
+        uint32_t listUs = 0;
+        uint16_t listedLen = inListPassiveTarget(request, typeA ? 3 : sizeof(request), listed, listUs);
+
+        out[1] = 1;                                                                                                             // NbTg, Type, Length, InListPassiveTarget target data
+        out[2] = types[i];
+        out[3] = (uint8_t)(listedLen - 2);
+        memcpy(&out[4], &listed[2], listedLen - 2);
+        busyUs += listUs;
+        return 4 + listedLen - 2;
+    }
+
+    if (pollCount == HMS_PN532_AUTOPOLL_FOREVER) return 0;                                                                      // Keeps scanning until the host gives up
+    busyUs = (uint32_t)pollCount * (periodUs + typeCount * timing.pollCycleUs);
+    out[1] = 0;
+    return 2;
+}
+
+uint16_t HMS_PN532_Interface_Emulator::inListPassiveTarget(const uint8_t *body, uint16_t bodyLen, uint8_t *out, uint32_t &busyUs) {
+    if (bodyLen < 3 || body[1] == 0 || body[1] > HMS_PN532_MAX_TARGETS) return EMULATOR_SYNTAX_ERROR;
+
+    uint8_t  maxTg      = body[1];
+    uint8_t  baudrate   = body[2];
+    uint16_t systemCode = (bodyLen >= 6) ? (uint16_t)((body[4] << 8) | body[5]) : 0xFFFF;                                     // 00 SC1 SC0 RC TSN
+
+    listedCount = 0;
+    for (uint8_t i = 0; i < HMS_PN532_MAX_TARGETS && listedCount < maxTg; i++) {
+        HMS_PN532_EmulatedCard *candidate = field[i];
+        if (!candidate) continue;
+
+        bool typeA  = baudrate == HMS_PN532_MIFARE_ISO14443A && candidate->getType() != HMS_PN532_EMULATED_FELICA;
+        bool felica = (baudrate == 0x01 || baudrate == 0x02) && candidate->getType() == HMS_PN532_EMULATED_FELICA &&
+                      (systemCode == 0xFFFF || systemCode == candidate->getSystemCode());
+        if (typeA || felica) listed[listedCount++] = candidate;
+    }
+
+    if (listedCount == 0) {
+        targetActive = false;
+        card         = nullptr;
+        if (maxRetries == 0xFF) return 0;                                                                                       // Keeps polling until the host gives up
+        busyUs = (uint32_t)(maxRetries + 1) * timing.pollCycleUs;
+        out[1] = 0;
+        return 2;
+    }
+
+    targetActive = true;
+    authSector   = -1;
+    card         = listed[0];                                                                                                   // The first target is left selected
+    out[1] = listedCount;                                                                                                       // NbTg
+
+    uint16_t pos = 2;
+    bool withSystemCode = (bodyLen >= 7 && body[6] == 0x01);
+    busyUs = 0;
+    for (uint8_t i = 0; i < listedCount; i++) {
+        const HMS_PN532_EmulatedCard *target = listed[i];
+        out[pos++] = (uint8_t)(i + 1);                                                                                          // Tg
+
+        if (baudrate == HMS_PN532_MIFARE_ISO14443A) {
+            out[pos++] = (uint8_t)(target->getAtqa() >> 8);
+            out[pos++] = (uint8_t)target->getAtqa();
+            out[pos++] = target->getSak();
+            out[pos++] = target->getUidLength();
+            memcpy(&out[pos], target->getUid(), target->getUidLength());
+            pos += target->getUidLength();
+            busyUs += rfTime(4 + 7 * ((target->getUidLength() + 2) / 3));                                                      // REQA + one anticollision/select per cascade level
+            if (target->getSak() & 0x20) {                                                                                      // Automatic RATS, the ATS follows the UID
+                memcpy(&out[pos], EMULATED_ATS, sizeof(EMULATED_ATS));
+                pos += sizeof(EMULATED_ATS);
+                busyUs += rfTime(4 + sizeof(EMULATED_ATS));
+            }
+            continue;
+        }
+
+        uint8_t polResLen = withSystemCode ? 20 : 18;                                                                           // POL_RES length
+        out[pos++] = polResLen;
+        out[pos++] = 0x01;
+        memcpy(&out[pos], target->getIdm(), 8);
+        memcpy(&out[pos + 8], target->getPmm(), 8);
+        pos += 16;
+        if (withSystemCode) {
+            out[pos++] = (uint8_t)(target->getSystemCode() >> 8);
+            out[pos++] = (uint8_t)target->getSystemCode();
+        }
+        busyUs += rfTime(6 + polResLen) / 2;                                                                                    // 212 kbps
+    }
+    return pos;
+}
+
+uint16_t HMS_PN532_Interface_Emulator::inDataExchange(const uint8_t *body, uint16_t bodyLen, uint8_t *out, uint32_t &busyUs) {
+    if (bodyLen < 3) return EMULATOR_SYNTAX_ERROR;
+
+    uint32_t selectUs = 0;
+    if (!selectTarget(body[1] & 0x0F, selectUs)) {                                                                             // Nothing listed under that Tg, bit 6 is MI
+        out[1] = 0x27;
+        return 2;
+    }
+
+    if (!inField(card) || (card->getSak() & 0x20)) {                                                                           // Card left the field, or ISO-DEP ignores MIFARE commands
+        busyUs = selectUs + timing.pollCycleUs;
+        out[1] = 0x01;
+        return 2;
+    }
+
+    uint16_t outLen;
+    switch (card->getType()) {
+        case HMS_PN532_EMULATED_MIFARE_CLASSIC_1K:
+        case HMS_PN532_EMULATED_MIFARE_CLASSIC_4K:
+            outLen = mifareClassicExchange(body + 2, bodyLen - 2, out, busyUs);
+            break;
+        case HMS_PN532_EMULATED_MIFARE_ULTRALIGHT:
+            outLen = mifareUltralightExchange(body + 2, bodyLen - 2, out, busyUs);
+            break;
+        default:
+            outLen = felicaExchange(body + 2, bodyLen - 2, out, busyUs);
+            break;
+    }
+    busyUs += selectUs;
+    return outLen;
+}
+
+uint16_t HMS_PN532_Interface_Emulator::inCommunicateThru(const uint8_t *body, uint16_t bodyLen, uint8_t *out, uint32_t &busyUs) {
+    if (bodyLen < 2) return EMULATOR_SYNTAX_ERROR;
+
+    if (!card) {                                                                                                                // Goes to the selected target only
+        out[1] = 0x27;
+        return 2;
+    }
+
+    if (!inField(card)) {
+        busyUs = timing.pollCycleUs;
+        out[1] = 0x01;
+        return 2;
+    }
+
+    if (card->getType() != HMS_PN532_EMULATED_MIFARE_ULTRALIGHT || (card->getSak() & 0x20)) {                                  // Raw frames are only modelled for Type 2
+        busyUs = rfTime(bodyLen - 1);
+        out[1] = 0x01;
+        return 2;
+    }
+
+    const uint8_t *data = body + 1;
+    uint16_t len    = bodyLen - 1;
+    uint16_t pages  = (uint16_t)(card->getMemorySize() / 4);
+
+    if (data[0] == HMS_PN532_NTAG_CMD_GET_VERSION) {
+        busyUs = rfTime(1 + 8 + 2);
+        out[1] = card->getVersion() ? 0x00 : 0x01;                                                                             // Original Ultralight and Ultralight C NAK
+        if (!card->getVersion()) return 2;
+
+        memcpy(&out[2], card->getVersion(), 8);
+        return 10;
+    }
+
+    if (data[0] != HMS_PN532_NTAG_CMD_FAST_READ) return mifareUltralightExchange(data, len, out, busyUs);
+
+    out[1] = 0x00;
+    busyUs = rfTime(len + 2);
+    if (len < 3 || !card->getVersion() || data[1] > data[2] || data[2] >= pages) {                                             // Tags without GET_VERSION have no FAST_READ either
+        out[1] = 0x01;
+        return 2;
+    }
+
+    uint16_t bytes = (uint16_t)(data[2] - data[1] + 1) * 4;
+    if (1 + 2 + bytes > maxInformationLength()) return EMULATOR_SYNTAX_ERROR;                                                  // TFI, code and status, the rest must fit one frame
+
+    memcpy(&out[2], &card->getMemory()[data[1] * 4], bytes);
+    busyUs = rfTime(3 + bytes + 2);
+    return 2 + bytes;
+}
+
+uint16_t HMS_PN532_Interface_Emulator::mifareClassicExchange(const uint8_t *data, uint16_t len, uint8_t *out, uint32_t &busyUs) {
+    uint8_t *memory = card->getMemory();
+    uint16_t blocks = (uint16_t)(card->getMemorySize() / 16);
+    uint8_t  block  = (len >= 2) ? data[1] : 0;
+    int16_t  sector = (block < 128) ? (block / 4) : (32 + (block - 128) / 16);
+    uint16_t trailer = (block < 128) ? (block | 3) : (block | 15);
+
+    out[1] = 0x00;
+    busyUs = rfTime(len + 2);
+
+    switch (data[0]) {
+        case HMS_PN532_MIFARE_CMD_AUTH_A:
+        case HMS_PN532_MIFARE_CMD_AUTH_B: {
+            if (len < 12 || block >= blocks) return EMULATOR_SYNTAX_ERROR;
+
+            const uint8_t *key = &memory[trailer * 16 + ((data[0] == HMS_PN532_MIFARE_CMD_AUTH_A) ? 0 : 10)];
+            const uint8_t *uid = card->getUid() + card->getUidLength() - 4;                                                   // Auth uses the last four UID bytes
+            busyUs = rfTime(4 + 8 + 8);                                                                                         // Three-pass challenge/response
+
+            if (memcmp(&data[2], key, 6) != 0 || memcmp(&data[8], uid, 4) != 0) {
+                authSector = -1;
+                out[1] = 0x14;                                                                                                  // MIFARE authentication error
+            } else {
+                authSector = sector;
+            }
+            return 2;
+        }
+
+        case HMS_PN532_MIFARE_CMD_READ:
+            if (block >= blocks || authSector != sector) {
+                authSector = -1;                                                                                                // A NAK halts the card
+                out[1] = 0x14;
+                return 2;
+            }
+            memcpy(&out[2], &memory[block * 16], 16);
+            if (block == trailer) memset(&out[2], 0, 6);                                                                        // Key A never reads back
+            busyUs = rfTime(2 + 18);
+            return 18;
+
+        case HMS_PN532_MIFARE_CMD_WRITE:
+            if (len < 18 || block >= blocks || block == 0 || authSector != sector) {                                            // Block 0 is manufacturer data
+                authSector = -1;
+                out[1] = 0x14;
+                return 2;
+            }
+            memcpy(&memory[block * 16], &data[2], 16);
+            busyUs = rfTime(2 + 16) + timing.cardResponseUs;                                                                    // Two-step write, then EEPROM programming
+            return 2;
+
+        default:
+            authSector = -1;
+            out[1] = 0x01;                                                                                                      // Card does not answer
+            return 2;
+    }
+}
+
+uint16_t HMS_PN532_Interface_Emulator::mifareUltralightExchange(const uint8_t *data, uint16_t len, uint8_t *out, uint32_t &busyUs) {
+    uint8_t *memory = card->getMemory();
+    uint16_t pages  = (uint16_t)(card->getMemorySize() / 4);
+    uint8_t  page   = (len >= 2) ? data[1] : 0;
+
+    out[1] = 0x00;
+    busyUs = rfTime(len + 2);
+
+    switch (data[0]) {
+        case HMS_PN532_MIFARE_CMD_READ:
+            if (page >= pages) break;
+            for (uint8_t i = 0; i < 16; i++) out[2 + i] = memory[((page + i / 4) % pages) * 4 + (i % 4)];                      // Four pages, rolling over at the end
+            busyUs = rfTime(2 + 18);
+            return 18;
+
+        case HMS_PN532_MIFARE_CMD_WRITE_ULTRALIGHT:
+        case HMS_PN532_MIFARE_CMD_WRITE:                                                                                        // Compatibility write: first four bytes land
+            if (len < ((data[0] == HMS_PN532_MIFARE_CMD_WRITE) ? 18 : 6) || page < 3 || page >= pages) break;
+            for (uint8_t i = 0; i < 4; i++) {
+                if (page == 3) memory[12 + i] |= data[2 + i];                                                                   // OTP bits only ever set
+                else           memory[page * 4 + i] = data[2 + i];
+            }
+            busyUs += timing.cardResponseUs;
+            return 2;
+
+        default:
+            break;
+    }
+
+    out[1] = 0x01;                                                                                                              // NAK
+    return 2;
+}
+
+uint16_t HMS_PN532_Interface_Emulator::felicaExchange(const uint8_t *data, uint16_t len, uint8_t *out, uint32_t &busyUs) {
+    uint8_t *memory = card->getMemory();
+    uint16_t blocks = (uint16_t)(card->getMemorySize() / 16);
+
+    out[1] = 0x00;
+    busyUs = rfTime(len) / 2;
+
+    if (len < 10 || data[0] != len || memcmp(&data[2], card->getIdm(), 8) != 0) {                                              // FeliCa frame: LEN CMD IDm ...
+        out[1] = 0x01;
+        return 2;
+    }
+
+    uint16_t pos = 2;
+    out[pos++] = 0;                                                                                                             // LEN, patched below
+    out[pos++] = data[1] + 1;
+    memcpy(&out[pos], card->getIdm(), 8);
+    pos += 8;
+
+    switch (data[1]) {
+        case HMS_PN532_FELICA_CMD_REQUEST_RESPONSE:
+            out[pos++] = 0x00;                                                                                                  // Mode 0
+            break;
+
+        case HMS_PN532_FELICA_CMD_READ_WITHOUT_ENCRYPTION:
+        case HMS_PN532_FELICA_CMD_WRITE_WITHOUT_ENCRYPTION: {
+            bool write = (data[1] == HMS_PN532_FELICA_CMD_WRITE_WITHOUT_ENCRYPTION);
+            uint16_t in = 10;
+            if (in >= len) return EMULATOR_SYNTAX_ERROR;
+            in += 1 + 2 * data[in];                                                                                             // Service list, a single service is modelled
+            if (in >= len) return EMULATOR_SYNTAX_ERROR;
+
+            uint8_t  numBlock = data[in++];
+            uint16_t list[16];
+            if (numBlock > 16) return EMULATOR_SYNTAX_ERROR;
+            for (uint8_t i = 0; i < numBlock; i++) {
+                if (in + 2 > len) return EMULATOR_SYNTAX_ERROR;
+                if (data[in] & 0x80) { list[i] = data[in + 1];                                   in += 2; }                    // Two-byte block list element
+                else {
+                    if (in + 3 > len) return EMULATOR_SYNTAX_ERROR;                                                             // Three-byte element, block number on two bytes
+                    list[i] = (uint16_t)(data[in + 1] | (data[in + 2] << 8));
+                    in += 3;
+                }
+            }
+
+            bool ok = true;
+            for (uint8_t i = 0; i < numBlock; i++) ok = ok && list[i] < blocks;
+            if (write && in + 16 * numBlock > len) ok = false;
+
+            out[pos++] = ok ? 0x00 : 0x01;                                                                                      // Status flags
+            out[pos++] = ok ? 0x00 : 0xA8;                                                                                      // A8: illegal block number
+            if (!ok) break;
+
+            if (write) {
+                for (uint8_t i = 0; i < numBlock; i++) memcpy(&memory[list[i] * 16], &data[in + 16 * i], 16);
+                busyUs += timing.cardResponseUs;
+            } else {
+                out[pos++] = numBlock;
+                for (uint8_t i = 0; i < numBlock; i++) {
+                    memcpy(&out[pos], &memory[list[i] * 16], 16);
+                    pos += 16;
+                }
+                busyUs += rfTime(16 * numBlock) / 2;
+            }
+            break;
+        }
+
+        default:
+            out[1] = 0x01;
+            return 2;
+    }
+
+    out[2] = (uint8_t)(pos - 2);
+    return pos;
+}
@@ -2,12 +2,83 @@
 
 
 #if defined(HMS_PLATFORM_DESKTOP)
-HMS_PN532_Interface_I2C::HMS_PN532_Interface_I2C(const char* device, uint8_t addr) : pn532_device(device) {
-    // Constructor implementation for Desktop platform
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/ioctl.h>
+    #include <linux/i2c.h>
+    #include <linux/i2c-dev.h>
+#endif
+
+HMS_PN532_Interface_I2C::HMS_PN532_Interface_I2C(const char* device, uint8_t addr) : deviceAddress(addr), pn532_device(device) {
+    command = 0;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::busRead(uint8_t *data, uint16_t len) {
+#if defined(__linux__)
+    struct i2c_msg msg;
+    msg.addr  = deviceAddress;
+    msg.flags = I2C_M_RD;
+    msg.len   = len;
+    msg.buf   = data;
+
+    struct i2c_rdwr_ioctl_data xfer = { &msg, 1 };
+    return (ioctl(pn532_fd, I2C_RDWR, &xfer) == 1) ? HMS_PN532_OK : HMS_PN532_ERROR;                                          // ioctl returns the number of messages transferred
+#else
+    return HMS_PN532_ERROR;
+#endif
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::busWrite(const uint8_t *data, uint16_t len) {
+#if defined(__linux__)
+    struct i2c_msg msg;
+    msg.addr  = deviceAddress;
+    msg.flags = 0;
+    msg.len   = len;
+    msg.buf   = const_cast<uint8_t *>(data);
+
+    struct i2c_rdwr_ioctl_data xfer = { &msg, 1 };
+    return (ioctl(pn532_fd, I2C_RDWR, &xfer) == 1) ? HMS_PN532_OK : HMS_PN532_ERROR;
+#else
+    return HMS_PN532_ERROR;
+#endif
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::init() {
+#if defined(__linux__)
+    if (!pn532_device) {
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("I2C device is NULL");
+    #endif
+        return HMS_PN532_ERROR;
+    }
+
+    if (pn532_fd < 0) pn532_fd = open(pn532_device, O_RDWR | O_CLOEXEC);
+    if (pn532_fd < 0) {
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("Unable to open %s", pn532_device);
+    #endif
+        return HMS_PN532_NOT_FOUND;
+    }
+
+    uint8_t status = 0;
+    if (busRead(&status, 1) != HMS_PN532_OK) {                                                                                 // Probe: the PN532 always answers a status read
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("Device not found at address 0x%02X on %s", deviceAddress, pn532_device);
+    #endif
+        close(pn532_fd);
+        pn532_fd = -1;
+        return HMS_PN532_NOT_FOUND;
+    }
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.info("I2C device initialized at address 0x%02X on %s", deviceAddress, pn532_device);
+    #endif
+
     return HMS_PN532_OK;
+#else
+    return HMS_PN532_ERROR;
+#endif
 }
 #elif defined(HMS_PN532_PLATFORM_ZEPHYR)
 HMS_PN532_Interface_I2C::HMS_PN532_Interface_I2C(const struct device *i2c_dev, uint8_t addr) 
@@ -65,31 +136,77 @@ HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::init() {
     return HMS_PN532_OK;
 }
 
-HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::readACKFrame() {
-    static const uint8_t ACK_FRAME[] = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
-    uint8_t ackResp[sizeof(ACK_FRAME)];
-    uint16_t time = 0;
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::busRead(uint8_t *data, uint16_t len) {
+    if (pn532_wire->requestFrom(deviceAddress, (size_t)len) != len) return HMS_PN532_ERROR;
+    for (uint16_t i = 0; i < len; i++) data[i] = pn532_wire->read();
+    return HMS_PN532_OK;
+}
 
-    #if HMS_PN532_DEBUG_ENABLED
-        pn532Logger.debug("Waiting for ACK frame...");
-    #endif
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::busWrite(const uint8_t *data, uint16_t len) {
+    pn532_wire->beginTransmission(deviceAddress);
+    if (pn532_wire->write(data, len) != len) {
+        pn532_wire->endTransmission();
+        return HMS_PN532_ERROR;
+    }
+    return (pn532_wire->endTransmission() == 0) ? HMS_PN532_OK : HMS_PN532_ERROR;
+}
+#endif
+
+#if defined(HMS_PLATFORM_DESKTOP) || (defined(HMS_PN532_PLATFORM_ARDUINO) && (defined(HMS_PN532_ARDUINO_ESP32) || defined(HMS_PN532_ARDUINO_ESP8266)))
+static const uint8_t PN532_ACK_FRAME[]  = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+static const uint8_t PN532_NACK_FRAME[] = {0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00};
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::readFrame(uint8_t *frame, uint16_t frameLen, uint16_t timeoutMs) {
+    uint32_t start   = pn532Millis();                                                                                           // One deadline for the IRQ wait and the status polling
+    bool     ready   = false;
+    uint8_t  status  = 0;
+
+    if (readySignal) {
+        if (!readySignal->wait(timeoutMs)) return HMS_PN532_TIMEOUT;                                                           // Sleep on the IRQ line, the frame's status byte confirms it
+        ready = true;
+    }
 
     while (true) {
-        if (pn532_wire->requestFrom(deviceAddress, sizeof(ACK_FRAME) + 1)) {
-            if (pn532_wire->read() & 1) break;
+        if (!ready) ready = busRead(&status, 1) == HMS_PN532_OK && (status & 1);                                               // Poll with 1-byte status reads, not with the whole frame
+        if (ready) {
+            if (busRead(frame, frameLen) == HMS_PN532_OK && (frame[0] & 1)) return HMS_PN532_OK;                               // Status byte and frame come back in one transfer
+            ready = false;
         }
+        if (timeoutMs != 0 && (pn532Millis() - start) >= timeoutMs) return HMS_PN532_TIMEOUT;
         pn532Delay(1);
-        if (++time > HMS_PN532_ACK_WAIT_TIME) {
-            #if HMS_PN532_DEBUG_ENABLED
-                pn532Logger.warn("ACK wait timeout");
-            #endif
-            return HMS_PN532_TIMEOUT;
-        }
     }
+}
+
+bool HMS_PN532_Interface_I2C::isResponseReady() {
+    uint8_t status = 0;
+
+    if (readySignal) return readySignal->isAsserted();
+    return busRead(&status, 1) == HMS_PN532_OK && (status & 1);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::resume() {
+    uint8_t status = 0;
+
+    busRead(&status, 1);                                                                                                        // Address match wakes it, this transfer may be NACKed
+    pn532Delay(HMS_PN532_WAKEUP_DELAY_MS);
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::readACKFrame() {
+    uint8_t ackResp[sizeof(PN532_ACK_FRAME) + 1];
 
-    for (uint8_t i = 0; i < sizeof(ACK_FRAME); i++) ackResp[i] = pn532_wire->read();
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.debug("Waiting for ACK frame...");
+    #endif
 
-    if (memcmp(ackResp, ACK_FRAME, sizeof(ACK_FRAME)) != 0) {
+    if (readFrame(ackResp, sizeof(ackResp), HMS_PN532_ACK_WAIT_TIME) != HMS_PN532_OK) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.warn("ACK wait timeout");
+        #endif
+        return HMS_PN532_TIMEOUT;
+    }
+
+    if (memcmp(ackResp + 1, PN532_ACK_FRAME, sizeof(PN532_ACK_FRAME)) != 0) {
         #if HMS_PN532_DEBUG_ENABLED
             pn532Logger.error("Invalid ACK frame");
         #endif
@@ -99,174 +216,104 @@ HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::readACKFrame() {
     return HMS_PN532_OK;
 }
 
-HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::getResponseLength(uint8_t &length, uint16_t timeoutMs) {
-    static const uint8_t NACK_FRAME[] = {0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00};
-    uint16_t time = 0;
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::getResponseLength(uint16_t &frameLen, uint16_t timeoutMs) {
+    uint8_t header[9];                                                                                                         // Status + the longer, extended frame header
 
-    while (true) {
-        if (pn532_wire->requestFrom(deviceAddress, sizeof(NACK_FRAME))) {
-            if (pn532_wire->read() & 1) break;
-        }
-        pn532Delay(1);
-        if (++time > timeoutMs && timeoutMs != 0) {
-            #if HMS_PN532_DEBUG_ENABLED
-                pn532Logger.warn("Timeout getting response length");
-            #endif
-            return HMS_PN532_TIMEOUT;
-        }
+    if (readFrame(header, sizeof(header), timeoutMs) != HMS_PN532_OK) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.warn("Timeout getting response length");
+        #endif
+        return HMS_PN532_TIMEOUT;
     }
 
-    if (pn532_wire->read() != HMS_PN532_PREAMBLE ||
-        pn532_wire->read() != HMS_PN532_STARTCODE1 ||
-        pn532_wire->read() != HMS_PN532_STARTCODE2) {
+    frameLen = frameLength(header + 1);
+    if (frameLen == 0) {
         #if HMS_PN532_DEBUG_ENABLED
             pn532Logger.error("Invalid frame header");
         #endif
         return HMS_PN532_INVALID_FRAME;
     }
 
-    length = pn532_wire->read();
-
-    pn532_wire->beginTransmission(deviceAddress);                                                                               // Send request for last respond msg again
-    for (uint8_t i = 0; i < sizeof(NACK_FRAME); ++i)
-        pn532_wire->write(NACK_FRAME[i]);
-    pn532_wire->endTransmission();
-
-    return HMS_PN532_OK;
+    return busWrite(PN532_NACK_FRAME, sizeof(PN532_NACK_FRAME));                                                               // Send request for last respond msg again
 }
 
-HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::read(uint8_t *buffer, uint8_t len, uint16_t timeoutMs) {
-    uint8_t resLen = 0;
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::read(uint8_t *buffer, uint16_t len, uint16_t timeoutMs) {
+    uint16_t resLen = 0;
     return read(buffer, len, resLen, timeoutMs);
 }
 
-HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::read(uint8_t *buffer, uint8_t len, uint8_t &resLen, uint16_t timeoutMs) {
-    uint16_t time = 0;
-    uint8_t length = 0;
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::read(uint8_t *buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs) {
+    uint8_t frame[1 + HMS_PN532_FRAME_MAX_LEN];                                                                                // Status byte + largest frame
+    uint16_t frameLen = 0;
+    HMS_PN532_StatusTypeDef status;
 
-    HMS_PN532_StatusTypeDef status = getResponseLength(length, timeoutMs);
+#if HMS_PN532_I2C_SPECULATIVE_READ
+    uint16_t readLen = 1 + responseFrameLength(len);                                                                           // Status byte + the largest frame that can answer into buffer
+    status = readFrame(frame, readLen, timeoutMs);                                                                             // Wait on the status byte, then one read parsed in place
     if (status != HMS_PN532_OK) {
         #if HMS_PN532_DEBUG_ENABLED
-            pn532Logger.error("Failed to get response length status code: %d", status);
+            pn532Logger.warn("Timeout waiting for response");
         #endif
         return status;
     }
 
-    do {                                                                                                                        // Wait for PN532 ready
-        if (pn532_wire->requestFrom(deviceAddress, (size_t)(6 + length + 2))) {
-            if (pn532_wire->read() & 1)
-                break;
-        }
-        pn532Delay(1);
-        if (++time > timeoutMs && timeoutMs != 0)
-            return HMS_PN532_TIMEOUT;
-    } while (true);
-
-
-    if (pn532_wire->read() != HMS_PN532_PREAMBLE   ||                                                                          // Validate frame header
-        pn532_wire->read() != HMS_PN532_STARTCODE1 ||
-        pn532_wire->read() != HMS_PN532_STARTCODE2
-    )   return HMS_PN532_INVALID_FRAME;
-
-    length = pn532_wire->read();
+    frameLen = frameLength(frame + 1);
+    if (frameLen == 0) return HMS_PN532_INVALID_FRAME;
+    if (1 + frameLen > readLen) return HMS_PN532_NO_SPACE;                                                                     // Payload longer than buffer, a resend cannot help
 
-    if ((uint8_t)(length + pn532_wire->read()) != 0) return HMS_PN532_INVALID_FRAME;
-
-    uint8_t tfi = pn532_wire->read();
-    uint8_t cmd = pn532_wire->read();
+    return parseFrame(frame + 1, command, buffer, len, resLen);
+#else
+    status = getResponseLength(frameLen, timeoutMs);
+    if (status != HMS_PN532_OK) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("Failed to get response length status code: %d", status);
+        #endif
+        return status;
+    }
 
-    if (tfi != HMS_PN532_PN532TOHOST || cmd != (uint8_t)(command + 1)) return HMS_PN532_INVALID_FRAME;
+    if (frameLen > HMS_PN532_FRAME_MAX_LEN) return HMS_PN532_NO_SPACE;                                                         // Extended frame with HMS_PN532_EXTENDED_FRAMES off
 
-    length -= 2;
-    if (length > len) return HMS_PN532_NO_SPACE;
+    status = readFrame(frame, 1 + frameLen, timeoutMs);
+    if (status != HMS_PN532_OK) return status;
 
-    #if HMS_PN532_DEBUG_ENABLED
-        pn532Logger.debug("Frame CMD: %02X, DataLen: %u", cmd, length);
-    #endif
+    return parseFrame(frame + 1, command, buffer, len, resLen);
+#endif
+}
 
-    uint8_t sum = tfi + cmd;                                                                                                   // Read payload
-    #if HMS_PN532_DEBUG_ENABLED
-        char line[128];
-        size_t pos = 0;
-    #endif
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::write(const HMS_PN532_SegmentTypeDef *segments, uint8_t count) {
+    uint8_t frame[HMS_PN532_FRAME_MAX_LEN];
+    uint16_t frameLen = encodeFrame(frame, segments, count);                                                                  // Frame and checksum built in one pass
 
-    for (uint8_t i = 0; i < length; i++) {
-        buffer[i] = pn532_wire->read();
-        sum += buffer[i];
+    if (frameLen == 0) {
         #if HMS_PN532_DEBUG_ENABLED
-            if (pos < sizeof(line) - 4) pos += snprintf(line + pos, sizeof(line) - pos, "%02X ", buffer[i]);
+            pn532Logger.error("Frame too long for an information frame");
         #endif
+        return HMS_PN532_INVALID_FRAME;
     }
 
+    command = frame[frameHeaderLength(frame) + 1];
+
     #if HMS_PN532_DEBUG_ENABLED
-        pn532Logger.debug("Payload (%u bytes): %s", length, length > 0? line : "(empty)");
+        pn532Logger.debug("Frame CMD: %02X, FrameLen: %u", command, frameLen);
     #endif
 
-    uint8_t checksum = pn532_wire->read();
-    if ((uint8_t)(sum + checksum) != 0) {
+    if (busWrite(frame, frameLen) != HMS_PN532_OK) {                                                                           // Whole frame in a single bus transfer
         #if HMS_PN532_DEBUG_ENABLED
-            pn532Logger.error("Checksum mismatch (sum=0x%02X, chk=0x%02X)", sum, checksum);
+            pn532Logger.error("I2C write failed (%u bytes)", frameLen);
         #endif
-        return HMS_PN532_INVALID_FRAME;
+        return HMS_PN532_ERROR;
     }
 
-    pn532_wire->read();                                                                                                        // POSTAMBLE discard
-    resLen = length;
-    return HMS_PN532_OK;
-}
-
-HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::write(const uint8_t *header, uint8_t headerLen, const uint8_t *body, uint8_t bodyLen) {
-    command = header[0];
-    pn532_wire->beginTransmission(deviceAddress);
-
-    pn532_wire->write(HMS_PN532_PREAMBLE);
-    pn532_wire->write(HMS_PN532_STARTCODE1);
-    pn532_wire->write(HMS_PN532_STARTCODE2);
-
-    uint8_t length = headerLen + bodyLen + 1;
-    pn532_wire->write(length);
-    pn532_wire->write((uint8_t)(~length + 1));
-
-    pn532_wire->write(HMS_PN532_HOSTTOPN532);
-    uint8_t sum = HMS_PN532_HOSTTOPN532;
-
-    auto writeBytes = [&](const uint8_t *data, uint8_t len, const char *label) -> bool {
-        #if HMS_PN532_DEBUG_ENABLED
-            char line[128];
-            size_t pos = 0;
-        #endif
-        for (uint8_t i = 0; i < len; i++) {
-            if (!pn532_wire->write(data[i])) {
-                #if HMS_PN532_DEBUG_ENABLED
-                    pn532Logger.error("Write overflow in %s", label);
-                #endif
-                return false;
-            }
-            sum += data[i];
-            #if HMS_PN532_DEBUG_ENABLED
-                if (pos < sizeof(line) - 4) pos += snprintf(line + pos, sizeof(line) - pos, "%02X ", data[i]);
-            #endif
-        }
-        #if HMS_PN532_DEBUG_ENABLED
-            pn532Logger.debug("%s (%u bytes): %s", label, len, pos ? line : "(empty)");
-        #endif
-        return true;
-    };
-
-    if (!writeBytes(header, headerLen, "Header"))
-        return HMS_PN532_INVALID_FRAME;
-    if (!writeBytes(body, bodyLen, "Body"))
-        return HMS_PN532_INVALID_FRAME;
-
-    uint8_t checksum = (uint8_t)(~sum + 1);
-    pn532_wire->write(checksum);
-    pn532_wire->write(HMS_PN532_POSTAMBLE);
-    pn532_wire->endTransmission();
-
     return readACKFrame();
 }
 #endif
 
+HMS_PN532_Interface_I2C::~HMS_PN532_Interface_I2C() {
+    #if defined(HMS_PLATFORM_DESKTOP) && defined(__linux__)
+        if (pn532_fd >= 0) close(pn532_fd);
+    #endif
+}
+
 HMS_PN532_StatusTypeDef HMS_PN532_Interface_I2C::wakeup() {
     pn532Delay(500);
     return HMS_PN532_OK;
@@ -0,0 +1,270 @@
+#include "HMS_PN532_Interface_SPI.h"
+
+
+#if defined(HMS_PLATFORM_DESKTOP)
+#if defined(__linux__)
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <sys/ioctl.h>
+    #include <linux/spi/spidev.h>
+#endif
+
+HMS_PN532_Interface_SPI::HMS_PN532_Interface_SPI(const char* device, uint32_t speed) : clockSpeed(speed), pn532_device(device) {}
+
+HMS_PN532_Interface_SPI::~HMS_PN532_Interface_SPI() {
+    #if defined(__linux__)
+        if (pn532_fd >= 0) close(pn532_fd);
+    #endif
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_SPI::init() {
+#if defined(__linux__)
+    if (!pn532_device) {
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("SPI device is NULL");
+    #endif
+        return HMS_PN532_ERROR;
+    }
+
+    if (pn532_fd < 0) pn532_fd = open(pn532_device, O_RDWR | O_CLOEXEC);
+    if (pn532_fd < 0) {
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("Unable to open %s", pn532_device);
+    #endif
+        return HMS_PN532_NOT_FOUND;
+    }
+
+    uint8_t mode = SPI_MODE_0 | SPI_LSB_FIRST;
+    uint8_t bits = 8;
+    reverseBits  = false;
+
+    if (ioctl(pn532_fd, SPI_IOC_WR_MODE, &mode) < 0) {                                                                         // Many SPI controllers are MSB-first only
+        mode = SPI_MODE_0;
+        reverseBits = true;
+        if (ioctl(pn532_fd, SPI_IOC_WR_MODE, &mode) < 0) return HMS_PN532_ERROR;
+    }
+
+    if (ioctl(pn532_fd, SPI_IOC_WR_BITS_PER_WORD, &bits) < 0 ||
+        ioctl(pn532_fd, SPI_IOC_WR_MAX_SPEED_HZ, &clockSpeed) < 0) {
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("Unable to configure %s", pn532_device);
+    #endif
+        return HMS_PN532_ERROR;
+    }
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.info("SPI device initialized on %s (%u Hz%s)", pn532_device, clockSpeed, reverseBits ? ", software LSB-first" : "");
+    #endif
+
+    return HMS_PN532_OK;
+#else
+    return HMS_PN532_ERROR;
+#endif
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_SPI::transfer(const uint8_t *tx, uint8_t *rx, uint16_t len) {
+#if defined(__linux__)
+    uint8_t flipped[1 + HMS_PN532_FRAME_MAX_LEN];
+    const uint8_t *out = tx;
+
+    if (reverseBits) {
+        if (len > sizeof(flipped)) return HMS_PN532_ERROR;
+        for (uint16_t i = 0; i < len; i++) {
+            uint8_t b = tx[i];
+            HMS_REVERSE_BITS_ORDER(b);
+            flipped[i] = b;
+        }
+        out = flipped;
+    }
+
+    struct spi_ioc_transfer xfer;
+    memset(&xfer, 0, sizeof(xfer));
+    xfer.tx_buf         = (unsigned long)out;
+    xfer.rx_buf         = (unsigned long)rx;
+    xfer.len            = len;
+    xfer.speed_hz       = clockSpeed;
+    xfer.bits_per_word  = 8;
+
+    if (ioctl(pn532_fd, SPI_IOC_MESSAGE(1), &xfer) != len) return HMS_PN532_ERROR;
+
+    if (reverseBits && rx) {
+        for (uint16_t i = 0; i < len; i++) {
+            HMS_REVERSE_BITS_ORDER(rx[i]);
+        }
+    }
+    return HMS_PN532_OK;
+#else
+    return HMS_PN532_ERROR;
+#endif
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_SPI::wakeup() {
+    uint8_t status[2];
+    static const uint8_t STATUS_READ[2] = { HMS_PN532_SPI_STATREAD, 0x00 };
+    transfer(STATUS_READ, status, sizeof(STATUS_READ));                                                                          // Any CS assertion wakes the PN532
+    pn532Delay(2);
+    return HMS_PN532_OK;
+}
+#elif defined(HMS_PN532_PLATFORM_ARDUINO) && (defined(HMS_PN532_ARDUINO_ESP32) || defined(HMS_PN532_ARDUINO_ESP8266))
+HMS_PN532_Interface_SPI::HMS_PN532_Interface_SPI(SPIClass *theSPI, uint8_t ss) : ssPin(ss), pn532_spi(theSPI) {}
+
+HMS_PN532_Interface_SPI::~HMS_PN532_Interface_SPI() {}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_SPI::init() {
+    if (!pn532_spi) {
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("SPI device is NULL");
+    #endif
+        return HMS_PN532_ERROR;
+    }
+
+    pinMode(ssPin, OUTPUT);
+    digitalWrite(ssPin, HIGH);
+
+    #if defined(HMS_PN532_ARDUINO_ESP32)
+        pn532_spi->begin(HMS_PN532_SPI_SCK_PIN, HMS_PN532_SPI_MISO_PIN, HMS_PN532_SPI_MOSI_PIN, -1);
+    #else
+        pn532_spi->begin();
+    #endif
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.info("SPI device initialized, SS pin %d", ssPin);
+    #endif
+
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_SPI::transfer(const uint8_t *tx, uint8_t *rx, uint16_t len) {
+    pn532_spi->beginTransaction(SPISettings(HMS_PN532_SPI_CLOCK_SPEED, LSBFIRST, SPI_MODE0));
+    digitalWrite(ssPin, LOW);
+
+    if (rx) pn532_spi->transferBytes(tx, rx, len);
+    else    pn532_spi->writeBytes(tx, len);
+
+    digitalWrite(ssPin, HIGH);
+    pn532_spi->endTransaction();
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_SPI::wakeup() {
+    digitalWrite(ssPin, LOW);
+    pn532Delay(2);
+    digitalWrite(ssPin, HIGH);
+    return HMS_PN532_OK;
+}
+#endif
+
+#if defined(HMS_PLATFORM_DESKTOP) || (defined(HMS_PN532_PLATFORM_ARDUINO) && (defined(HMS_PN532_ARDUINO_ESP32) || defined(HMS_PN532_ARDUINO_ESP8266)))
+static const uint8_t PN532_ACK_FRAME[]  = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+static const uint8_t PN532_NACK_FRAME[] = {0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00};
+static const uint8_t STATUS_READ[2]     = {HMS_PN532_SPI_STATREAD, 0x00};
+
+bool HMS_PN532_Interface_SPI::isResponseReady() {
+    uint8_t status[2];
+
+    if (readySignal) return readySignal->isAsserted();
+    return transfer(STATUS_READ, status, sizeof(status)) == HMS_PN532_OK && status[1] == HMS_PN532_SPI_READY;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_SPI::waitReady(uint16_t timeoutMs) {
+    uint8_t status[2];
+    uint32_t start = pn532Millis();                                                                                             // One deadline for the IRQ wait and the status polling
+
+    if (readySignal && !readySignal->wait(timeoutMs)) return HMS_PN532_TIMEOUT;
+
+    while (true) {
+        if (transfer(STATUS_READ, status, sizeof(status)) == HMS_PN532_OK && status[1] == HMS_PN532_SPI_READY) return HMS_PN532_OK;
+        if (timeoutMs != 0 && (pn532Millis() - start) >= timeoutMs) return HMS_PN532_TIMEOUT;
+        pn532Delay(1);
+    }
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_SPI::readACKFrame() {
+    uint8_t tx[sizeof(PN532_ACK_FRAME) + 1] = { HMS_PN532_SPI_DATAREAD };
+    uint8_t rx[sizeof(PN532_ACK_FRAME) + 1];
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.debug("Waiting for ACK frame...");
+    #endif
+
+    if (waitReady(HMS_PN532_ACK_WAIT_TIME) != HMS_PN532_OK) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.warn("ACK wait timeout");
+        #endif
+        return HMS_PN532_TIMEOUT;
+    }
+
+    if (transfer(tx, rx, sizeof(tx)) != HMS_PN532_OK) return HMS_PN532_ERROR;
+
+    if (memcmp(rx + 1, PN532_ACK_FRAME, sizeof(PN532_ACK_FRAME)) != 0) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("Invalid ACK frame");
+        #endif
+        return HMS_PN532_INVALID_ACK;
+    }
+
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_SPI::read(uint8_t *buffer, uint16_t len, uint16_t timeoutMs) {
+    uint16_t resLen = 0;
+    return read(buffer, len, resLen, timeoutMs);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_SPI::read(uint8_t *buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs) {
+    uint8_t tx[1 + HMS_PN532_FRAME_MAX_LEN] = { HMS_PN532_SPI_DATAREAD };                                                      // DR byte, then dummy bytes clocking the frame out
+    uint8_t rx[1 + HMS_PN532_FRAME_MAX_LEN];
+
+    HMS_PN532_StatusTypeDef status = waitReady(timeoutMs);
+    if (status != HMS_PN532_OK) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.warn("Timeout waiting for response");
+        #endif
+        return status;
+    }
+
+    if (transfer(tx, rx, HMS_PN532_SPI_SPECULATIVE_READ_LEN) != HMS_PN532_OK) return HMS_PN532_ERROR;                        // One max-length read, parsed in place
+
+    uint16_t frameLen = frameLength(rx + 1);
+    if (frameLen == 0) return HMS_PN532_INVALID_FRAME;
+    if (1 + frameLen <= HMS_PN532_SPI_SPECULATIVE_READ_LEN) return parseFrame(rx + 1, command, buffer, len, resLen);
+    if (frameLen > HMS_PN532_FRAME_MAX_LEN) return HMS_PN532_NO_SPACE;                                                         // Extended frame with HMS_PN532_EXTENDED_FRAMES off
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.debug("Oversize frame (%u bytes), requesting resend", frameLen);
+    #endif
+
+    uint8_t nack[1 + sizeof(PN532_NACK_FRAME)] = { HMS_PN532_SPI_DATAWRITE };                                                  // Frame did not fit: have the PN532 resend it whole
+    memcpy(nack + 1, PN532_NACK_FRAME, sizeof(PN532_NACK_FRAME));
+    if (transfer(nack, NULL, sizeof(nack)) != HMS_PN532_OK) return HMS_PN532_ERROR;
+
+    status = waitReady(timeoutMs);
+    if (status != HMS_PN532_OK) return status;
+
+    if (transfer(tx, rx, 1 + frameLen) != HMS_PN532_OK) return HMS_PN532_ERROR;
+    return parseFrame(rx + 1, command, buffer, len, resLen);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_SPI::write(const HMS_PN532_SegmentTypeDef *segments, uint8_t count) {
+    uint8_t frame[1 + HMS_PN532_FRAME_MAX_LEN] = { HMS_PN532_SPI_DATAWRITE };
+    uint16_t frameLen = encodeFrame(frame + 1, segments, count);
+
+    if (frameLen == 0) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("Frame too long for an information frame");
+        #endif
+        return HMS_PN532_INVALID_FRAME;
+    }
+
+    command = frame[1 + frameHeaderLength(frame + 1) + 1];
+
+    if (transfer(frame, NULL, frameLen + 1) != HMS_PN532_OK) {                                                                  // DW byte + whole frame in one transfer
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("SPI write failed (%u bytes)", frameLen + 1);
+        #endif
+        return HMS_PN532_ERROR;
+    }
+
+    return readACKFrame();
+}
+#endif
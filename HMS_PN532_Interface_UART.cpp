@@ -0,0 +1,344 @@
+#include "HMS_PN532_Interface_UART.h"
+
+
+#if defined(HMS_PLATFORM_DESKTOP)
+#if defined(__linux__)
+    #include <poll.h>
+    #include <fcntl.h>
+    #include <unistd.h>
+    #include <asm/ioctls.h>
+    #include <asm/termbits.h>                                                                                                   // termios2: arbitrary rates such as 1288000 via BOTHER
+    extern "C" int ioctl(int fd, unsigned long request, ...);
+#endif
+
+HMS_PN532_Interface_UART::HMS_PN532_Interface_UART(const char* device, uint32_t baudrate) 
+    : initialBaudrate(baudrate), currentBaudrate(baudrate), pn532_device(device) {}
+
+HMS_PN532_Interface_UART::~HMS_PN532_Interface_UART() {
+    #if defined(__linux__)
+        if (pn532_fd >= 0) close(pn532_fd);
+    #endif
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::init() {
+#if defined(__linux__)
+    if (!pn532_device) {
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("UART device is NULL");
+    #endif
+        return HMS_PN532_ERROR;
+    }
+
+    if (pn532_fd < 0) pn532_fd = open(pn532_device, O_RDWR | O_NOCTTY | O_CLOEXEC);
+    if (pn532_fd < 0) {
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("Unable to open %s", pn532_device);
+    #endif
+        return HMS_PN532_NOT_FOUND;
+    }
+
+    currentBaudrate = initialBaudrate;
+    if (portSetBaud(currentBaudrate) != HMS_PN532_OK) {
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("Unable to configure %s", pn532_device);
+    #endif
+        return HMS_PN532_ERROR;
+    }
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.info("UART device initialized on %s at %u baud", pn532_device, currentBaudrate);
+    #endif
+
+    return HMS_PN532_OK;
+#else
+    return HMS_PN532_ERROR;
+#endif
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::portSetBaud(uint32_t baudrate) {
+#if defined(__linux__)
+    struct termios2 tio;
+    if (ioctl(pn532_fd, TCGETS2, &tio) < 0) return HMS_PN532_ERROR;
+
+    tio.c_iflag         = 0;                                                                                                    // Raw 8N1, no flow control
+    tio.c_oflag         = 0;
+    tio.c_lflag         = 0;
+    tio.c_cflag         = BOTHER | CS8 | CREAD | CLOCAL;
+    tio.c_ispeed        = baudrate;
+    tio.c_ospeed        = baudrate;
+    tio.c_cc[VMIN]      = 0;
+    tio.c_cc[VTIME]     = 0;
+
+    if (ioctl(pn532_fd, TCSETS2, &tio) < 0) return HMS_PN532_ERROR;
+    return HMS_PN532_OK;
+#else
+    return HMS_PN532_ERROR;
+#endif
+}
+
+bool HMS_PN532_Interface_UART::portAvailable() {
+#if defined(__linux__)
+    struct pollfd pfd = { pn532_fd, POLLIN, 0 };
+    return poll(&pfd, 1, 0) > 0;
+#else
+    return false;
+#endif
+}
+
+void HMS_PN532_Interface_UART::portFlush() {
+#if defined(__linux__)
+    ioctl(pn532_fd, TCFLSH, TCIFLUSH);
+#endif
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::portWrite(const uint8_t *data, uint16_t len) {
+#if defined(__linux__)
+    while (len > 0) {
+        ssize_t n = ::write(pn532_fd, data, len);
+        if (n <= 0) return HMS_PN532_ERROR;
+        data += n;
+        len  -= n;
+    }
+    ioctl(pn532_fd, TCSBRK, 1);                                                                                                 // tcdrain(): the frame has left the port
+    return HMS_PN532_OK;
+#else
+    return HMS_PN532_ERROR;
+#endif
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::portRead(uint8_t *data, uint16_t len, uint16_t timeoutMs) {
+#if defined(__linux__)
+    auto deadline = std::chrono::steady_clock::now() + std::chrono::milliseconds(timeoutMs);
+
+    while (len > 0) {
+        int waitMs = -1;
+        if (timeoutMs != 0) {
+            auto left = std::chrono::duration_cast<std::chrono::milliseconds>(deadline - std::chrono::steady_clock::now()).count();
+            if (left <= 0) return HMS_PN532_TIMEOUT;
+            waitMs = (int)left;
+        }
+
+        struct pollfd pfd = { pn532_fd, POLLIN, 0 };
+        if (poll(&pfd, 1, waitMs) <= 0) return HMS_PN532_TIMEOUT;
+
+        ssize_t n = ::read(pn532_fd, data, len);                                                                                // Take as much of the frame as the driver has queued
+        if (n < 0) return HMS_PN532_ERROR;
+        data += n;
+        len  -= n;
+    }
+    return HMS_PN532_OK;
+#else
+    return HMS_PN532_ERROR;
+#endif
+}
+#elif defined(HMS_PN532_PLATFORM_ARDUINO) && (defined(HMS_PN532_ARDUINO_ESP32) || defined(HMS_PN532_ARDUINO_ESP8266))
+HMS_PN532_Interface_UART::HMS_PN532_Interface_UART(HardwareSerial *theSerial, uint32_t baudrate)
+    : initialBaudrate(baudrate), currentBaudrate(baudrate), pn532_serial(theSerial) {}
+
+HMS_PN532_Interface_UART::~HMS_PN532_Interface_UART() {}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::init() {
+    if (!pn532_serial) {
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.error("UART device is NULL");
+    #endif
+        return HMS_PN532_ERROR;
+    }
+
+    currentBaudrate = initialBaudrate;
+    #if defined(HMS_PN532_ARDUINO_ESP32)
+        pn532_serial->begin(currentBaudrate, SERIAL_8N1, HMS_PN532_UART_RX_PIN, HMS_PN532_UART_TX_PIN);
+    #else
+        pn532_serial->begin(currentBaudrate);
+    #endif
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.info("UART device initialized at %u baud", currentBaudrate);
+    #endif
+
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::portSetBaud(uint32_t baudrate) {
+    pn532_serial->flush();
+    #if defined(HMS_PN532_ARDUINO_ESP32)
+        pn532_serial->updateBaudRate(baudrate);
+    #else
+        pn532_serial->end();
+        pn532_serial->begin(baudrate);
+    #endif
+    return HMS_PN532_OK;
+}
+
+bool HMS_PN532_Interface_UART::portAvailable() {
+    return pn532_serial->available() > 0;
+}
+
+void HMS_PN532_Interface_UART::portFlush() {
+    while (pn532_serial->available()) pn532_serial->read();
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::portWrite(const uint8_t *data, uint16_t len) {
+    if (pn532_serial->write(data, len) != len) return HMS_PN532_ERROR;
+    pn532_serial->flush();
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::portRead(uint8_t *data, uint16_t len, uint16_t timeoutMs) {
+    unsigned long start = millis();
+    uint16_t got = 0;
+
+    while (got < len) {
+        int avail = pn532_serial->available();
+        if (avail > 0) {
+            got += pn532_serial->readBytes(data + got, (size_t)avail < (size_t)(len - got) ? (size_t)avail : (size_t)(len - got));
+            continue;
+        }
+        if (timeoutMs && (millis() - start) >= timeoutMs) return HMS_PN532_TIMEOUT;
+        yield();
+    }
+    return HMS_PN532_OK;
+}
+#endif
+
+#if defined(HMS_PLATFORM_DESKTOP) || (defined(HMS_PN532_PLATFORM_ARDUINO) && (defined(HMS_PN532_ARDUINO_ESP32) || defined(HMS_PN532_ARDUINO_ESP8266)))
+static const uint8_t PN532_ACK_FRAME[] = {0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00};
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::wakeup() {
+    static const uint8_t WAKEUP[] = {
+        HMS_PN532_HSU_WAKEUP_PREAMBLE, HMS_PN532_HSU_WAKEUP_PREAMBLE,
+        0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00
+    };
+
+    if (portWrite(WAKEUP, sizeof(WAKEUP)) != HMS_PN532_OK) return HMS_PN532_ERROR;
+    pn532Delay(2);
+    portFlush();
+
+    if (HMS_PN532_UART_HIGH_BAUDRATE != currentBaudrate) {
+        if (setBaudRate(HMS_PN532_UART_HIGH_BAUDRATE) != HMS_PN532_OK) {                                                       // Not fatal, keep talking at the current rate
+            #if HMS_PN532_DEBUG_ENABLED
+                pn532Logger.warn("Baudrate escalation to %u failed, staying at %u", (unsigned)HMS_PN532_UART_HIGH_BAUDRATE, currentBaudrate);
+            #endif
+        }
+    }
+
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::setBaudRate(uint32_t baudrate) {
+    static const uint32_t BAUDRATES[] = { 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1288000 };
+
+    uint8_t code = 0;
+    while (code < sizeof(BAUDRATES) / sizeof(BAUDRATES[0]) && BAUDRATES[code] != baudrate) code++;
+    if (code == sizeof(BAUDRATES) / sizeof(BAUDRATES[0])) return HMS_PN532_INVALID_COMMAND;
+
+    uint8_t request[2] = { HMS_PN532_COMMAND_SETSERIALBAUDRATE, code };
+    uint8_t response[1];
+
+    if (write(request, sizeof(request)) != HMS_PN532_OK) return HMS_PN532_ERROR;
+    if (read(response, sizeof(response)) != HMS_PN532_OK) return HMS_PN532_ERROR;
+
+    if (portWrite(PN532_ACK_FRAME, sizeof(PN532_ACK_FRAME)) != HMS_PN532_OK) return HMS_PN532_ERROR;                           // The PN532 switches once it sees our ACK
+    pn532Delay(1);
+
+    if (portSetBaud(baudrate) != HMS_PN532_OK) return HMS_PN532_ERROR;
+    currentBaudrate = baudrate;
+    portFlush();
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.info("UART baudrate set to %u", currentBaudrate);
+    #endif
+
+    return HMS_PN532_OK;
+}
+
+bool HMS_PN532_Interface_UART::isResponseReady() {
+    if (readySignal) return readySignal->isAsserted();
+    return portAvailable();
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::readACKFrame() {
+    uint8_t ackResp[sizeof(PN532_ACK_FRAME)];
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.debug("Waiting for ACK frame...");
+    #endif
+
+    if (portRead(ackResp, sizeof(ackResp), HMS_PN532_ACK_WAIT_TIME) != HMS_PN532_OK) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.warn("ACK wait timeout");
+        #endif
+        return HMS_PN532_TIMEOUT;
+    }
+
+    if (memcmp(ackResp, PN532_ACK_FRAME, sizeof(PN532_ACK_FRAME)) != 0) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("Invalid ACK frame");
+        #endif
+        return HMS_PN532_INVALID_ACK;
+    }
+
+    return HMS_PN532_OK;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::read(uint8_t *buffer, uint16_t len, uint16_t timeoutMs) {
+    uint16_t resLen = 0;
+    return read(buffer, len, resLen, timeoutMs);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::read(uint8_t *buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs) {
+    uint8_t frame[HMS_PN532_FRAME_MAX_LEN];
+
+    HMS_PN532_StatusTypeDef status = portRead(frame, 5, timeoutMs);                                                            // Preamble, start code, LEN, LCS
+    if (status != HMS_PN532_OK) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.warn("Timeout waiting for response");
+        #endif
+        return status;
+    }
+
+    if (frame[0] != HMS_PN532_PREAMBLE   ||
+        frame[1] != HMS_PN532_STARTCODE1 ||
+        frame[2] != HMS_PN532_STARTCODE2
+    )   return HMS_PN532_INVALID_FRAME;
+
+    uint8_t headerLen = frameHeaderLength(frame);
+    if (headerLen > 5) {
+        status = portRead(frame + 5, headerLen - 5, timeoutMs);                                                                 // LENm, LENl, LCS of an extended frame
+        if (status != HMS_PN532_OK) return status;
+    }
+
+    uint16_t frameLen = frameLength(frame);
+    if (frameLen == 0) return HMS_PN532_INVALID_FRAME;
+    if (frameLen > sizeof(frame)) return HMS_PN532_NO_SPACE;                                                                    // Extended frame with HMS_PN532_EXTENDED_FRAMES off
+
+    status = portRead(frame + headerLen, frameLen - headerLen, timeoutMs);                                                      // TFI..data, DCS, postamble
+    if (status != HMS_PN532_OK) return status;
+
+    return parseFrame(frame, command, buffer, len, resLen);
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_Interface_UART::write(const HMS_PN532_SegmentTypeDef *segments, uint8_t count) {
+    uint8_t frame[HMS_PN532_FRAME_MAX_LEN];
+    uint16_t frameLen = encodeFrame(frame, segments, count);
+
+    if (frameLen == 0) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("Frame too long for an information frame");
+        #endif
+        return HMS_PN532_INVALID_FRAME;
+    }
+
+    command = frame[frameHeaderLength(frame) + 1];
+    portFlush();                                                                                                                // Drop stale bytes from an aborted exchange
+
+    if (portWrite(frame, frameLen) != HMS_PN532_OK) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("UART write failed (%u bytes)", frameLen);
+        #endif
+        return HMS_PN532_ERROR;
+    }
+
+    return readACKFrame();
+}
+#endif
@@ -0,0 +1,110 @@
+#include "HMS_PN532_Metrics.h"
+
+#if HMS_PN532_METRICS_ENABLED
+
+#define HMS_PN532_METRIC_ADD(field, n)  __atomic_fetch_add(&(field), (n), __ATOMIC_RELAXED)
+#define HMS_PN532_METRIC_LOAD(field)    __atomic_load_n(&(field), __ATOMIC_RELAXED)
+
+uint8_t HMS_PN532_Metrics::bucketOf(uint32_t us) {
+    uint8_t bucket = 0;
+    while (us > 1 && bucket < HMS_PN532_METRICS_BUCKETS - 1) {
+        us >>= 1;
+        bucket++;
+    }
+    return bucket;
+}
+
+HMS_PN532_CommandMetricsTypeDef *HMS_PN532_Metrics::entryFor(uint8_t command) {
+    uint16_t key = (uint16_t)command + 1;
+
+    for (uint8_t i = 0; i < HMS_PN532_METRICS_COMMANDS; i++) {
+        uint16_t current = HMS_PN532_METRIC_LOAD(entries[i].key);
+        if (current == key) return &entries[i];
+        if (current != 0) continue;
+
+        uint16_t expected = 0;                                                                                                 // Claim the free slot, or lose to a racer and re-check it
+        if (__atomic_compare_exchange_n(&entries[i].key, &expected, key, false, __ATOMIC_RELAXED, __ATOMIC_RELAXED) ||
+            expected == key) {
+            return &entries[i];
+        }
+    }
+    return nullptr;                                                                                                             // Table full, this command goes unrecorded
+}
+
+void HMS_PN532_Metrics::recordWrite(uint8_t command, uint16_t bytesOut, HMS_PN532_StatusTypeDef status, uint32_t ackWaitUs) {
+    HMS_PN532_CommandMetricsTypeDef *entry = entryFor(command);
+    if (!entry) return;
+
+    HMS_PN532_METRIC_ADD(entry->count, 1);
+    HMS_PN532_METRIC_ADD(entry->bytesOut, bytesOut);
+    HMS_PN532_METRIC_ADD(entry->latency[HMS_PN532_PHASE_ACK_WAIT][bucketOf(ackWaitUs)], 1);
+
+    if (status == HMS_PN532_TIMEOUT)            HMS_PN532_METRIC_ADD(entry->ackTimeouts, 1);
+    else if (status == HMS_PN532_INVALID_ACK)   HMS_PN532_METRIC_ADD(entry->invalidFrames, 1);
+    else if (status != HMS_PN532_OK)            HMS_PN532_METRIC_ADD(entry->errors, 1);
+}
+
+void HMS_PN532_Metrics::recordRead(uint8_t command, uint16_t bytesIn, HMS_PN532_StatusTypeDef status, uint32_t readyWaitUs, uint32_t transferUs) {
+    HMS_PN532_CommandMetricsTypeDef *entry = entryFor(command);
+    if (!entry) return;
+
+    HMS_PN532_METRIC_ADD(entry->bytesIn, bytesIn);
+    HMS_PN532_METRIC_ADD(entry->latency[HMS_PN532_PHASE_READY_WAIT][bucketOf(readyWaitUs)], 1);
+    HMS_PN532_METRIC_ADD(entry->latency[HMS_PN532_PHASE_TRANSFER][bucketOf(transferUs)], 1);
+
+    if (status == HMS_PN532_TIMEOUT)            HMS_PN532_METRIC_ADD(entry->responseTimeouts, 1);
+    else if (status == HMS_PN532_INVALID_FRAME) HMS_PN532_METRIC_ADD(entry->invalidFrames, 1);
+    else if (status != HMS_PN532_OK)            HMS_PN532_METRIC_ADD(entry->errors, 1);
+}
+
+void HMS_PN532_Metrics::recordTimeout(uint8_t command) {
+    HMS_PN532_CommandMetricsTypeDef *entry = entryFor(command);
+    if (entry) HMS_PN532_METRIC_ADD(entry->responseTimeouts, 1);
+}
+
+uint8_t HMS_PN532_Metrics::snapshot(HMS_PN532_CommandMetricsTypeDef *out, uint8_t maxCommands) const {
+    uint8_t copied = 0;
+
+    for (uint8_t i = 0; i < HMS_PN532_METRICS_COMMANDS && copied < maxCommands; i++) {
+        const HMS_PN532_CommandMetricsTypeDef &entry = entries[i];
+        HMS_PN532_CommandMetricsTypeDef &dest = out[copied];
+
+        dest.key = HMS_PN532_METRIC_LOAD(entry.key);
+        if (dest.key == 0) continue;
+
+        dest.count              = HMS_PN532_METRIC_LOAD(entry.count);
+        dest.bytesOut           = HMS_PN532_METRIC_LOAD(entry.bytesOut);
+        dest.bytesIn            = HMS_PN532_METRIC_LOAD(entry.bytesIn);
+        dest.ackTimeouts        = HMS_PN532_METRIC_LOAD(entry.ackTimeouts);
+        dest.responseTimeouts   = HMS_PN532_METRIC_LOAD(entry.responseTimeouts);
+        dest.invalidFrames      = HMS_PN532_METRIC_LOAD(entry.invalidFrames);
+        dest.errors             = HMS_PN532_METRIC_LOAD(entry.errors);
+        for (uint8_t phase = 0; phase < HMS_PN532_PHASE_COUNT; phase++) {
+            for (uint8_t bucket = 0; bucket < HMS_PN532_METRICS_BUCKETS; bucket++) {
+                dest.latency[phase][bucket] = HMS_PN532_METRIC_LOAD(entry.latency[phase][bucket]);
+            }
+        }
+        copied++;
+    }
+    return copied;
+}
+
+void HMS_PN532_Metrics::reset() {                                                                                               // Counters only, command slots stay claimed
+    for (uint8_t i = 0; i < HMS_PN532_METRICS_COMMANDS; i++) {
+        HMS_PN532_CommandMetricsTypeDef &entry = entries[i];
+        __atomic_store_n(&entry.count, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&entry.bytesOut, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&entry.bytesIn, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&entry.ackTimeouts, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&entry.responseTimeouts, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&entry.invalidFrames, 0, __ATOMIC_RELAXED);
+        __atomic_store_n(&entry.errors, 0, __ATOMIC_RELAXED);
+        for (uint8_t phase = 0; phase < HMS_PN532_PHASE_COUNT; phase++) {
+            for (uint8_t bucket = 0; bucket < HMS_PN532_METRICS_BUCKETS; bucket++) {
+                __atomic_store_n(&entry.latency[phase][bucket], 0, __ATOMIC_RELAXED);
+            }
+        }
+    }
+}
+
+#endif // HMS_PN532_METRICS_ENABLED
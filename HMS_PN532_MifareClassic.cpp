@@ -1,13 +1,22 @@
 #include "HMS_PN532_MifareClassic.h"
 
-HMS_PN532_MifareClassic::HMS_PN532_MifareClassic(HMS_PN532_Controller& controller) {
+HMS_PN532_MifareClassic::HMS_PN532_MifareClassic(HMS_PN532_Controller& controller, uint8_t sectors) {
     this->controller = &controller;
+    this->sectors    = sectors;
 }
 
 HMS_PN532_MifareClassic::~HMS_PN532_MifareClassic() {
 
 }
 
+uint8_t HMS_PN532_MifareClassic::ndefSectors() const {
+    return (sectors < MIFARECLASSIC_MAD1_SECTORS) ? sectors : MIFARECLASSIC_MAD1_SECTORS;     // No MAD2 is written, a 4K keeps its NDEF in sectors 1-15
+}
+
+int HMS_PN532_MifareClassic::ndefCapacity() const {
+    return (ndefSectors() - 1) * (MIFARECLASSIC_NR_BLOCK_OF_SHORTSECTOR - 1) * MIFARECLASSIC_BLOCK_SIZE;
+}
+
 int HMS_PN532_MifareClassic::getNdefStartIndex(byte *data) {
     for (int i = 0; i < MIFARECLASSIC_BLOCK_SIZE; i++) {
         if (data[i] == 0x0) {
@@ -86,6 +95,12 @@ HMS_PN532_NFC_Tag HMS_PN532_MifareClassic::readTag(byte *uid, uint8_t uidLength)
 
     int index = 0;
     int bufferSize = getBufferSize(messageLength);
+    if (bufferSize > ndefCapacity()) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("NDEF length %d does not fit the %d-sector card", messageLength, sectors);
+        #endif
+        return HMS_PN532_NFC_Tag(uid, uidLength, "ERROR");
+    }
     uint8_t buffer[bufferSize];
     memset(buffer, 0, bufferSize); // Initialize buffer with zeros
 
@@ -147,13 +162,13 @@ HMS_PN532_StatusTypeDef HMS_PN532_MifareClassic::formatNDEF(byte *uid, uint8_t u
         #endif
         return HMS_PN532_ERROR;
     }
-    status = (HMS_PN532_StatusTypeDef)controller->mifareclassicFormatNDEF();
+    status = (HMS_PN532_StatusTypeDef)controller->mifareclassicFormatNDEF(ndefSectors());
     if (status != HMS_PN532_OK) {
         #if HMS_PN532_DEBUG_ENABLED
             pn532Logger.error("Unable to format the card for NDEF");
         #endif
     } else {
-        for (int i = 4; i < 64; i += 4) {
+        for (int i = 4; i < MIFARECLASSIC_FIRST_BLOCK_OF_SECTOR(ndefSectors()); i += 4) {         // NDEF sectors are all short ones
             status = (HMS_PN532_StatusTypeDef)controller->mifareclassicAuthenticateBlock (uid, uidLength, i, 0, keya);
             if (status == HMS_PN532_OK) {
                 if (i == 4)  {// special handling for block 4
@@ -201,9 +216,8 @@ HMS_PN532_StatusTypeDef HMS_PN532_MifareClassic::formatMifare(byte *uid, uint8_t
     uint8_t blockBuffer[16];                                                                    // Buffer to store block contents
     uint8_t blankAccessBits[3]       = { 0xff, 0x07, 0x80 };
     uint8_t idx                      = 0;
-    uint8_t numOfSector              = 16;                                                      // Assume Mifare Classic 1K for now (16 4-block sectors)
 
-    for (idx = 0; idx < numOfSector; idx++) {
+    for (idx = 0; idx < sectors; idx++) {
         if (                                                                                    // Step 1: Authenticate the current sector using key B 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF
             controller->mifareclassicAuthenticateBlock (
                 uid, uidLength, MIFARECLASSIC_BLOCK_NUMBER_OF_SECTOR_TRAILER(idx), 1, (uint8_t *)KEY_DEFAULT_KEYAB
@@ -215,54 +229,16 @@ HMS_PN532_StatusTypeDef HMS_PN532_MifareClassic::formatMifare(byte *uid, uint8_t
             return HMS_PN532_ERROR;
         }
 
-        if (idx == 0) {                                                                         // Step 2: Write to the other blocks
-            memset(blockBuffer, 0, sizeof(blockBuffer));
-            if (
-                controller->mifareclassicWriteDataBlock(
-                    (MIFARECLASSIC_BLOCK_NUMBER_OF_SECTOR_TRAILER(idx)) - 2, blockBuffer
-                ) != HMS_PN532_OK
-            ) {
-                #if HMS_PN532_DEBUG_ENABLED
-                    pn532Logger.error("Unable to write to sector %d", idx);
-                #endif
-            }
-        } else {
-            memset(blockBuffer, 0, sizeof(blockBuffer));
-
-            if (                                                                                // this block has not to be overwritten for block 0. It contains Tag id and other unique data.
-                controller->mifareclassicWriteDataBlock(
-                    (MIFARECLASSIC_BLOCK_NUMBER_OF_SECTOR_TRAILER(idx)) - 3, blockBuffer
-                ) != HMS_PN532_OK
-            ) {
-                #if HMS_PN532_DEBUG_ENABLED
-                    pn532Logger.error("Unable to write to sector %d", idx);
-                #endif
-            }
-
-            if (
-                controller->mifareclassicWriteDataBlock(
-                    (MIFARECLASSIC_BLOCK_NUMBER_OF_SECTOR_TRAILER(idx)) - 2, blockBuffer
-                ) != HMS_PN532_OK
-            ) {
+        memset(blockBuffer, 0, sizeof(blockBuffer));                                            // Step 2: Clear the data blocks, long sectors have 15
+        int block = (idx == 0) ? 1 : MIFARECLASSIC_FIRST_BLOCK_OF_SECTOR(idx);                  // Block 0 holds the UID and manufacturer data, it stays
+        for (; block < MIFARECLASSIC_BLOCK_NUMBER_OF_SECTOR_TRAILER(idx); block++) {
+            if (controller->mifareclassicWriteDataBlock(block, blockBuffer) != HMS_PN532_OK) {
                 #if HMS_PN532_DEBUG_ENABLED
                     pn532Logger.error("Unable to write to sector %d", idx);
                 #endif
             }
         }
 
-        memset(blockBuffer, 0, sizeof(blockBuffer));
-
-        if (
-            controller->mifareclassicWriteDataBlock(
-                (MIFARECLASSIC_BLOCK_NUMBER_OF_SECTOR_TRAILER(idx)) - 1, blockBuffer
-            ) != HMS_PN532_OK
-        ) {
-            #if HMS_PN532_DEBUG_ENABLED
-                pn532Logger.error("Unable to write to sector %d", idx);
-            #endif
-        }
-
-
         memcpy(blockBuffer, KEY_DEFAULT_KEYAB, sizeof(KEY_DEFAULT_KEYAB));                      // Step 3: Reset both keys to 0xFF 0xFF 0xFF 0xFF 0xFF 0xFF
         memcpy(blockBuffer + 6, blankAccessBits, sizeof(blankAccessBits));
         blockBuffer[9] = 0x69;
@@ -308,13 +284,20 @@ HMS_PN532_StatusTypeDef HMS_PN532_MifareClassic::writeTag(HMS_PN532_NDEF_Message
         buffer[4+sizeof(encoded)] = 0xFE; // terminator
     }
 
+    if ((int)sizeof(buffer) > ndefCapacity()) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("NDEF message of %d bytes does not fit the %d-sector card", (int)sizeof(encoded), sectors);
+        #endif
+        return HMS_PN532_ERROR;
+    }
+
     // Write to tag
     int index = 0;
     int currentBlock = 4;
     uint8_t key[6] = { 0xD3, 0xF7, 0xD3, 0xF7, 0xD3, 0xF7 }; // this is Sector 1 - 15 key
 
     while (index < sizeof(buffer)) {
-        if (controller->mifareclassicIsFirstBlock(currentBlock)){
+        if (controller->mifareclassicIsFirstBlock(currentBlock) == HMS_PN532_OK) {
             if (
                 controller->mifareclassicAuthenticateBlock(
                     uid, uidLength, currentBlock, 0, key
@@ -1,7 +1,23 @@
 #include "HMS_PN532_MifareUltralight.h"
 
-HMS_PN532_MifareUltralight::HMS_PN532_MifareUltralight(HMS_PN532_Controller& controller) {
+static const struct {
+    uint8_t                     productType;                                    // GET_VERSION byte 2
+    uint8_t                     storageSize;                                    // GET_VERSION byte 6
+    HMS_PN532_Type2ModelTypeDef model;
+    uint16_t                    userBytes;
+} TYPE2_VERSIONS[] = {
+    { 0x03, 0x0B, HMS_PN532_TYPE2_ULTRALIGHT_EV1,  48 },                        // MF0UL11
+    { 0x03, 0x0E, HMS_PN532_TYPE2_ULTRALIGHT_EV1, 128 },                        // MF0UL21
+    { 0x04, 0x0B, HMS_PN532_TYPE2_NTAG210,         48 },
+    { 0x04, 0x0E, HMS_PN532_TYPE2_NTAG212,        128 },
+    { 0x04, 0x0F, HMS_PN532_TYPE2_NTAG213,        144 },
+    { 0x04, 0x11, HMS_PN532_TYPE2_NTAG215,        504 },
+    { 0x04, 0x13, HMS_PN532_TYPE2_NTAG216,        888 },
+};
+
+HMS_PN532_MifareUltralight::HMS_PN532_MifareUltralight(HMS_PN532_Controller& controller, HMS_PN532_Type2InfoTypeDef *info) {
     this->controller    = &controller;
+    this->info          = info ? info : &ownInfo;
     ndefStartIndex      = 0;
     messageLength       = 0;
 }
@@ -10,49 +26,72 @@ HMS_PN532_MifareUltralight::~HMS_PN532_MifareUltralight() {
 
 }
 
-bool HMS_PN532_MifareUltralight::isUnformatted() {
-    uint8_t page = 4;
-    byte data[MIFAREULTRALIGHT_READ_SIZE];
-    if (controller->mifareultralightReadPage(page, data) == HMS_PN532_OK) {
-        return (data[0] == 0xFF && data[1] == 0xFF && data[2] == 0xFF && data[3] == 0xFF);
-    } else {
+bool HMS_PN532_MifareUltralight::identify() {
+    if (info->model != HMS_PN532_TYPE2_NOT_PROBED) return true;
+
+    uint8_t version[8];
+    if (controller->ntagGetVersion(version) != HMS_PN532_OK) {
+        if (controller->inSelect(controller->getActiveTarget()) != HMS_PN532_OK) return false;       // The NAK halted it, or it is gone
+
+        memset(info, 0, sizeof(*info));
+        info->model = HMS_PN532_TYPE2_ULTRALIGHT;
         #if HMS_PN532_DEBUG_ENABLED
-            pn532Logger.error("Error. Failed read page %d", page);
+            pn532Logger.debug("No GET_VERSION, original Ultralight or Ultralight C");
         #endif
-        return false;
+        return true;
+    }
+
+    memcpy(info->version, version, sizeof(version));
+    info->model     = HMS_PN532_TYPE2_OTHER;
+    info->userBytes = 0;
+    for (const auto &known : TYPE2_VERSIONS) {
+        if (version[1] == 0x04 && version[2] == known.productType && version[6] == known.storageSize) {    // NXP only
+            info->model     = known.model;
+            info->userBytes = known.userBytes;
+            break;
+        }
     }
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.debug("GET_VERSION product 0x%02X storage 0x%02X, %u user bytes", version[2], version[6], info->userBytes);
+    #endif
+    return true;
 }
 
-void HMS_PN532_MifareUltralight::findNdefMessage() {
-    int page;
-    byte data[12];                                      // 3 pages
-    byte* data_ptr = &data[0];
+bool HMS_PN532_MifareUltralight::readHeader(byte *header) {
+    if (!identify()) return false;
 
-    // the nxp read command reads 4 pages, unfortunately adafruit give me one page at a time
-    HMS_PN532_StatusTypeDef status = HMS_PN532_OK;
-    for (page = 4; page < 6; page++) {
-        if(controller->mifareultralightReadPage(page, data_ptr) != HMS_PN532_OK) {
-            status = HMS_PN532_ERROR;
-        }
+    if (controller->mifareultralightReadPages(MIFAREULTRALIGHT_CC_PAGE, header) != HMS_PN532_OK) {        // CC page and the first three data pages in one READ
         #if HMS_PN532_DEBUG_ENABLED
-            // pn532Logger.debug("Page %d - ", page);
-            // for (int i = 0; i < MIFAREULTRALIGHT_PAGE_SIZE; i++) {
-            //     ptr += sprintf(ptr, "%02X ", data_ptr[i]);
-            // }
-            // pn532Logger.debug("Data: %s", hexString);
-
+            pn532Logger.error("Error. Failed read page %d", MIFAREULTRALIGHT_CC_PAGE);
         #endif
-        data_ptr += MIFAREULTRALIGHT_PAGE_SIZE;
+        return false;
     }
 
-    if (status == HMS_PN532_OK) {
-        if (data[0] == 0x03) {
-            messageLength = data[1];
-            ndefStartIndex = 2;
-        } else if (data[5] == 0x3) { // page 5 byte 1
-            messageLength = data[6];
-            ndefStartIndex = 7;
-        }
+    tagCapacity = info->userBytes ? info->userBytes : header[2] * 8;                // See AN1303 - different rules for Mifare Family byte2 = (additional data + 48)/8
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.debug("Tag capacity %d bytes", tagCapacity);
+    #endif
+    return true;
+}
+
+bool HMS_PN532_MifareUltralight::isUnformatted(const byte *header) {
+    const byte *data = &header[MIFAREULTRALIGHT_PAGE_SIZE];                         // Page 4
+    return (data[0] == 0xFF && data[1] == 0xFF && data[2] == 0xFF && data[3] == 0xFF);
+}
+
+void HMS_PN532_MifareUltralight::findNdefMessage(const byte *header) {
+    const byte *data = &header[MIFAREULTRALIGHT_PAGE_SIZE];                         // Pages 4-6, already read with the CC
+
+    if (data[0] == 0x03 && data[1] == 0xFF) {                                      // Three-byte length, messages of 255 bytes and more
+        messageLength = (data[2] << 8) | data[3];
+        ndefStartIndex = 4;
+    } else if (data[0] == 0x03) {
+        messageLength = data[1];
+        ndefStartIndex = 2;
+    } else if (data[5] == 0x3) { // page 5 byte 1
+        messageLength = data[6];
+        ndefStartIndex = 7;
     }
 
     #if HMS_PN532_DEBUG_ENABLED
@@ -64,28 +103,18 @@ void HMS_PN532_MifareUltralight::findNdefMessage() {
 void HMS_PN532_MifareUltralight::calculateBufferSize() {
     bufferSize = messageLength + ndefStartIndex + 1;                // TLV terminator 0xFE is 1 byte
 
-    if (bufferSize % MIFAREULTRALIGHT_READ_SIZE != 0) {
+    if (bufferSize % MIFAREULTRALIGHT_PAGE_SIZE != 0) {
         bufferSize = (
-            (bufferSize / MIFAREULTRALIGHT_READ_SIZE) + 1
-        ) * MIFAREULTRALIGHT_READ_SIZE;                             // buffer must be an increment of page size
-    }
-}
-
-void HMS_PN532_MifareUltralight::readCapabilityContainer() {
-    byte data[MIFAREULTRALIGHT_PAGE_SIZE];
-
-    if (controller->mifareultralightReadPage (3, data) == HMS_PN532_OK) {
-        tagCapacity = data[2] * 8;                                                  // See AN1303 - different rules for Mifare Family byte2 = (additional data + 48)/8
-        #if HMS_PN532_DEBUG_ENABLED
-            pn532Logger.debug("Tag capacity %d bytes", tagCapacity);
-        #endif
+            (bufferSize / MIFAREULTRALIGHT_PAGE_SIZE) + 1
+        ) * MIFAREULTRALIGHT_PAGE_SIZE;                             // buffer must be an increment of page size
     }
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_MifareUltralight::cleanTag() {
     uint8_t data[4] = { 0x00, 0x00, 0x00, 0x00 };                                       // factory tags have 0xFF, but OTP-CC blocks have already been set so we use 0x00
-    
-    readCapabilityContainer();                                                          // meta info for tag
+    byte header[MIFAREULTRALIGHT_READ_SIZE];
+
+    if (!readHeader(header)) return HMS_PN532_ERROR;                                    // meta info for tag
 
     uint8_t pages = (
         tagCapacity / MIFAREULTRALIGHT_PAGE_SIZE
@@ -107,14 +136,20 @@ HMS_PN532_StatusTypeDef HMS_PN532_MifareUltralight::cleanTag() {
 }
 
 HMS_PN532_NFC_Tag HMS_PN532_MifareUltralight::readTag(byte * uid, uint8_t uidLength) {
-    if (isUnformatted()) {
-        Serial.println(F("WARNING: Tag is not formatted."));
+    byte header[MIFAREULTRALIGHT_READ_SIZE];
+
+    if (!readHeader(header)) {
         return HMS_PN532_NFC_Tag(uid, uidLength, MIFAREULTRALIGHT_TYPE_NAME);
     }
 
-    readCapabilityContainer();                                                                      // meta info for tag
-    findNdefMessage();
-    calculateBufferSize();
+    if (isUnformatted(header)) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.warn("Tag is not formatted.");
+        #endif
+        return HMS_PN532_NFC_Tag(uid, uidLength, MIFAREULTRALIGHT_TYPE_NAME);
+    }
+
+    findNdefMessage(header);
 
     if (messageLength == 0) {                                                                       // data is 0x44 0x03 0x00 0xFE
         HMS_PN532_NDEF_Message message = HMS_PN532_NDEF_Message();
@@ -122,17 +157,31 @@ HMS_PN532_NFC_Tag HMS_PN532_MifareUltralight::readTag(byte * uid, uint8_t uidLen
         return HMS_PN532_NFC_Tag(uid, uidLength, MIFAREULTRALIGHT_TYPE_NAME, message);
     }
 
-    uint8_t page;
-    uint8_t index = 0;
-    byte buffer[bufferSize];
-    for (page = MIFAREULTRALIGHT_DATA_START_PAGE; page < MIFAREULTRALIGHT_MAX_PAGE; page++) {
-        
-        if (controller->mifareultralightReadPage(page, &buffer[index]) == HMS_PN532_OK) {          // read the data
-            #ifdef MIFARE_ULTRALIGHT_DEBUG
-            Serial.print(F("Page "));Serial.print(page);Serial.print(" ");
-            nfc->PrintHexChar(&buffer[index], ULTRALIGHT_PAGE_SIZE);
-            #endif
-        } else {
+    unsigned int total = messageLength + ndefStartIndex;
+    if (total > tagCapacity) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("NDEF TLV runs past the tag capacity");
+        #endif
+        return HMS_PN532_NFC_Tag(uid, uidLength, MIFAREULTRALIGHT_TYPE_NAME);
+    }
+
+    byte buffer[total + MIFAREULTRALIGHT_READ_SIZE];                                                // The last READ may run past the TLV
+    unsigned int index = MIFAREULTRALIGHT_READ_SIZE - MIFAREULTRALIGHT_PAGE_SIZE;
+    uint8_t page = MIFAREULTRALIGHT_DATA_START_PAGE + index / MIFAREULTRALIGHT_PAGE_SIZE;
+
+    memcpy(buffer, &header[MIFAREULTRALIGHT_PAGE_SIZE], index);                                     // Pages 4-6 came with the header
+    if (total > index + MIFAREULTRALIGHT_READ_SIZE && info->model != HMS_PN532_TYPE2_ULTRALIGHT) {     // One READ is as quick as FAST_READ
+        uint8_t lastPage = MIFAREULTRALIGHT_DATA_START_PAGE + (total - 1) / MIFAREULTRALIGHT_PAGE_SIZE;
+
+        if (controller->ntagFastRead(page, lastPage, &buffer[index], sizeof(buffer) - index) == HMS_PN532_OK) {
+            index = total;                                                                          // NTAG21x: the rest in one or two frames
+        } else if (controller->inSelect(controller->getActiveTarget()) != HMS_PN532_OK) {           // A NAK halts the tag, wake it for plain READs
+            messageLength = 0;
+        }
+    }
+
+    while (messageLength && index < total) {
+        if (controller->mifareultralightReadPages(page, &buffer[index]) != HMS_PN532_OK) {
             #if HMS_PN532_DEBUG_ENABLED
                 pn532Logger.error("Error. Failed read page %d", page);
             #endif
@@ -140,11 +189,8 @@ HMS_PN532_NFC_Tag HMS_PN532_MifareUltralight::readTag(byte * uid, uint8_t uidLen
             break;
         }
 
-        if (index >= (messageLength + ndefStartIndex)) {
-            break;
-        }
-
-        index += MIFAREULTRALIGHT_DATA_START_PAGE;
+        index += MIFAREULTRALIGHT_READ_SIZE;
+        page  += MIFAREULTRALIGHT_READ_SIZE / MIFAREULTRALIGHT_PAGE_SIZE;
     }
 
     HMS_PN532_NDEF_Message ndefMessage = HMS_PN532_NDEF_Message(&buffer[ndefStartIndex], messageLength);
@@ -153,13 +199,15 @@ HMS_PN532_NFC_Tag HMS_PN532_MifareUltralight::readTag(byte * uid, uint8_t uidLen
 }
 
 HMS_PN532_StatusTypeDef HMS_PN532_MifareUltralight::writeTag(HMS_PN532_NDEF_Message& ndefMessage, byte *uid, uint8_t uidLength) {
-    if (isUnformatted()) {
+    byte header[MIFAREULTRALIGHT_READ_SIZE];
+
+    if (!readHeader(header)) return HMS_PN532_ERROR;                                                                                   // meta info for tag
+    if (isUnformatted(header)) {
         #if HMS_PN532_DEBUG_ENABLED
             pn532Logger.error("Tag is not formatted.");
         #endif
         return HMS_PN532_ERROR;
     }
-    readCapabilityContainer();                                                                                                         // meta info for tag
 
     messageLength  = ndefMessage.getEncodedSize();
     ndefStartIndex = messageLength < 0xFF ? 2 : 4;
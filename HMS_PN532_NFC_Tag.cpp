@@ -2,7 +2,7 @@
 
 
 HMS_PN532_NFC_Tag::HMS_PN532_NFC_Tag() {
-    uid         = 0;
+    memset(uid, 0, sizeof(uid));
     uidLength   = 0;
     tagType     = "Unknown";
     ndefMessage = (HMS_PN532_NDEF_Message*)NULL;
@@ -13,40 +13,47 @@ HMS_PN532_NFC_Tag::~HMS_PN532_NFC_Tag() {
 }
 
 HMS_PN532_NFC_Tag::HMS_PN532_NFC_Tag(byte *uid, unsigned int uidLength) {
-    this->uid           = uid;
-    this->uidLength     = uidLength;
+    this->uidLength     = (uidLength < sizeof(this->uid)) ? uidLength : sizeof(this->uid);
+    memcpy(this->uid, uid, this->uidLength);
     this->tagType       = "Unknown";
     this->ndefMessage   = (HMS_PN532_NDEF_Message*)NULL;
 }
 
 HMS_PN532_NFC_Tag::HMS_PN532_NFC_Tag(byte *uid, unsigned int uidLength, std::string tagType) {
-    this->uid           = uid;
-    this->uidLength     = uidLength;
+    this->uidLength     = (uidLength < sizeof(this->uid)) ? uidLength : sizeof(this->uid);
+    memcpy(this->uid, uid, this->uidLength);
     this->tagType       = tagType;
     this->ndefMessage   = (HMS_PN532_NDEF_Message*)NULL;
 }
 
 HMS_PN532_NFC_Tag::HMS_PN532_NFC_Tag(byte *uid, unsigned int uidLength, std::string tagType, HMS_PN532_NDEF_Message& ndefMessage) {
-    this->uid           = uid;
-    this->uidLength     = uidLength;
+    this->uidLength     = (uidLength < sizeof(this->uid)) ? uidLength : sizeof(this->uid);
+    memcpy(this->uid, uid, this->uidLength);
     this->tagType       = tagType;
     this->ndefMessage   = new HMS_PN532_NDEF_Message(ndefMessage);
 }
 
 HMS_PN532_NFC_Tag::HMS_PN532_NFC_Tag(byte *uid, unsigned int uidLength, std::string tagType, const byte *ndefData, const int ndefDataLength) {
-    this->uid           = uid;
-    this->uidLength     = uidLength;
+    this->uidLength     = (uidLength < sizeof(this->uid)) ? uidLength : sizeof(this->uid);
+    memcpy(this->uid, uid, this->uidLength);
     this->tagType       = tagType;
     this->ndefMessage   = new HMS_PN532_NDEF_Message(ndefData, ndefDataLength);
 }
 
+HMS_PN532_NFC_Tag::HMS_PN532_NFC_Tag(const HMS_PN532_NFC_Tag& rhs) {
+    memcpy(uid, rhs.uid, sizeof(uid));
+    uidLength   = rhs.uidLength;
+    tagType     = rhs.tagType;
+    ndefMessage = rhs.ndefMessage ? new HMS_PN532_NDEF_Message(*rhs.ndefMessage) : (HMS_PN532_NDEF_Message*)NULL;
+}
+
 HMS_PN532_NFC_Tag &HMS_PN532_NFC_Tag::operator=(const HMS_PN532_NFC_Tag& rhs) {
     if (this != &rhs) {
         delete ndefMessage;
-        uid = rhs.uid;
+        memcpy(uid, rhs.uid, sizeof(uid));
         uidLength = rhs.uidLength;
         tagType = rhs.tagType;
-        ndefMessage = rhs.ndefMessage;
+        ndefMessage = rhs.ndefMessage ? new HMS_PN532_NDEF_Message(*rhs.ndefMessage) : (HMS_PN532_NDEF_Message*)NULL;     // Each tag owns its message
     }
     return *this;
 }
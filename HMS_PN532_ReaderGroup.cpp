@@ -0,0 +1,183 @@
+#include "HMS_PN532_ReaderGroup.h"
+
+#if defined(HMS_PLATFORM_DESKTOP) || defined(HMS_PN532_ARDUINO_ESP32)
+
+const HMS_PN532_ReaderGroupConfigTypeDef HMS_PN532_ReaderGroup::DEFAULT_CONFIG = {
+    2,                                                                                                                          // workers
+    100,                                                                                                                        // pollTimeoutMs
+    true,                                                                                                                       // readNdef
+    1000,                                                                                                                       // repeatMs
+    2000                                                                                                                        // retryMs
+};
+
+HMS_PN532_ReaderGroup::~HMS_PN532_ReaderGroup() {
+    stop();
+    for (ReaderSlot &slot : readers) delete slot.nfc;                                                                          // Also deletes the interface
+}
+
+uint32_t HMS_PN532_ReaderGroup::groupMillis() {
+    #if defined(HMS_PLATFORM_DESKTOP)
+        return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+            std::chrono::steady_clock::now().time_since_epoch()
+        ).count();
+    #else
+        return millis();
+    #endif
+}
+
+int16_t HMS_PN532_ReaderGroup::addReader(HMS_PN532_Interface *interface, uint8_t bus) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (running || readers.size() >= 255) return -1;
+
+    ReaderSlot slot = {};
+    slot.nfc = new HMS_PN532(interface);
+    slot.bus = bus;
+    readers.push_back(slot);
+
+    return (int16_t)(readers.size() - 1);
+}
+
+HMS_PN532 *HMS_PN532_ReaderGroup::getReader(uint8_t reader) {
+    std::lock_guard<std::mutex> guard(lock);
+    return (reader < readers.size()) ? readers[reader].nfc : nullptr;
+}
+
+HMS_PN532_StatusTypeDef HMS_PN532_ReaderGroup::start() {
+    std::lock_guard<std::mutex> guard(lock);
+    if (running) return HMS_PN532_BUSY;
+    if (readers.empty()) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.error("Reader group has no readers");
+        #endif
+        return HMS_PN532_ERROR;
+    }
+
+    running = true;
+    uint8_t count = config.workers ? config.workers : 1;
+    for (uint8_t i = 0; i < count; i++) workers.emplace_back(&HMS_PN532_ReaderGroup::workerLoop, this);
+
+    #if HMS_PN532_DEBUG_ENABLED
+        pn532Logger.info("Reader group started: %u readers, %u workers", (unsigned)readers.size(), count);
+    #endif
+
+    return HMS_PN532_OK;
+}
+
+void HMS_PN532_ReaderGroup::stop() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (!running) return;
+        running = false;
+    }
+    readerFreed.notify_all();
+
+    for (std::thread &worker : workers) worker.join();
+    workers.clear();
+}
+
+int16_t HMS_PN532_ReaderGroup::nextReader(uint32_t now) {
+    uint8_t count = (uint8_t)readers.size();
+
+    for (uint8_t i = 0; i < count; i++) {
+        uint8_t index = (uint8_t)((cursor + i) % count);
+        const ReaderSlot &slot = readers[index];
+
+        if (slot.busy || busBusy[slot.bus]) continue;                                                                          // Bus taken by another worker
+        if (!slot.started && (int32_t)(now - slot.retryAt) < 0) continue;                                                      // Still backing off
+
+        cursor = (uint8_t)((index + 1) % count);
+        return index;
+    }
+    return -1;
+}
+
+void HMS_PN532_ReaderGroup::workerLoop() {
+    std::unique_lock<std::mutex> guard(lock);
+
+    while (running) {
+        int16_t index = nextReader(groupMillis());
+        if (index < 0) {
+            readerFreed.wait_for(guard, std::chrono::milliseconds(10));                                                        // Woken when a bus frees, or to re-check back-offs
+            continue;
+        }
+
+        ReaderSlot &slot = readers[index];
+        slot.busy = true;
+        busBusy[slot.bus] = true;
+
+        guard.unlock();
+        visit(slot, (uint8_t)index);
+        guard.lock();
+
+        slot.busy = false;
+        busBusy[slot.bus] = false;
+        readerFreed.notify_one();
+    }
+}
+
+void HMS_PN532_ReaderGroup::visit(ReaderSlot &slot, uint8_t index) {
+    if (!slot.started) {
+        if (slot.nfc->begin() != HMS_PN532_OK) {
+            #if HMS_PN532_DEBUG_ENABLED
+                pn532Logger.warn("Reader %u did not start, retrying in %u ms", index, config.retryMs);
+            #endif
+            slot.retryAt = groupMillis() + config.retryMs;
+            return;
+        }
+        slot.started = true;
+    }
+
+    HMS_PN532_StatusTypeDef status = slot.nfc->tagAvailable(config.pollTimeoutMs);
+    scans++;
+    if (status != HMS_PN532_OK) return;
+
+    uint32_t now        = groupMillis();
+    uint8_t  uidLength  = slot.nfc->getUidLength();
+    uint8_t  *uid       = slot.nfc->getUid();
+
+    if (uidLength == slot.lastUidLength && memcmp(uid, slot.lastUid, uidLength) == 0 &&
+        (now - slot.lastSeenAt) < config.repeatMs
+    )   return;                                                                                                                 // Card still held on the reader
+
+    memcpy(slot.lastUid, uid, uidLength);
+    slot.lastUidLength = uidLength;
+    slot.lastSeenAt    = now;
+
+    HMS_PN532_TagEventTypeDef event = {
+        index, now, config.readNdef ? slot.nfc->readTag() : HMS_PN532_NFC_Tag(uid, uidLength)
+    };
+
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        if (events.size() >= HMS_PN532_READER_GROUP_QUEUE_LEN) {
+            events.pop_front();
+            dropped++;
+        }
+        events.push_back(event);
+    }
+    eventAdded.notify_one();
+}
+
+bool HMS_PN532_ReaderGroup::pollEvent(HMS_PN532_TagEventTypeDef &event) {
+    std::lock_guard<std::mutex> guard(lock);
+    if (events.empty()) return false;
+
+    event = events.front();
+    events.pop_front();
+    return true;
+}
+
+bool HMS_PN532_ReaderGroup::waitEvent(HMS_PN532_TagEventTypeDef &event, uint32_t timeoutMs) {
+    std::unique_lock<std::mutex> guard(lock);
+
+    if (timeoutMs == 0) {
+        eventAdded.wait(guard, [this] { return !events.empty(); });
+    } else if (!eventAdded.wait_for(guard, std::chrono::milliseconds(timeoutMs), [this] { return !events.empty(); })) {
+        return false;
+    }
+
+    event = events.front();
+    events.pop_front();
+    return true;
+}
+#endif
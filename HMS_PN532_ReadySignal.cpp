@@ -0,0 +1,90 @@
+#include "HMS_PN532_ReadySignal.h"
+
+#if defined(HMS_PLATFORM_DESKTOP)
+void HMS_PN532_ReadyEvent::set() {
+    {
+        std::lock_guard<std::mutex> guard(lock);
+        asserted = true;
+    }
+    changed.notify_all();
+}
+
+void HMS_PN532_ReadyEvent::reset() {
+    std::lock_guard<std::mutex> guard(lock);
+    asserted = false;
+}
+
+bool HMS_PN532_ReadyEvent::wait(uint32_t timeoutMs) {
+    std::unique_lock<std::mutex> guard(lock);
+    if (timeoutMs == 0) {
+        changed.wait(guard, [this] { return asserted; });
+        return true;
+    }
+    return changed.wait_for(guard, std::chrono::milliseconds(timeoutMs), [this] { return asserted; });
+}
+
+bool HMS_PN532_ReadyEvent::isAsserted() {
+    std::lock_guard<std::mutex> guard(lock);
+    return asserted;
+}
+#elif defined(HMS_PN532_PLATFORM_ARDUINO)
+HMS_PN532_ReadyPin::~HMS_PN532_ReadyPin() {
+    #if defined(HMS_PN532_ARDUINO_ESP32)
+        if (irqSemaphore) {
+            detachInterrupt(digitalPinToInterrupt(irqPin));
+            vSemaphoreDelete(irqSemaphore);
+        }
+    #endif
+}
+
+void HMS_PN532_ReadyPin::begin() {
+    if (irqPin < 0) return;
+
+    pinMode(irqPin, INPUT_PULLUP);
+
+    #if defined(HMS_PN532_ARDUINO_ESP32)
+        if (!irqSemaphore) {
+            irqSemaphore = xSemaphoreCreateBinary();
+            attachInterruptArg(digitalPinToInterrupt(irqPin), onFallingEdge, this, FALLING);
+        }
+    #endif
+}
+
+#if defined(HMS_PN532_ARDUINO_ESP32)
+void IRAM_ATTR HMS_PN532_ReadyPin::onFallingEdge(void *arg) {
+    BaseType_t woken = pdFALSE;
+    xSemaphoreGiveFromISR(static_cast<HMS_PN532_ReadyPin *>(arg)->irqSemaphore, &woken);
+    portYIELD_FROM_ISR(woken);
+}
+#endif
+
+bool HMS_PN532_ReadyPin::wait(uint32_t timeoutMs) {
+    if (irqPin < 0) return true;                                                                    // Not wired, the caller's status poll does the waiting
+    if (digitalRead(irqPin) == LOW) return true;                                                    // Level already asserted
+
+    #if defined(HMS_PN532_ARDUINO_ESP32)
+        if (irqSemaphore) {
+            TickType_t start = xTaskGetTickCount();                                                 // Stale edges must not restart the timeout
+            TickType_t total = pdMS_TO_TICKS(timeoutMs);
+            TickType_t ticks = timeoutMs ? total : portMAX_DELAY;
+
+            while (xSemaphoreTake(irqSemaphore, ticks) == pdTRUE) {                                  // Edges from an earlier frame may still be queued
+                if (digitalRead(irqPin) == LOW) return true;
+                if (!timeoutMs) continue;
+
+                TickType_t elapsed = xTaskGetTickCount() - start;
+                if (elapsed >= total) return false;
+                ticks = total - elapsed;
+            }
+            return false;
+        }
+    #endif
+
+    unsigned long start = millis();                                                                 // No interrupt available, watch the level
+    while (digitalRead(irqPin) != LOW) {
+        if (timeoutMs && (millis() - start) >= timeoutMs) return false;
+        yield();
+    }
+    return true;
+}
+#endif
@@ -0,0 +1,107 @@
+#include "HMS_PN532_TagCache.h"
+
+#if HMS_PN532_TAG_CACHE_ENTRIES
+HMS_PN532_TagCache::Entry *HMS_PN532_TagCache::find(const uint8_t *uid, uint8_t uidLength, uint8_t tagType) {
+    for (Entry &entry : entries) {
+        if (entry.used && entry.tagType == tagType && entry.uidLength == uidLength && memcmp(entry.uid, uid, uidLength) == 0) {
+            return &entry;
+        }
+    }
+    return nullptr;
+}
+
+void HMS_PN532_TagCache::drop(Entry &entry) {
+    usedBytes  -= entry.cost;
+    entry.used  = false;
+    entry.tag   = HMS_PN532_NFC_Tag();                                                                  // Frees the decoded message now, not at the next store
+}
+
+HMS_PN532_TagCache::Entry *HMS_PN532_TagCache::evictOldest() {
+    Entry *oldest = nullptr;
+    for (Entry &entry : entries) {
+        if (entry.used && (!oldest || (int32_t)(entry.lastUsed - oldest->lastUsed) < 0)) oldest = &entry;
+    }
+
+    if (oldest) {
+        drop(*oldest);
+        stats.evictions++;
+    }
+    return oldest;
+}
+
+const HMS_PN532_NFC_Tag *HMS_PN532_TagCache::lookup(
+    const uint8_t *uid, uint8_t uidLength, uint8_t tagType, const uint8_t *check, uint8_t checkLength, uint32_t nowMs
+) {
+    Entry *entry = find(uid, uidLength, tagType);
+    if (!entry) {
+        stats.misses++;
+        return nullptr;
+    }
+
+    if ((nowMs - entry->storedAtMs) >= ttlMs ||
+        entry->checkLength != checkLength || memcmp(entry->check, check, checkLength) != 0
+    ) {
+        #if HMS_PN532_DEBUG_ENABLED
+            pn532Logger.debug("Cached tag is stale, reading it again");
+        #endif
+        drop(*entry);
+        stats.misses++;
+        return nullptr;
+    }
+
+    entry->lastUsed = ++useClock;
+    stats.hits++;
+    return &entry->tag;
+}
+
+void HMS_PN532_TagCache::store(
+    const HMS_PN532_NFC_Tag &tag, const uint8_t *uid, uint8_t uidLength, uint8_t tagType,
+    const uint8_t *check, uint8_t checkLength, uint32_t nowMs
+) {
+    if (uidLength > sizeof(entries[0].uid) || checkLength > sizeof(entries[0].check)) return;
+
+    uint16_t cost = tag.hasNdefMessage() ? (uint16_t)tag.getNdefMessage().getEncodedSize() : 0;
+    if (cost > HMS_PN532_TAG_CACHE_BUDGET) return;                                                      // Would never fit, leave the others alone
+
+    Entry *entry = find(uid, uidLength, tagType);
+    if (entry) drop(*entry);
+
+    while (usedBytes + cost > HMS_PN532_TAG_CACHE_BUDGET) evictOldest();
+
+    entry = nullptr;
+    for (Entry &candidate : entries) {
+        if (!candidate.used) {
+            entry = &candidate;
+            break;
+        }
+    }
+    if (!entry) entry = evictOldest();
+
+    entry->used        = true;
+    entry->uidLength   = uidLength;
+    entry->tagType     = tagType;
+    entry->checkLength = checkLength;
+    entry->cost        = cost;
+    entry->storedAtMs  = nowMs;
+    entry->lastUsed    = ++useClock;
+    entry->tag         = tag;
+    memcpy(entry->uid, uid, uidLength);
+    memcpy(entry->check, check, checkLength);
+    usedBytes += cost;
+}
+
+void HMS_PN532_TagCache::invalidate(const uint8_t *uid, uint8_t uidLength) {
+    for (Entry &entry : entries) {
+        if (entry.used && entry.uidLength == uidLength && memcmp(entry.uid, uid, uidLength) == 0) {
+            drop(entry);
+            stats.invalidations++;
+        }
+    }
+}
+
+void HMS_PN532_TagCache::clear() {
+    for (Entry &entry : entries) {
+        if (entry.used) drop(entry);
+    }
+}
+#endif
@@ -37,8 +37,10 @@ void nfcTask(void *parameter) {
                 (const uint8_t*)jsonString.c_str(), 
                 jsonString.size()
             );
-            // Delay to prevent spamming if the card is held
-            vTaskDelay(1000 / portTICK_PERIOD_MS);
+            // Wait for the card to leave, one short transaction per check instead of a full re-read
+            while(nfc->isTagStillPresent()) {
+                vTaskDelay(100 / portTICK_PERIOD_MS);
+            }
         }
         vTaskDelay(100 / portTICK_PERIOD_MS);
     } 
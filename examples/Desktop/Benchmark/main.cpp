@@ -0,0 +1,170 @@
+// End-to-end throughput benchmark for the HMS_PN532 tag operations, run against
+// HMS_PN532_Interface_Emulator so no reader is needed.
+//
+// Build with the library's CMake option, or by hand from the library root:
+//   cmake -S . -B build -DHMS_PN532_BUILD_BENCHMARK=ON && cmake --build build
+//   g++ -std=c++17 -O2 -Iinclude HMS_PN532_*.cpp examples/Desktop/Benchmark/main.cpp -o pn532_benchmark -lpthread
+// Usage:
+//   pn532_benchmark [--timing none|i2c|spi|hsu] [--iterations N] [--sizes 16,64,200]
+//
+// One JSON object per line and per (card, NDEF size, operation):
+//   {"timing":"i2c","card":"classic1k","ndef_bytes":64,"op":"readTag","iterations":50,"failures":0,
+//    "ops_per_sec":..,"p50_us":..,"p99_us":..,"transactions":..,"bytes_out":..,"bytes_in":..,"auths_skipped":..}
+// transactions and bytes are per operation, counted on the emulated bus (frames, ACKs included).
+// auths_skipped counts the MIFARE Classic authentications the controller answered from its tracked
+// sector instead of the card; without the tracking each one would be one more transaction.
+// readTag fails unless it returns the message writeTag wrote. On Classic cards a marker is planted in the
+// last data block before cleanTag, which fails unless the card image is back to transport state after it.
+
+#include <vector>
+#include <algorithm>
+#include "HMS_PN532_DRIVER.h"
+#include "HMS_PN532_Interface_Emulator.h"
+
+typedef enum {
+    OP_TAG_AVAILABLE,
+    OP_FORMAT_TAG,
+    OP_WRITE_TAG,
+    OP_READ_TAG,
+    OP_ERASE_TAG,
+    OP_CLEAN_TAG,
+    OP_COUNT
+} BenchmarkOp;
+
+static const char *OP_NAMES[OP_COUNT] = { "tagAvailable", "formatTag", "writeTag", "readTag", "eraseTag", "cleanTag" };
+
+typedef struct {
+    std::vector<uint32_t>   samples;                                            // Wall time per call, us
+    uint32_t                failures;
+    uint64_t                transactions;
+    uint64_t                bytesOut;
+    uint64_t                bytesIn;
+    uint64_t                authsSkipped;
+} OpResult;
+
+static uint32_t percentile(std::vector<uint32_t> samples, uint8_t p) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    return samples[(samples.size() - 1) * p / 100];
+}
+
+static bool sameMessage(HMS_PN532_NDEF_Message &a, HMS_PN532_NDEF_Message b) {
+    std::vector<uint8_t> encodedA(a.getEncodedSize()), encodedB(b.getEncodedSize());
+    a.encode(encodedA.data());
+    b.encode(encodedB.data());
+    return encodedA == encodedB;
+}
+
+static bool runOp(HMS_PN532 &nfc, BenchmarkOp op, HMS_PN532_NDEF_Message &message) {
+    switch (op) {
+        case OP_TAG_AVAILABLE:  return nfc.tagAvailable(100) == HMS_PN532_OK;
+        case OP_FORMAT_TAG:     return nfc.formatTag() == HMS_PN532_OK;
+        case OP_WRITE_TAG:      return nfc.writeTag(message) == HMS_PN532_OK;
+        case OP_READ_TAG: {
+            HMS_PN532_NFC_Tag tag = nfc.readTag();
+            return tag.hasNdefMessage() && sameMessage(message, tag.getNdefMessage());
+        }
+        case OP_ERASE_TAG:      return nfc.eraseTag() == HMS_PN532_OK;
+        case OP_CLEAN_TAG:      return nfc.cleanTag() == HMS_PN532_OK;
+        default:                return false;
+    }
+}
+
+int main(int argc, char **argv) {
+    const char *timingName = "i2c";
+    uint32_t iterations = 20;
+    std::vector<uint16_t> sizes = { 16, 64, 200 };
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--timing"))           timingName = argv[i + 1];
+        else if (!strcmp(argv[i], "--iterations"))  iterations = (uint32_t)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--sizes")) {
+            sizes.clear();
+            for (char *token = strtok(argv[i + 1], ","); token; token = strtok(nullptr, ",")) sizes.push_back((uint16_t)atoi(token));
+        }
+    }
+
+    HMS_PN532_EmulatorTimingTypeDef timing = HMS_PN532_Interface_Emulator::TIMING_I2C_100K;
+    if (!strcmp(timingName, "none"))        timing = HMS_PN532_Interface_Emulator::TIMING_NONE;
+    else if (!strcmp(timingName, "spi"))    timing = HMS_PN532_Interface_Emulator::TIMING_SPI_1M;
+    else if (!strcmp(timingName, "hsu"))    timing = HMS_PN532_Interface_Emulator::TIMING_HSU_115200;
+
+    HMS_PN532_Interface_Emulator *emulator = new HMS_PN532_Interface_Emulator(timing);                     // HMS_PN532 deletes its interface
+    if (!strcmp(timingName, "spi"))         emulator->setHostLink(HMS_PN532_WAKEUP_SPI);                    // Sets how read() polls for the response
+    else if (!strcmp(timingName, "hsu"))    emulator->setHostLink(HMS_PN532_WAKEUP_HSU);
+    HMS_PN532 nfc(emulator);
+    if (nfc.begin() != HMS_PN532_OK) {
+        fprintf(stderr, "emulated PN532 did not start\n");
+        return 1;
+    }
+
+    static uint8_t classicMemory[1024], classic4kMemory[4096], ultralightMemory[540];                     // MIFARE Classic 1K and 4K, NTAG215
+    const uint8_t classicUid[]    = { 0xDE, 0xAD, 0xBE, 0xEF };
+    const uint8_t classic4kUid[]  = { 0xDE, 0xAD, 0xBE, 0xF0 };
+    const uint8_t ultralightUid[] = { 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+    HMS_PN532_EmulatedCard classic(HMS_PN532_EMULATED_MIFARE_CLASSIC_1K, classicUid, 4, classicMemory, sizeof(classicMemory));
+    HMS_PN532_EmulatedCard classic4k(HMS_PN532_EMULATED_MIFARE_CLASSIC_4K, classic4kUid, 4, classic4kMemory, sizeof(classic4kMemory));
+    HMS_PN532_EmulatedCard ultralight(HMS_PN532_EMULATED_MIFARE_ULTRALIGHT, ultralightUid, 7, ultralightMemory, sizeof(ultralightMemory));
+
+    struct { const char *name; HMS_PN532_EmulatedCard *card; uint8_t *memory; uint32_t size; uint16_t lastDataBlock; } cards[] = {
+        { "classic1k",  &classic,    classicMemory,    sizeof(classicMemory),    62  },  // Sector 15
+        { "classic4k",  &classic4k,  classic4kMemory,  sizeof(classic4kMemory),  254 },  // Sector 39, a long one
+        { "ultralight", &ultralight, ultralightMemory, sizeof(ultralightMemory), 0   },
+    };
+
+    for (auto &entry : cards) {
+        for (uint16_t size : sizes) {
+            HMS_PN532_NDEF_Message message;
+            message.addTextRecord(std::string(size, 'x'));
+
+            entry.card->format();
+            std::vector<uint8_t> transport(entry.memory, entry.memory + entry.size);
+            emulator->insertCard(entry.card);
+
+            OpResult results[OP_COUNT] = {};
+            for (uint32_t iteration = 0; iteration < iterations; iteration++) {
+                for (uint8_t op = 0; op < OP_COUNT; op++) {
+                    if (op == OP_FORMAT_TAG && entry.card->getType() == HMS_PN532_EMULATED_MIFARE_ULTRALIGHT) continue;  // formatTag is Classic only
+
+                    uint32_t commands = emulator->getCommandCount();
+                    uint32_t bytesOut = emulator->getBytesOut();
+                    uint32_t bytesIn  = emulator->getBytesIn();
+                    uint32_t skipped  = nfc.getController()->getSkippedAuthCount();
+                    bool checkClean   = op == OP_CLEAN_TAG && entry.lastDataBlock;
+                    if (checkClean) entry.memory[entry.lastDataBlock * 16] = 0xA5;
+                    uint32_t start    = emulator->pn532Micros();
+
+                    bool ok = runOp(nfc, (BenchmarkOp)op, message);
+                    if (checkClean) ok = ok && !memcmp(entry.memory, transport.data(), entry.size);
+
+                    OpResult &result = results[op];
+                    result.samples.push_back(emulator->pn532Micros() - start);
+                    result.failures     += ok ? 0 : 1;
+                    result.transactions += emulator->getCommandCount() - commands;
+                    result.bytesOut     += emulator->getBytesOut() - bytesOut;
+                    result.bytesIn      += emulator->getBytesIn() - bytesIn;
+                    result.authsSkipped += nfc.getController()->getSkippedAuthCount() - skipped;
+                }
+            }
+
+            for (uint8_t op = 0; op < OP_COUNT; op++) {
+                const OpResult &result = results[op];
+                if (result.samples.empty()) continue;
+
+                uint64_t total = 0;
+                for (uint32_t sample : result.samples) total += sample;
+                size_t n = result.samples.size();
+
+                printf("{\"timing\":\"%s\",\"card\":\"%s\",\"ndef_bytes\":%u,\"op\":\"%s\",\"iterations\":%zu,\"failures\":%u,"
+                       "\"ops_per_sec\":%.1f,\"p50_us\":%u,\"p99_us\":%u,\"transactions\":%.1f,\"bytes_out\":%.1f,\"bytes_in\":%.1f,"
+                       "\"auths_skipped\":%.1f}\n",
+                    timingName, entry.name, size, OP_NAMES[op], n, result.failures,
+                    total ? 1e6 * n / total : 0.0, percentile(result.samples, 50), percentile(result.samples, 99),
+                    (double)result.transactions / n, (double)result.bytesOut / n, (double)result.bytesIn / n,
+                    (double)result.authsSkipped / n);
+            }
+        }
+    }
+
+    return 0;
+}
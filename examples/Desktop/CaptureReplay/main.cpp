@@ -0,0 +1,135 @@
+// Record-then-replay round trip for HMS_PN532_Interface_Recorder and HMS_PN532_Interface_Replay.
+// A session runs against the emulator behind the recorder, then the same session runs again
+// against the capture, once served as fast as possible and once with the recorded timing.
+//
+// Build with the library's CMake option, or by hand from the library root:
+//   cmake -S . -B build -DHMS_PN532_BUILD_BENCHMARK=ON && cmake --build build
+//   g++ -std=c++17 -O2 -Iinclude HMS_PN532_*.cpp examples/Desktop/CaptureReplay/main.cpp -o pn532_capture_replay -lpthread
+// Usage:
+//   pn532_capture_replay [--capture session.cap]
+//
+// One JSON object per line, the recording first:
+//   {"mode":"timed","steps":12,"failures":0,"mismatches":0,"capture_bytes":..,"elapsed_us":..}
+// A replay fails when the host diverges from the capture (mismatches) or when any step returns
+// something other than what it returned while recording (failures). --capture also writes the
+// recording to a file for pn532_capture_summary.
+
+#include <vector>
+#include "HMS_PN532_DRIVER.h"
+#include "HMS_PN532_Interface_Emulator.h"
+#include "HMS_PN532_Interface_Capture.h"
+
+static const uint8_t NTAG215_UID[] = { 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+
+static uint8_t ntag215Memory[540];
+static uint8_t captureMemory[64 * 1024];
+
+typedef std::vector<int32_t> SessionResult;                                     // One entry per step: status, or a checksum of the data read
+
+static int32_t ndefChecksum(const HMS_PN532_NFC_Tag &tag) {
+    if (!tag.hasNdefMessage()) return -1;
+
+    HMS_PN532_NDEF_Message message = tag.getNdefMessage();
+    std::vector<uint8_t> encoded(message.getEncodedSize());
+    message.encode(encoded.data());
+
+    uint32_t sum = (uint32_t)encoded.size();
+    for (uint8_t byte : encoded) sum = sum * 31 + byte;
+    return (int32_t)(sum & 0x7FFFFFFF);
+}
+
+static SessionResult runSession(HMS_PN532 &nfc, HMS_PN532_Interface_Emulator *emulator, HMS_PN532_EmulatedCard *card) {
+    SessionResult result;
+    HMS_PN532_Controller *controller = nfc.getController();
+
+    result.push_back(nfc.begin());
+    result.push_back((int32_t)controller->getFirmwareVersion());
+
+    if (emulator) emulator->insertCard(card);                                   // Replays have no emulator, the capture already holds the card
+    result.push_back(nfc.tagAvailable(100));
+
+    HMS_PN532_NDEF_Message message;
+    message.addTextRecord("record then replay");
+    message.addUriRecord("https://example.com/pn532");
+    result.push_back(nfc.writeTag(message));
+    result.push_back(ndefChecksum(nfc.readTag()));
+
+    uint8_t page[4] = {};
+    result.push_back(controller->mifareultralightReadPage(4, page));
+    result.push_back(page[0] | (page[1] << 8) | (page[2] << 16) | (page[3] << 24));
+
+    result.push_back(nfc.idle());
+    result.push_back(nfc.resume());
+    result.push_back(nfc.tagAvailable(100));
+    result.push_back(ndefChecksum(nfc.readTag()));
+
+    if (emulator) emulator->removeCard();
+    result.push_back(nfc.tagAvailable(50));                                     // Recorded as a failed poll, replayed as one
+    return result;
+}
+
+static void printResult(const char *mode, const SessionResult &result, uint32_t failures, uint32_t mismatches,
+                        uint32_t captureBytes, uint32_t elapsedUs) {
+    printf("{\"mode\":\"%s\",\"steps\":%zu,\"failures\":%u,\"mismatches\":%u,\"capture_bytes\":%u,\"elapsed_us\":%u}\n",
+        mode, result.size(), failures, mismatches, captureBytes, elapsedUs);
+}
+
+int main(int argc, char **argv) {
+    const char *capturePath = nullptr;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--capture")) capturePath = argv[i + 1];
+    }
+
+    HMS_PN532_CaptureBuffer capture(captureMemory, sizeof(captureMemory));
+    HMS_PN532_EmulatedCard card(HMS_PN532_EMULATED_MIFARE_ULTRALIGHT, NTAG215_UID, 7, ntag215Memory, sizeof(ntag215Memory));
+    card.format();
+
+    HMS_PN532_Interface_Emulator emulator(HMS_PN532_Interface_Emulator::TIMING_I2C_100K);
+    emulator.setHostLink(HMS_PN532_WAKEUP_I2C);
+
+    SessionResult recorded;
+    uint32_t recordedUs;
+    {
+        HMS_PN532 nfc(new HMS_PN532_Interface_Recorder(&emulator, &capture));   // HMS_PN532 deletes the recorder, not the emulator behind it
+        uint32_t start = emulator.pn532Micros();
+        recorded   = runSession(nfc, &emulator, &card);
+        recordedUs = emulator.pn532Micros() - start;
+    }
+
+    printResult("record", recorded, 0, 0, capture.length(), recordedUs);
+
+    if (capturePath) {
+        HMS_PN532_CaptureFile file(capturePath, true);
+        if (!file.isOpen() || !file.write(captureMemory, capture.length())) {
+            fprintf(stderr, "could not write %s\n", capturePath);
+            return 1;
+        }
+    }
+
+    static const struct { const char *name; HMS_PN532_ReplayModeTypeDef mode; } modes[] = {
+        { "fast",   HMS_PN532_REPLAY_FAST   },
+        { "timed",  HMS_PN532_REPLAY_TIMED  },
+    };
+
+    int status = 0;
+    for (const auto &mode : modes) {
+        capture.rewind();
+        HMS_PN532_Interface_Replay *replay = new HMS_PN532_Interface_Replay(&capture, mode.mode);   // HMS_PN532 deletes its interface
+        HMS_PN532 nfc(replay);
+
+        uint32_t start = replay->pn532Micros();
+        SessionResult replayed = runSession(nfc, nullptr, nullptr);
+        uint32_t elapsedUs = replay->pn532Micros() - start;
+
+        uint32_t failures = replayed.size() == recorded.size() ? 0 : 1;
+        for (size_t i = 0; i < replayed.size() && i < recorded.size(); i++) {
+            failures += replayed[i] == recorded[i] ? 0 : 1;
+        }
+
+        printResult(mode.name, replayed, failures, replay->getMismatches(), capture.length(), elapsedUs);
+        if (failures || replay->getMismatches() != 0) status = 1;
+    }
+
+    return status;
+}
@@ -0,0 +1,108 @@
+// Summarises per-command latency from a HMS_PN532_Interface_Recorder capture.
+//
+// Build with the library's CMake option (target HMS_PN532_CaptureSummary), or by hand from the library root:
+//   cmake -S . -B build -DHMS_PN532_BUILD_BENCHMARK=ON && cmake --build build
+//   g++ -std=c++17 -Iinclude HMS_PN532_Interface_Capture.cpp examples/Desktop/CaptureSummary/main.cpp -o pn532_capture_summary
+// Usage:
+//   pn532_capture_summary session.cap
+
+#include "HMS_PN532_Interface_Capture.h"
+
+typedef struct {
+    uint32_t    count;
+    uint32_t    failures;
+    uint64_t    bytesOut;
+    uint64_t    bytesIn;
+    uint64_t    ackTotal;                                                       // Write call: frame out + ACK
+    uint32_t    ackMax;
+    uint64_t    responseTotal;                                                  // Write end until the response is read
+    uint32_t    responseMin;
+    uint32_t    responseMax;
+    uint32_t    responses;
+} CommandSummary;
+
+static CommandSummary summary[256];
+
+int main(int argc, char **argv) {
+    if (argc < 2) {
+        printf("usage: %s <capture>\n", argv[0]);
+        return 1;
+    }
+
+    HMS_PN532_CaptureFile capture(argv[1], false);
+    if (!capture.isOpen()) {
+        printf("unable to open %s\n", argv[1]);
+        return 1;
+    }
+
+    HMS_PN532_CaptureRecordTypeDef record;
+    uint8_t  data[HMS_PN532_CAPTURE_DATA_MAX];
+    int16_t  command  = -1;                                                     // Command waiting for its response
+    uint32_t writeEnd = 0;
+    uint32_t sessions = 0, records = 0;
+
+    while (capture.nextRecord(record, data, sizeof(data))) {
+        records++;
+        switch (record.type) {
+            case HMS_PN532_CAPTURE_SESSION:
+                sessions++;
+                command = -1;
+                break;
+
+            case HMS_PN532_CAPTURE_WRITE: {
+                if (!record.len) break;
+                CommandSummary &entry = summary[data[0]];
+                entry.count++;
+                entry.bytesOut += record.len;
+                entry.ackTotal += record.durationUs;
+                if (record.durationUs > entry.ackMax) entry.ackMax = record.durationUs;
+
+                if (record.status == HMS_PN532_OK) {
+                    command  = data[0];
+                    writeEnd = record.timestampUs + record.durationUs;
+                } else {
+                    entry.failures++;
+                    command = -1;
+                }
+                break;
+            }
+
+            case HMS_PN532_CAPTURE_READ: {
+                if (command < 0) break;
+                CommandSummary &entry = summary[command];
+                uint32_t latency = record.timestampUs + record.durationUs - writeEnd;
+
+                if (record.status != HMS_PN532_OK) entry.failures++;
+                entry.bytesIn += record.len;
+                entry.responseTotal += latency;
+                if (!entry.responses || latency < entry.responseMin) entry.responseMin = latency;
+                if (latency > entry.responseMax) entry.responseMax = latency;
+                entry.responses++;
+                command = -1;
+                break;
+            }
+
+            default:
+                break;
+        }
+    }
+
+    printf("%u records in %u session(s)\n\n", records, sessions);
+    printf("cmd   count  fail   out B    in B   ack avg/max us      response min/avg/max us\n");
+    for (int code = 0; code < 256; code++) {
+        const CommandSummary &entry = summary[code];
+        if (!entry.count) continue;
+
+        printf("0x%02X %6u %5u %7llu %7llu %9llu/%-9u",
+            code, entry.count, entry.failures,
+            (unsigned long long)entry.bytesOut, (unsigned long long)entry.bytesIn,
+            (unsigned long long)(entry.ackTotal / entry.count), entry.ackMax);
+        if (entry.responses) {
+            printf(" %9u/%llu/%u", entry.responseMin,
+                (unsigned long long)(entry.responseTotal / entry.responses), entry.responseMax);
+        }
+        printf("\n");
+    }
+
+    return 0;
+}
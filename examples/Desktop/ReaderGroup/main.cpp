@@ -0,0 +1,75 @@
+// Scaling check for HMS_PN532_ReaderGroup, run against HMS_PN532_Interface_Emulator
+// so no readers are needed. Every emulated reader holds a card, so each visit is a
+// full InListPassiveTarget exchange at the chosen bus timing.
+//
+// Build with the library's CMake option (target HMS_PN532_ReaderGroupBenchmark), or by hand from the library root:
+//   cmake -S . -B build -DHMS_PN532_BUILD_BENCHMARK=ON && cmake --build build
+//   g++ -std=c++17 -O2 -Iinclude HMS_PN532_*.cpp examples/Desktop/ReaderGroup/main.cpp -o pn532_readergroup -lpthread
+// Usage:
+//   pn532_readergroup [--timing none|i2c|spi|hsu] [--readers 4] [--seconds 2]
+//
+// One JSON object per line and per bus count; readers are spread evenly over the buses:
+//   {"timing":"i2c","readers":4,"buses":2,"workers":2,"scans":..,"scans_per_sec":..,"events":..}
+
+#include <vector>
+#include "HMS_PN532_ReaderGroup.h"
+#include "HMS_PN532_Interface_Emulator.h"
+
+int main(int argc, char **argv) {
+    const char *timingName = "i2c";
+    uint8_t readerCount = 4;
+    uint32_t seconds = 2;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--timing"))           timingName = argv[i + 1];
+        else if (!strcmp(argv[i], "--readers"))     readerCount = (uint8_t)atoi(argv[i + 1]);
+        else if (!strcmp(argv[i], "--seconds"))     seconds = (uint32_t)atoi(argv[i + 1]);
+    }
+    if (readerCount == 0) readerCount = 1;
+
+    HMS_PN532_EmulatorTimingTypeDef timing = HMS_PN532_Interface_Emulator::TIMING_I2C_100K;
+    if (!strcmp(timingName, "none"))        timing = HMS_PN532_Interface_Emulator::TIMING_NONE;
+    else if (!strcmp(timingName, "spi"))    timing = HMS_PN532_Interface_Emulator::TIMING_SPI_1M;
+    else if (!strcmp(timingName, "hsu"))    timing = HMS_PN532_Interface_Emulator::TIMING_HSU_115200;
+
+    std::vector<uint8_t> memory(readerCount * 540);                                                        // NTAG215 per reader
+    std::vector<HMS_PN532_EmulatedCard> cards;
+    for (uint8_t i = 0; i < readerCount; i++) {
+        const uint8_t uid[] = { 0x04, 0x10, 0x20, 0x30, 0x40, 0x50, i };
+        cards.emplace_back(HMS_PN532_EMULATED_MIFARE_ULTRALIGHT, uid, 7, &memory[i * 540], 540);
+        cards.back().format();
+    }
+
+    for (uint8_t buses = 1; buses <= readerCount; buses *= 2) {
+        HMS_PN532_ReaderGroupConfigTypeDef config = HMS_PN532_ReaderGroup::DEFAULT_CONFIG;
+        config.workers  = buses;
+        config.readNdef = false;
+
+        HMS_PN532_ReaderGroup group(config);
+        for (uint8_t i = 0; i < readerCount; i++) {
+            HMS_PN532_Interface_Emulator *emulator = new HMS_PN532_Interface_Emulator(timing);           // The group deletes its readers
+            emulator->insertCard(&cards[i]);
+            group.addReader(emulator, i % buses);
+        }
+
+        if (group.start() != HMS_PN532_OK) {
+            fprintf(stderr, "reader group did not start\n");
+            return 1;
+        }
+
+        std::this_thread::sleep_for(std::chrono::milliseconds(200));                                         // Let every reader run begin()
+        uint32_t start = group.getScanCount();
+        std::this_thread::sleep_for(std::chrono::seconds(seconds));
+        uint32_t scans = group.getScanCount() - start;
+        group.stop();
+
+        uint32_t events = 0;
+        HMS_PN532_TagEventTypeDef event;
+        while (group.pollEvent(event)) events++;
+
+        printf("{\"timing\":\"%s\",\"readers\":%u,\"buses\":%u,\"workers\":%u,\"scans\":%u,\"scans_per_sec\":%.1f,\"events\":%u}\n",
+            timingName, readerCount, buses, config.workers, scans, (double)scans / seconds, events);
+    }
+
+    return 0;
+}
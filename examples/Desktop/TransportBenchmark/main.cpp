@@ -0,0 +1,828 @@
+// Transport-level benchmarks for HMS_PN532: how the host side waits for, frames and moves
+// PN532 responses. Everything runs in-process against HMS_PN532_Interface_Emulator.
+//
+// Build with the library's CMake option, or by hand from the library root:
+//   cmake -S . -B build -DHMS_PN532_BUILD_BENCHMARK=ON && cmake --build build
+//   g++ -std=c++17 -O2 -DHMS_PN532_COUNT_COPIES=1 -DHMS_PN532_METRICS_ENABLED=1 -Iinclude HMS_PN532_*.cpp examples/Desktop/TransportBenchmark/main.cpp -o pn532_transport -lpthread
+// Usage:
+//   pn532_transport --case ready|i2c|spi|uart|encode|extended|copies|metrics [--iterations N]
+//
+// One JSON object per line and per measurement:
+//   ready  {"case":"ready","link":"i2c","mode":"irq","op":"readPage","iterations":200,"p50_us":..,"p90_us":..,"p99_us":..,"max_us":..}
+//          Command latency with the transport polling the status byte every millisecond ("polling")
+//          against sleeping on the emulated IRQ line ("irq").
+//   i2c    {"case":"i2c","op":"fastRead","iterations":..,"failures":0,"frames_per_sec":..,"bytes_per_sec":..,"bus_transfers_per_frame":..,"bus_bytes_per_frame":..}
+//          HMS_PN532_Interface_I2C, Linux backend, over a fake bus that answers like the chip. Measures the host side only:
+//          the emulated PN532 behind it runs with TIMING_NONE. frames_per_sec counts command frames.
+//   spi    Same for HMS_PN532_Interface_SPI, Linux backend, against a fake device speaking the DW/SR/DR protocol.
+//   uart   HMS_PN532_Interface_UART on a pseudo-terminal, a simulated PN532 on the other end paces the bytes at the
+//          negotiated rate. One set of lines at 115200 baud and one after SetSerialBaudRate to HMS_PN532_UART_HIGH_BAUDRATE.
+//   encode {"case":"encode","payload_bytes":265,"segments":2,"iterations":..,"frames_per_sec":..,"mb_per_sec":..}
+//          HMS_PN532_Interface::encodeFrame() alone, payload split over 1 or 2 scatter-gather segments.
+//   extended {"case":"extended","max_info":265,"op":"fastRead65","iterations":..,"failures":0,"frames_per_op":..,"p50_us":..,"p99_us":..}
+//          NTAG216 reads through the I2C-timed emulator with extended frames (265) and with the link held to
+//          normal frames (255). Every read is compared with the card image; frames_per_op counts commands.
+//   copies {"case":"copies","op":"readPagesView","iterations":..,"failures":0,"payload_bytes":16,"copied_per_op":0.0}
+//          Bytes the controller copies out of its packet buffer per read (HMS_PN532_COUNT_COPIES). View overloads
+//          must copy nothing and buffer overloads the payload exactly once; anything else counts as a failure.
+//   metrics {"case":"metrics","mode":"irq","command":"0x02","count":..,"bytes_out":..,"bytes_in":..,"response_timeouts":0,"ack_p50_us":..,"ready_p50_us":..,"transfer_p50_us":..,"failures":0}
+//          Controller counters (HMS_PN532_METRICS_ENABLED) after N firmware reads and page reads plus one
+//          InListPassiveTarget timeout, polling and IRQ. p50 values are histogram bucket lower bounds. Every phase
+//          histogram must account for every command, and the ready wait must cover the emulated processing time.
+
+#include <vector>
+#include <atomic>
+#include <algorithm>
+#include <poll.h>
+#include <fcntl.h>
+#include <unistd.h>
+#include <termios.h>
+#include "HMS_PN532_DRIVER.h"
+#include "HMS_PN532_Interface_Emulator.h"
+#include "HMS_PN532_Interface_I2C.h"
+#include "HMS_PN532_Interface_SPI.h"
+#include "HMS_PN532_Interface_UART.h"
+
+static const uint8_t ACK_FRAME[]  = { 0x00, 0x00, 0xFF, 0x00, 0xFF, 0x00 };
+static const uint8_t NACK_FRAME[] = { 0x00, 0x00, 0xFF, 0xFF, 0x00, 0x00 };
+
+class FrameCodec : public HMS_PN532_Interface {                                // The frame helpers are protected, only transports call them
+    public:
+        using HMS_PN532_Interface::encodeFrame;
+        using HMS_PN532_Interface::frameLength;
+        using HMS_PN532_Interface::frameHeaderLength;
+};
+
+static uint32_t percentile(std::vector<uint32_t> samples, uint8_t p) {
+    if (samples.empty()) return 0;
+    std::sort(samples.begin(), samples.end());
+    return samples[(samples.size() - 1) * p / 100];
+}
+
+static void printLatency(const char *link, const char *mode, const char *op, const std::vector<uint32_t> &samples) {
+    printf("{\"case\":\"ready\",\"link\":\"%s\",\"mode\":\"%s\",\"op\":\"%s\",\"iterations\":%zu,"
+           "\"p50_us\":%u,\"p90_us\":%u,\"p99_us\":%u,\"max_us\":%u}\n",
+        link, mode, op, samples.size(),
+        percentile(samples, 50), percentile(samples, 90), percentile(samples, 99), percentile(samples, 100));
+}
+
+typedef struct {
+    const char  *name;
+    bool        (*run)(HMS_PN532_Controller *controller);
+} TransportOp;
+
+static bool opFirmware(HMS_PN532_Controller *controller) {
+    return controller->getFirmwareVersion() == 0x32010607;
+}
+
+static bool opReadPage(HMS_PN532_Controller *controller) {                      // 16-byte response, fits the speculative I2C read
+    uint8_t buffer[4];
+    return controller->mifareultralightReadPage(4, buffer) == HMS_PN532_OK;
+}
+
+static bool opFastRead(HMS_PN532_Controller *controller) {                      // 65 pages, one extended frame
+    static uint8_t buffer[65 * 4];
+    return controller->ntagFastRead(4, 68, buffer, sizeof(buffer)) == HMS_PN532_OK;
+}
+
+static const TransportOp TRANSPORT_OPS[] = {
+    { "getFirmwareVersion", opFirmware  },
+    { "readPage",           opReadPage  },
+    { "fastRead",           opFastRead  },
+};
+
+static uint8_t ntag216Memory[924];
+static const uint8_t NTAG216_UID[] = { 0x04, 0x21, 0x32, 0x43, 0x54, 0x65, 0x76 };
+
+// Commands per second through one host transport. device is the emulator behind it, transfers
+// the link's own count of bus transactions, busBytes (optional) the bytes clocked over the bus,
+// extra more JSON fields for the line.
+static void measureThroughput(
+    const char *caseName, const char *extra, HMS_PN532 &nfc, HMS_PN532_Interface_Emulator &device,
+    const std::atomic<uint32_t> &transfers, const std::atomic<uint32_t> *busBytes, uint32_t iterations
+) {
+    HMS_PN532_Controller *controller = nfc.getController();
+
+    for (const TransportOp &op : TRANSPORT_OPS) {
+        uint32_t commands   = device.getCommandCount();
+        uint32_t bytes      = device.getBytesOut() + device.getBytesIn();
+        uint32_t bus        = transfers;
+        uint32_t clocked    = busBytes ? busBytes->load() : 0;
+        uint32_t failures   = 0;
+        uint32_t start      = device.pn532Micros();
+
+        for (uint32_t i = 0; i < iterations; i++) failures += op.run(controller) ? 0 : 1;
+
+        double seconds = (device.pn532Micros() - start) / 1e6;
+        commands = device.getCommandCount() - commands;
+        bytes    = device.getBytesOut() + device.getBytesIn() - bytes;
+        bus      = transfers - bus;
+        clocked  = busBytes ? busBytes->load() - clocked : 0;
+
+        printf("{\"case\":\"%s\"%s,\"op\":\"%s\",\"iterations\":%u,\"failures\":%u,\"frames_per_sec\":%.0f,\"bytes_per_sec\":%.0f,"
+               "\"bus_transfers_per_frame\":%.2f",
+            caseName, extra, op.name, iterations, failures, seconds > 0 ? commands / seconds : 0.0, seconds > 0 ? bytes / seconds : 0.0,
+            commands ? (double)bus / commands : 0.0);
+        if (busBytes) printf(",\"bus_bytes_per_frame\":%.1f", commands ? (double)clocked / commands : 0.0);
+        printf("}\n");
+    }
+}
+
+// What the PN532 holds for the host on a byte-level link: the ACK after a frame is written, then the
+// response once the emulator has it ready. A NACK asks for the last frame again, an ACK aborts.
+class FakePN532Port {
+    public:
+        FakePN532Port(HMS_PN532_Interface_Emulator &device) : device(device) {}
+
+        void hostWrite(const uint8_t *data, uint16_t len) {
+            if (len == sizeof(NACK_FRAME) && !memcmp(data, NACK_FRAME, len)) {
+                held = heldLen > 0;
+                return;
+            }
+
+            held = false;
+            if (len == sizeof(ACK_FRAME) && !memcmp(data, ACK_FRAME, len)) return;
+            if (device.writeRawFrame(data, len) != HMS_PN532_OK) return;          // The chip ignores a bad frame, the ACK wait times out
+
+            memcpy(frame, ACK_FRAME, sizeof(ACK_FRAME));
+            heldLen = sizeof(ACK_FRAME);
+            held    = true;
+        }
+
+        bool ready() {
+            if (!held && device.isResponseReady() && device.readRawFrame(frame, sizeof(frame), heldLen, 0) == HMS_PN532_OK) held = true;
+            return held;
+        }
+
+        void hostRead(uint8_t *data, uint16_t len) {                             // Clocks out the held frame, the rest of it is lost
+            if (!ready()) return;
+            memcpy(data, frame, len < heldLen ? len : heldLen);
+            held = false;
+        }
+
+    private:
+        HMS_PN532_Interface_Emulator    &device;
+        uint8_t                         frame[HMS_PN532_FRAME_MAX_LEN];
+        uint16_t                        heldLen = 0;
+        bool                            held = false;
+};
+
+// I2C: a write carries one frame, every read returns the status byte followed by the held frame.
+class FakeI2CBus : public HMS_PN532_Interface_I2C {
+    public:
+        FakeI2CBus(HMS_PN532_Interface_Emulator &device) : HMS_PN532_Interface_I2C("fake-i2c"), device(device), port(device) {}
+
+        HMS_PN532_StatusTypeDef init() override         { return device.init(); }
+
+        std::atomic<uint32_t> transfers { 0 };
+        std::atomic<uint32_t> busBytes  { 0 };                                  // Status polls and frames, both ways
+
+    protected:
+        HMS_PN532_StatusTypeDef busWrite(const uint8_t *data, uint16_t len) override {
+            transfers++;
+            busBytes += len;
+            port.hostWrite(data, len);
+            return HMS_PN532_OK;
+        }
+
+        HMS_PN532_StatusTypeDef busRead(uint8_t *data, uint16_t len) override {
+            transfers++;
+            busBytes += len;
+            memset(data, 0, len);
+            if (!port.ready()) return HMS_PN532_OK;                                // Status 0x00: busy
+
+            data[0] = 0x01;
+            if (len > 1) port.hostRead(data + 1, len - 1);                      // A status-only read leaves the frame in place
+            return HMS_PN532_OK;
+        }
+
+    private:
+        HMS_PN532_Interface_Emulator    &device;
+        FakePN532Port                   port;
+};
+
+// SPI: the first byte of every transfer selects data write, status read or data read.
+class FakeSPIDevice : public HMS_PN532_Interface_SPI {
+    public:
+        FakeSPIDevice(HMS_PN532_Interface_Emulator &device) : HMS_PN532_Interface_SPI("fake-spi"), device(device), port(device) {}
+
+        HMS_PN532_StatusTypeDef init() override         { return device.init(); }
+
+        std::atomic<uint32_t> transfers { 0 };
+        std::atomic<uint32_t> busBytes  { 0 };
+
+    protected:
+        HMS_PN532_StatusTypeDef transfer(const uint8_t *tx, uint8_t *rx, uint16_t len) override {
+            transfers++;
+            busBytes += len;
+            if (rx) memset(rx, 0, len);
+            if (len < 2) return HMS_PN532_OK;
+
+            switch (tx[0]) {
+                case HMS_PN532_SPI_DATAWRITE:   port.hostWrite(tx + 1, len - 1);                                    break;
+                case HMS_PN532_SPI_STATREAD:    if (rx) rx[1] = port.ready() ? HMS_PN532_SPI_READY : 0x00;          break;
+                case HMS_PN532_SPI_DATAREAD:    if (rx) port.hostRead(rx + 1, len - 1);                             break;
+                default:                                                                                            break;
+            }
+            return HMS_PN532_OK;
+        }
+
+    private:
+        HMS_PN532_Interface_Emulator    &device;
+        FakePN532Port                   port;
+};
+
+// HSU: a simulated PN532 on the master side of a pseudo-terminal, HMS_PN532_Interface_UART opens the
+// slave. Bytes are paced at the negotiated rate, SetSerialBaudRate takes effect on the host's ACK.
+class SimulatedHSU {
+    public:
+        SimulatedHSU(HMS_PN532_Interface_Emulator &device) : device(device) {}
+        ~SimulatedHSU() { stop(); }
+
+        bool start() {
+            master = posix_openpt(O_RDWR | O_NOCTTY);
+            if (master < 0 || grantpt(master) != 0 || unlockpt(master) != 0) return false;
+
+            slave = open(ptsname(master), O_RDWR | O_NOCTTY);                   // Held open so the master never sees a hang-up
+            if (slave < 0) return false;
+
+            struct termios tio;
+            tcgetattr(slave, &tio);
+            cfmakeraw(&tio);
+            tcsetattr(slave, TCSANOW, &tio);
+
+            running = true;
+            worker  = std::thread(&SimulatedHSU::run, this);
+            return true;
+        }
+
+        void stop() {
+            running = false;
+            if (worker.joinable()) worker.join();
+            if (slave >= 0) close(slave);
+            if (master >= 0) close(master);
+            slave = master = -1;
+        }
+
+        const char *path()                              { return ptsname(master);   }
+        uint32_t getBaudRate() const                    { return baudrate;          }
+
+        std::atomic<uint32_t> transfers { 0 };                                              // Frames on the wire, both ways
+
+    private:
+        HMS_PN532_Interface_Emulator    &device;
+        std::thread                     worker;
+        std::atomic<bool>               running { false };
+        int                             master = -1;
+        int                             slave = -1;
+        std::atomic<uint32_t>           baudrate { 115200 };
+        uint32_t                        pendingBaudrate = 0;
+        uint8_t                         rx[4 * HMS_PN532_FRAME_MAX_LEN];
+        uint16_t                        rxLen = 0;
+        uint8_t                         response[HMS_PN532_FRAME_MAX_LEN];
+        uint16_t                        responseLen = 0;
+
+        void pace(uint16_t bytes) {                                             // 8N1: ten bit times per byte
+            std::this_thread::sleep_for(std::chrono::microseconds((uint64_t)bytes * 10000000 / baudrate));
+        }
+
+        void send(const uint8_t *data, uint16_t len) {
+            pace(len);
+            if (::write(master, data, len) != (ssize_t)len) return;
+            transfers++;
+        }
+
+        void run() {
+            while (running) {
+                struct pollfd pfd = { master, POLLIN, 0 };
+                if (poll(&pfd, 1, 20) <= 0) continue;
+
+                ssize_t n = ::read(master, rx + rxLen, sizeof(rx) - rxLen);
+                if (n <= 0) continue;
+                rxLen += n;
+
+                uint16_t used;
+                while ((used = handle()) > 0) {
+                    memmove(rx, rx + used, rxLen - used);
+                    rxLen -= used;
+                }
+                if (rxLen == sizeof(rx)) rxLen = 0;                             // Garbage only, start over
+            }
+        }
+
+        uint16_t handle() {                                                     // Bytes consumed from rx, 0 until a whole frame is in
+            uint16_t start = 0;
+            while (start + 3 <= rxLen && !(rx[start] == 0x00 && rx[start + 1] == 0x00 && rx[start + 2] == 0xFF)) start++;
+            if (start + 6 > rxLen) return start > 3 ? start - 3 : 0;           // Drops the wake-up preamble, keeps a possible split start code
+
+            const uint8_t *frame = rx + start;
+            if (!memcmp(frame, ACK_FRAME, sizeof(ACK_FRAME)) || !memcmp(frame, NACK_FRAME, sizeof(NACK_FRAME))) {
+                pace(sizeof(ACK_FRAME));
+                transfers++;
+                if (frame[3] == 0xFF) {
+                    if (responseLen) send(response, responseLen);               // NACK: send the last response again
+                } else if (pendingBaudrate) {
+                    baudrate        = pendingBaudrate;                          // ACK after SetSerialBaudRate: switch now
+                    pendingBaudrate = 0;
+                }
+                return start + sizeof(ACK_FRAME);
+            }
+
+            if (rxLen - start < 8) return 0;
+            uint16_t frameLen = FrameCodec::frameLength(frame);
+            if (frameLen == 0) return start + 1;
+            if (rxLen - start < frameLen) return 0;
+
+            pace(frameLen);                                                     // The frame was still arriving
+            transfers++;
+            if (device.writeRawFrame(frame, frameLen) != HMS_PN532_OK) return start + frameLen;
+
+            uint8_t command = frame[FrameCodec::frameHeaderLength(frame) + 1];
+            send(ACK_FRAME, sizeof(ACK_FRAME));
+            if (device.readRawFrame(response, sizeof(response), responseLen, 1000) != HMS_PN532_OK) {
+                responseLen = 0;
+                return start + frameLen;
+            }
+
+            static const uint32_t BAUDRATES[] = { 9600, 19200, 38400, 57600, 115200, 230400, 460800, 921600, 1288000 };
+            if (command == HMS_PN532_COMMAND_SETSERIALBAUDRATE) pendingBaudrate = BAUDRATES[frame[FrameCodec::frameHeaderLength(frame) + 2]];
+
+            send(response, responseLen);
+            return start + frameLen;
+        }
+};
+
+static int runUART(uint32_t iterations) {
+    HMS_PN532_Interface_Emulator device(HMS_PN532_Interface_Emulator::TIMING_NONE);              // Only the pty link's pacing is timed
+    device.setHostLink(HMS_PN532_WAKEUP_HSU);
+    HMS_PN532_EmulatedCard card(HMS_PN532_EMULATED_MIFARE_ULTRALIGHT, NTAG216_UID, 7, ntag216Memory, sizeof(ntag216Memory));
+    card.format();
+    device.insertCard(&card);                                                   // Before the simulator thread owns the emulator
+
+    SimulatedHSU pn532(device);
+    if (!pn532.start()) {
+        fprintf(stderr, "no pseudo-terminal for the simulated PN532\n");
+        return 1;
+    }
+
+    HMS_PN532_Interface_UART *uart = new HMS_PN532_Interface_UART(pn532.path(), 115200);     // HMS_PN532 deletes its interface
+    HMS_PN532 nfc(uart);
+    if (nfc.begin() != HMS_PN532_OK) {                                                      // Wakes it up and escalates to HMS_PN532_UART_HIGH_BAUDRATE
+        fprintf(stderr, "PN532 on %s did not start\n", pn532.path());
+        return 1;
+    }
+
+    if (nfc.tagAvailable(100) != HMS_PN532_OK) {
+        fprintf(stderr, "no tag selected over the pseudo-terminal\n");
+        return 1;
+    }
+
+    static const uint32_t rates[] = { 115200, HMS_PN532_UART_HIGH_BAUDRATE };              // Before and after escalation
+    for (uint32_t rate : rates) {
+        if (uart->setBaudRate(rate) != HMS_PN532_OK || pn532.getBaudRate() != rate) {
+            fprintf(stderr, "SetSerialBaudRate to %u failed\n", rate);
+            return 1;
+        }
+
+        char extra[32];
+        snprintf(extra, sizeof(extra), ",\"baud\":%u", rate);
+        measureThroughput("uart", extra, nfc, device, pn532.transfers, nullptr, iterations);
+    }
+
+    return 0;
+}
+
+// Brings up HMS_PN532 on a fake link to an untimed emulator, selects an NTAG216 and measures it.
+template <typename FakeLink>
+static int runFakeLink(const char *caseName, uint32_t iterations) {
+    HMS_PN532_Interface_Emulator device(HMS_PN532_Interface_Emulator::TIMING_NONE);
+    HMS_PN532_EmulatedCard card(HMS_PN532_EMULATED_MIFARE_ULTRALIGHT, NTAG216_UID, 7, ntag216Memory, sizeof(ntag216Memory));
+    card.format();
+
+    FakeLink *link = new FakeLink(device);                                      // HMS_PN532 deletes its interface
+    HMS_PN532 nfc(link);
+    if (nfc.begin() != HMS_PN532_OK) {
+        fprintf(stderr, "PN532 on the fake %s link did not start\n", caseName);
+        return 1;
+    }
+
+    device.insertCard(&card);
+    if (nfc.tagAvailable(100) != HMS_PN532_OK) {
+        fprintf(stderr, "no tag selected over the fake %s link\n", caseName);
+        return 1;
+    }
+
+    measureThroughput(caseName, "", nfc, device, link->transfers, &link->busBytes, iterations);
+    return 0;
+}
+
+static int runI2C(uint32_t iterations)                  { return runFakeLink<FakeI2CBus>("i2c", iterations);       }
+static int runSPI(uint32_t iterations)                  { return runFakeLink<FakeSPIDevice>("spi", iterations);    }
+
+static int runEncode(uint32_t iterations) {
+    static const uint16_t payloads[] = { 16, 64, 255, 265 };                    // TFI + PD bytes; the last one needs an extended frame
+    static uint8_t body[HMS_PN532_EXTENDED_INFO_MAX];
+    static uint8_t frame[HMS_PN532_FRAME_MAX_LEN];
+    uint32_t loops = iterations * 1000;
+    volatile uint16_t sink = 0;                                                 // Keeps the encode from being optimised out
+
+    for (uint16_t i = 0; i < sizeof(body); i++) body[i] = (uint8_t)(i * 7);
+
+    for (uint16_t payload : payloads) {
+        if (payload > HMS_PN532_EXTENDED_INFO_MAX || (!HMS_PN532_EXTENDED_FRAMES && payload > HMS_PN532_NORMAL_INFO_MAX)) continue;
+
+        for (uint8_t segments = 1; segments <= 2; segments++) {
+            uint16_t dataLen = payload - 1;                                     // The TFI is added by encodeFrame()
+            const HMS_PN532_SegmentTypeDef split[] = {
+                { body, (uint16_t)(segments == 1 ? dataLen : 2) },              // tgSetData-style header + body
+                { body + 2, (uint16_t)(dataLen - 2) },
+            };
+
+            uint16_t frameLen = FrameCodec::encodeFrame(frame, split, segments);
+            auto start = std::chrono::steady_clock::now();
+            for (uint32_t i = 0; i < loops; i++) {
+                body[0] = (uint8_t)i;
+                sink += FrameCodec::encodeFrame(frame, split, segments);
+            }
+            double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+            printf("{\"case\":\"encode\",\"payload_bytes\":%u,\"segments\":%u,\"iterations\":%u,\"frames_per_sec\":%.0f,\"mb_per_sec\":%.1f}\n",
+                payload, segments, loops, loops / seconds, (double)loops * frameLen / seconds / 1e6);
+        }
+    }
+
+    return 0;
+}
+
+static int runExtended(uint32_t iterations) {
+    static const uint16_t limits[] = { HMS_PN532_EXTENDED_INFO_MAX, HMS_PN532_NORMAL_INFO_MAX };
+    static uint8_t dump[924];
+
+    for (uint16_t limit : limits) {
+        if (!HMS_PN532_EXTENDED_FRAMES && limit > HMS_PN532_NORMAL_INFO_MAX) continue;
+
+        HMS_PN532_Interface_Emulator *emulator = new HMS_PN532_Interface_Emulator(HMS_PN532_Interface_Emulator::TIMING_I2C_100K);   // HMS_PN532 deletes its interface
+        emulator->setMaxInformationLength(limit);
+        HMS_PN532 nfc(emulator);
+        if (nfc.begin() != HMS_PN532_OK) {
+            fprintf(stderr, "emulated PN532 did not start\n");
+            return 1;
+        }
+
+        HMS_PN532_EmulatedCard card(HMS_PN532_EMULATED_MIFARE_ULTRALIGHT, NTAG216_UID, 7, ntag216Memory, sizeof(ntag216Memory));
+        card.format();
+        emulator->insertCard(&card);
+
+        HMS_PN532_NDEF_Message message;
+        std::string text(800, 'x');
+        for (size_t i = 0; i < text.size(); i++) text[i] = (char)('a' + i % 26);
+        message.addTextRecord(text);
+        if (nfc.tagAvailable(100) != HMS_PN532_OK || nfc.writeTag(message) != HMS_PN532_OK) {
+            fprintf(stderr, "could not write the NTAG216\n");
+            return 1;
+        }
+
+        uint8_t expected[1024];
+        uint16_t encodedLen = (uint16_t)message.getEncodedSize();
+        message.encode(expected);
+
+        HMS_PN532_Controller *controller = nfc.getController();
+        static const struct { const char *name; uint8_t first; uint8_t last; } reads[] = {
+            { "fastRead65",     4, 68   },                                      // 262-byte response: one extended frame or two normal ones
+            { "fastReadAll",    0, 230  },                                      // The whole 924-byte image
+            { "readTag",        0, 0    },                                      // 800-character text record, NDEF parse included
+        };
+
+        for (const auto &read : reads) {
+            std::vector<uint32_t> samples;
+            uint32_t failures = 0;
+            uint32_t commands = emulator->getCommandCount();
+
+            for (uint32_t i = 0; i < iterations; i++) {
+                uint32_t start = emulator->pn532Micros();
+                bool ok;
+
+                if (read.last) {
+                    uint16_t bytes = (uint16_t)(read.last - read.first + 1) * 4;
+                    ok = controller->ntagFastRead(read.first, read.last, dump, bytes) == HMS_PN532_OK
+                        && !memcmp(dump, &ntag216Memory[read.first * 4], bytes);                    // Round trip: what the card holds
+                } else {
+                    HMS_PN532_NDEF_Message readBack = nfc.readTag().getNdefMessage();
+                    uint8_t encoded[1024];
+                    ok = readBack.getEncodedSize() == encodedLen;
+                    if (ok) {
+                        readBack.encode(encoded);
+                        ok = !memcmp(encoded, expected, encodedLen);
+                    }
+                }
+
+                samples.push_back(emulator->pn532Micros() - start);
+                failures += ok ? 0 : 1;
+            }
+
+            commands = emulator->getCommandCount() - commands;
+            printf("{\"case\":\"extended\",\"max_info\":%u,\"op\":\"%s\",\"iterations\":%u,\"failures\":%u,"
+                   "\"frames_per_op\":%.1f,\"p50_us\":%u,\"p99_us\":%u}\n",
+                limit, read.name, iterations, failures, (double)commands / iterations,
+                percentile(samples, 50), percentile(samples, 99));
+        }
+    }
+
+    return 0;
+}
+
+typedef struct {
+    const char  *name;
+    uint16_t    payload;                                                        // Bytes the caller gets back
+    bool        view;                                                           // Borrowed from the packet buffer, nothing copied
+    bool        (*run)(HMS_PN532_Controller *controller);
+} CopyOp;
+
+static const uint8_t RAW_FAST_READ_PAGES   = ((HMS_PN532_PACKET_BUFFER_LEN - 1) / 4 < 65) ? (HMS_PN532_PACKET_BUFFER_LEN - 1) / 4 : 65;   // Status byte + pages in the packet buffer
+static const uint8_t NTAG_READ_PAGE4[]      = { HMS_PN532_MIFARE_CMD_READ, 4 };
+static const uint8_t NTAG_FAST_READ[]       = { HMS_PN532_NTAG_CMD_FAST_READ, 4, (uint8_t)(4 + RAW_FAST_READ_PAGES - 1) };
+
+static bool copyReadPagesView(HMS_PN532_Controller *controller) {
+    HMS_PN532_ResponseView view;
+    return controller->mifareultralightReadPages(4, view) == HMS_PN532_OK
+        && view.size() == 16 && !memcmp(view.data(), &ntag216Memory[16], 16);
+}
+
+static bool copyReadPagesBuffer(HMS_PN532_Controller *controller) {
+    uint8_t buffer[16];
+    return controller->mifareultralightReadPages(4, buffer) == HMS_PN532_OK && !memcmp(buffer, &ntag216Memory[16], 16);
+}
+
+static bool copyDataExchangeView(HMS_PN532_Controller *controller) {
+    HMS_PN532_ResponseView view;
+    return controller->inDataExchange(NTAG_READ_PAGE4, sizeof(NTAG_READ_PAGE4), view) == HMS_PN532_OK
+        && view.size() == 16 && !memcmp(view.data(), &ntag216Memory[16], 16);
+}
+
+static bool copyDataExchangeBuffer(HMS_PN532_Controller *controller) {
+    uint8_t  command[sizeof(NTAG_READ_PAGE4)];
+    uint8_t  buffer[16];
+    uint16_t received = sizeof(buffer);
+    memcpy(command, NTAG_READ_PAGE4, sizeof(command));                          // The buffer overload takes a non-const request
+    return controller->inDataExchange(command, (uint16_t)sizeof(command), buffer, &received) == HMS_PN532_OK
+        && received == 16 && !memcmp(buffer, &ntag216Memory[16], 16);
+}
+
+static bool copyCommunicateThruView(HMS_PN532_Controller *controller) {
+    HMS_PN532_ResponseView view;
+    return controller->inCommunicateThru(NTAG_FAST_READ, sizeof(NTAG_FAST_READ), view) == HMS_PN532_OK
+        && view.size() == RAW_FAST_READ_PAGES * 4 && !memcmp(view.data(), &ntag216Memory[16], RAW_FAST_READ_PAGES * 4);
+}
+
+static bool copyFastRead(HMS_PN532_Controller *controller) {
+    uint8_t buffer[65 * 4];
+    return controller->ntagFastRead(4, 68, buffer, sizeof(buffer)) == HMS_PN532_OK && !memcmp(buffer, &ntag216Memory[16], sizeof(buffer));
+}
+
+static bool copyGetVersion(HMS_PN532_Controller *controller) {
+    uint8_t version[8];
+    return controller->ntagGetVersion(version) == HMS_PN532_OK;
+}
+
+static int runCopies(uint32_t iterations) {
+#if HMS_PN532_COUNT_COPIES
+    static const CopyOp ops[] = {
+        { "readPagesView",         16,                       true,   copyReadPagesView       },
+        { "readPagesBuffer",       16,                       false,  copyReadPagesBuffer     },
+        { "inDataExchangeView",    16,                       true,   copyDataExchangeView    },
+        { "inDataExchangeBuffer",  16,                       false,  copyDataExchangeBuffer  },
+        { "inCommunicateThruView", RAW_FAST_READ_PAGES * 4,  true,   copyCommunicateThruView },
+        { "ntagFastRead",          65 * 4,                   false,  copyFastRead            },
+        { "ntagGetVersion",        8,                        false,  copyGetVersion          },
+    };
+
+    HMS_PN532_Interface_Emulator *emulator = new HMS_PN532_Interface_Emulator(HMS_PN532_Interface_Emulator::TIMING_NONE);   // HMS_PN532 deletes its interface
+    HMS_PN532 nfc(emulator);
+    if (nfc.begin() != HMS_PN532_OK) {
+        fprintf(stderr, "emulated PN532 did not start\n");
+        return 1;
+    }
+
+    HMS_PN532_EmulatedCard card(HMS_PN532_EMULATED_MIFARE_ULTRALIGHT, NTAG216_UID, 7, ntag216Memory, sizeof(ntag216Memory));
+    card.format();
+    emulator->insertCard(&card);
+    if (nfc.tagAvailable(100) != HMS_PN532_OK) {
+        fprintf(stderr, "no tag selected\n");
+        return 1;
+    }
+
+    HMS_PN532_Controller *controller = nfc.getController();
+    int result = 0;
+
+    for (const CopyOp &op : ops) {
+        uint32_t failures = 0;
+        uint32_t copied   = 0;
+
+        for (uint32_t i = 0; i < iterations; i++) {
+            uint32_t before = HMS_PN532_ResponseView::copiedBytes();
+            bool ok = op.run(controller);
+            uint32_t bytes = HMS_PN532_ResponseView::copiedBytes() - before;
+
+            copied   += bytes;
+            failures += (ok && bytes == (op.view ? 0 : op.payload)) ? 0 : 1;
+        }
+
+        printf("{\"case\":\"copies\",\"op\":\"%s\",\"iterations\":%u,\"failures\":%u,\"payload_bytes\":%u,\"copied_per_op\":%.1f}\n",
+            op.name, iterations, failures, op.payload, iterations ? (double)copied / iterations : 0.0);
+        if (failures) result = 1;
+    }
+
+    return result;
+#else
+    (void)iterations;
+    fprintf(stderr, "the copies case needs -DHMS_PN532_COUNT_COPIES=1\n");
+    return 2;
+#endif
+}
+
+#if HMS_PN532_METRICS_ENABLED
+static uint32_t bucketTotal(const uint32_t *histogram) {
+    uint32_t total = 0;
+    for (uint8_t i = 0; i < HMS_PN532_METRICS_BUCKETS; i++) total += histogram[i];
+    return total;
+}
+
+static uint32_t bucketMedian(const uint32_t *histogram) {                     // Lower bound of the bucket holding the median sample
+    uint32_t total = bucketTotal(histogram), seen = 0;
+    for (uint8_t i = 0; i < HMS_PN532_METRICS_BUCKETS; i++) {
+        seen += histogram[i];
+        if (total && seen * 2 >= total) return 1u << i;
+    }
+    return 0;
+}
+#endif
+
+static int runMetrics(uint32_t iterations) {
+#if HMS_PN532_METRICS_ENABLED
+    const HMS_PN532_EmulatorTimingTypeDef &timing = HMS_PN532_Interface_Emulator::TIMING_I2C_100K;
+    int result = 0;
+
+    for (uint8_t irq = 0; irq < 2; irq++) {
+        HMS_PN532_Interface_Emulator *emulator = new HMS_PN532_Interface_Emulator(timing);   // HMS_PN532 deletes its interface
+        emulator->enableReadyEvent(irq);
+
+        HMS_PN532 nfc(emulator);
+        if (nfc.begin() != HMS_PN532_OK) {
+            fprintf(stderr, "emulated PN532 did not start\n");
+            return 1;
+        }
+
+        HMS_PN532_EmulatedCard card(HMS_PN532_EMULATED_MIFARE_ULTRALIGHT, NTAG216_UID, 7, ntag216Memory, sizeof(ntag216Memory));
+        card.format();
+        emulator->insertCard(&card);
+        if (nfc.tagAvailable(100) != HMS_PN532_OK) {
+            fprintf(stderr, "no tag selected\n");
+            return 1;
+        }
+
+        HMS_PN532_Controller *controller = nfc.getController();
+        controller->getMetrics().reset();
+
+        uint32_t opFailures = 0;
+        for (uint32_t i = 0; i < iterations; i++) {
+            uint8_t buffer[4];
+            opFailures += opFirmware(controller) ? 0 : 1;
+            opFailures += controller->mifareultralightReadPage(4, buffer) == HMS_PN532_OK ? 0 : 1;
+        }
+
+        emulator->removeCard();                                                 // One InListPassiveTarget that never answers
+        uint8_t uid[7];
+        uint8_t uidLength = 0;
+        bool timedOut = controller->readPassiveTargetID(HMS_PN532_MIFARE_ISO14443A, uid, uidLength, 50) != HMS_PN532_OK;
+
+        HMS_PN532_CommandMetricsTypeDef entries[HMS_PN532_METRICS_COMMANDS];
+        uint8_t count = controller->getMetrics().snapshot(entries, HMS_PN532_METRICS_COMMANDS);
+        const char *mode = irq ? "irq" : "polling";
+        bool sawFirmware = false, sawListTimeout = false;
+
+        for (uint8_t i = 0; i < count; i++) {
+            const HMS_PN532_CommandMetricsTypeDef &entry = entries[i];
+            uint8_t command = HMS_PN532_Metrics::commandOf(entry);
+            uint32_t failures = 0;
+            if (entry.count == 0) continue;                                     // Slot claimed before the reset
+
+            for (uint8_t phase = 0; phase < HMS_PN532_PHASE_COUNT; phase++) {
+                failures += bucketTotal(entry.latency[phase]) == entry.count ? 0 : 1;
+            }
+
+            if (command == HMS_PN532_COMMAND_GETFIRMWAREVERSION) {              // 1 byte out, TFI + code + 4 bytes back
+                sawFirmware = true;
+                failures += entry.count == iterations && entry.bytesOut == iterations && entry.bytesIn == 6 * iterations ? 0 : 1;
+                failures += bucketMedian(entry.latency[HMS_PN532_PHASE_READY_WAIT]) * 2 >= timing.processingUs ? 0 : 1;
+            }
+            if (command == HMS_PN532_COMMAND_INLISTPASSIVETARGET) {
+                sawListTimeout = entry.responseTimeouts >= 1;
+            }
+
+            printf("{\"case\":\"metrics\",\"mode\":\"%s\",\"command\":\"0x%02X\",\"count\":%u,\"bytes_out\":%u,\"bytes_in\":%u,"
+                   "\"response_timeouts\":%u,\"ack_p50_us\":%u,\"ready_p50_us\":%u,\"transfer_p50_us\":%u,\"failures\":%u}\n",
+                mode, command, entry.count, entry.bytesOut, entry.bytesIn, entry.responseTimeouts,
+                bucketMedian(entry.latency[HMS_PN532_PHASE_ACK_WAIT]),
+                bucketMedian(entry.latency[HMS_PN532_PHASE_READY_WAIT]),
+                bucketMedian(entry.latency[HMS_PN532_PHASE_TRANSFER]), failures);
+            if (failures) result = 1;
+        }
+
+        if (opFailures || !timedOut || !sawFirmware || !sawListTimeout) {
+            fprintf(stderr, "metrics %s: %u failed commands, timeout %s, firmware %s, list timeout %s\n", mode, opFailures,
+                timedOut ? "seen" : "missing", sawFirmware ? "counted" : "missing", sawListTimeout ? "counted" : "missing");
+            result = 1;
+        }
+    }
+
+    return result;
+#else
+    (void)iterations;
+    fprintf(stderr, "the metrics case needs -DHMS_PN532_METRICS_ENABLED=1\n");
+    return 2;
+#endif
+}
+
+static int runReady(uint32_t iterations) {
+    static const struct {
+        const char                              *name;
+        const HMS_PN532_EmulatorTimingTypeDef   *timing;
+        uint8_t                                 hostLink;
+    } links[] = {
+        { "i2c", &HMS_PN532_Interface_Emulator::TIMING_I2C_100K, HMS_PN532_WAKEUP_I2C },
+        { "spi", &HMS_PN532_Interface_Emulator::TIMING_SPI_1M,   HMS_PN532_WAKEUP_SPI },
+    };
+
+    static uint8_t memory[540];                                                 // NTAG215
+    const uint8_t uid[] = { 0x04, 0x11, 0x22, 0x33, 0x44, 0x55, 0x66 };
+    HMS_PN532_EmulatedCard card(HMS_PN532_EMULATED_MIFARE_ULTRALIGHT, uid, 7, memory, sizeof(memory));
+    card.format();
+
+    for (const auto &link : links) {
+        for (uint8_t irq = 0; irq < 2; irq++) {
+            HMS_PN532_Interface_Emulator *emulator = new HMS_PN532_Interface_Emulator(*link.timing);      // HMS_PN532 deletes its interface
+            emulator->setHostLink(link.hostLink);
+            emulator->enableReadyEvent(irq);
+
+            HMS_PN532 nfc(emulator);
+            if (nfc.begin() != HMS_PN532_OK) {
+                fprintf(stderr, "emulated PN532 did not start\n");
+                return 1;
+            }
+            emulator->insertCard(&card);
+
+            HMS_PN532_Controller *controller = nfc.getController();
+            std::vector<uint32_t> firmware, select, page;
+            uint8_t buffer[4];
+
+            for (uint32_t i = 0; i < iterations; i++) {
+                uint32_t start = emulator->pn532Micros();
+                controller->getFirmwareVersion();
+                firmware.push_back(emulator->pn532Micros() - start);
+
+                start = emulator->pn532Micros();
+                nfc.tagAvailable(100);
+                select.push_back(emulator->pn532Micros() - start);
+
+                start = emulator->pn532Micros();
+                controller->mifareultralightReadPage(4, buffer);
+                page.push_back(emulator->pn532Micros() - start);
+            }
+
+            const char *mode = irq ? "irq" : "polling";
+            printLatency(link.name, mode, "getFirmwareVersion", firmware);
+            printLatency(link.name, mode, "tagAvailable", select);
+            printLatency(link.name, mode, "readPage", page);
+        }
+    }
+
+    return 0;
+}
+
+int main(int argc, char **argv) {
+    const char *caseName = "ready";
+    uint32_t iterations = 200;
+
+    for (int i = 1; i + 1 < argc; i += 2) {
+        if (!strcmp(argv[i], "--case"))             caseName = argv[i + 1];
+        else if (!strcmp(argv[i], "--iterations"))  iterations = (uint32_t)atoi(argv[i + 1]);
+    }
+
+    static const struct { const char *name; int (*run)(uint32_t iterations); } cases[] = {
+        { "ready",    runReady    },
+        { "i2c",      runI2C      },
+        { "spi",      runSPI      },
+        { "uart",     runUART     },
+        { "encode",   runEncode   },
+        { "extended", runExtended },
+        { "copies",   runCopies   },
+        { "metrics",  runMetrics  },
+    };
+
+    for (const auto &entry : cases) {
+        if (!strcmp(caseName, entry.name)) return entry.run(iterations);
+    }
+
+    fprintf(stderr, "unknown case %s\n", caseName);
+    return 2;
+}
@@ -2,38 +2,174 @@
 #define HMS_PN532_COMINTERFACE_H
 
 #include "HMS_PN532_Config.h"
+#include "HMS_PN532_ReadySignal.h"
+#include "HMS_PN532_Metrics.h"
+
+typedef struct {
+    const uint8_t   *data;
+    uint16_t        len;
+} HMS_PN532_SegmentTypeDef;                                                                     // One piece of a scatter-gather frame body
 
 class HMS_PN532_Interface {
     public:
+        virtual ~HMS_PN532_Interface() {}
+
         void pn532Delay(uint32_t ms) {
 
             #if defined(HMS_PLATFORM_DESKTOP)
                 std::this_thread::sleep_for(std::chrono::milliseconds(ms));
-            #elif defined(HMS_PN532_PLATFORM_ZEPHYR)
+            #elif defined(HMS_PLATFORM_ZEPHYR)
                 k_msleep(ms);
-            #elif defined(HMS_PN532_PLATFORM_STM32_HAL)
+            #elif defined(HMS_PLATFORM_STM32_HAL)
                 HAL_Delay(ms);
-            #elif defined(HMS_PN532_PLATFORM_ARDUINO) || defined(HMS_PN532_ARDUINO_ESP8266)
+            #elif defined(HMS_PN532_PLATFORM_ARDUINO)
                 delay(ms);
-            #elif defined(HMS_PN532_PLATFORM_ESP_IDF) || (defined(HMS_PN532_PLATFORM_ARDUINO) && defined(HMS_PN532_ARDUINO_ESP32))
+            #elif defined(HMS_PLATFORM_ESP_IDF)
                 vTaskDelay(ms / portTICK_PERIOD_MS);
+            #else
+                #error "pn532Delay() has no delay for this platform"
+            #endif
+        }
+
+        uint32_t pn532Millis() {
+
+            #if defined(HMS_PLATFORM_DESKTOP)
+                return (uint32_t)std::chrono::duration_cast<std::chrono::milliseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()
+                ).count();
+            #elif defined(HMS_PLATFORM_ZEPHYR)
+                return k_uptime_get_32();
+            #elif defined(HMS_PLATFORM_STM32_HAL)
+                return HAL_GetTick();
+            #elif defined(HMS_PN532_PLATFORM_ARDUINO)
+                return millis();
+            #elif defined(HMS_PLATFORM_ESP_IDF)
+                return xTaskGetTickCount() * portTICK_PERIOD_MS;
+            #else
+                #error "pn532Millis() has no clock for this platform"
+            #endif
+        }
+
+        uint32_t pn532Micros() {
+
+            #if defined(HMS_PLATFORM_DESKTOP)
+                return (uint32_t)std::chrono::duration_cast<std::chrono::microseconds>(
+                    std::chrono::steady_clock::now().time_since_epoch()
+                ).count();
+            #elif defined(HMS_PLATFORM_ZEPHYR)
+                return k_cyc_to_us_floor32(k_cycle_get_32());
+            #elif defined(HMS_PLATFORM_STM32_HAL)
+                return HAL_GetTick() * 1000;                                                    // 1 ms resolution
+            #elif defined(HMS_PN532_PLATFORM_ARDUINO)
+                return micros();
+            #elif defined(HMS_PLATFORM_ESP_IDF)
+                return (uint32_t)esp_timer_get_time();
+            #else
+                #error "pn532Micros() has no clock for this platform"
             #endif
         }
 
+        void pn532DelayUntilMicros(uint32_t targetUs) {                                         // Sleeps the bulk, spins the last millisecond
+            int32_t remaining;
+            while ((remaining = (int32_t)(targetUs - pn532Micros())) > 0) {
+                #if defined(HMS_PLATFORM_DESKTOP)
+                    std::this_thread::sleep_for(std::chrono::microseconds(remaining));          // Never spin: emulated buses share the host cores
+                #else
+                    if (remaining > 2000) pn532Delay(remaining / 1000 - 1);
+                #endif
+            }
+        }
+
         virtual HMS_PN532_StatusTypeDef init() = 0;
         virtual HMS_PN532_StatusTypeDef wakeup() = 0;
 
         virtual HMS_PN532_StatusTypeDef read(
-            uint8_t* buffer, uint8_t len, uint16_t timeoutMs = 1000
+            uint8_t* buffer, uint16_t len, uint16_t timeoutMs = 1000
         ) = 0;
 
         virtual HMS_PN532_StatusTypeDef read(
-            uint8_t* buffer, uint8_t len, uint8_t &resLen, uint16_t timeoutMs = 1000
+            uint8_t* buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs
         ) = 0;
         
         virtual HMS_PN532_StatusTypeDef write(
-            const uint8_t *header, uint8_t headerLen, const uint8_t *body = 0, uint8_t bodyLen = 0
+            const HMS_PN532_SegmentTypeDef *segments, uint8_t count
         ) = 0;
+
+        virtual HMS_PN532_StatusTypeDef write(
+            const uint8_t *header, uint16_t headerLen, const uint8_t *body = 0, uint16_t bodyLen = 0
+        ) {
+            const HMS_PN532_SegmentTypeDef segments[] = { { header, headerLen }, { body, bodyLen } };
+            return write(segments, 2);
+        }
+
+        #if HMS_PN532_METRICS_ENABLED
+            HMS_PN532_Metrics &getMetrics()                     { return metrics;                                       }
+        #endif
+
+        virtual bool isResponseReady() {                                                        // Non-blocking: true once read() would not have to wait
+            return readySignal ? readySignal->isAsserted() : true;
+        }
+
+        virtual HMS_PN532_StatusTypeDef waitResponseReady(uint16_t timeoutMs) {                 // Blocks until isResponseReady(), read() then only moves the frame
+            if (readySignal) return readySignal->wait(timeoutMs) ? HMS_PN532_OK : HMS_PN532_TIMEOUT;
+
+            uint32_t start = pn532Millis();
+            while (!isResponseReady()) {
+                if (timeoutMs != 0 && (pn532Millis() - start) >= timeoutMs) return HMS_PN532_TIMEOUT;
+                pn532Delay(1);
+            }
+            return HMS_PN532_OK;
+        }
+
+        virtual uint8_t hostWakeSource() const                  { return 0;                                             }    // HMS_PN532_WAKEUP_* bit of this link, 0 if it cannot wake the PN532
+
+        virtual HMS_PN532_StatusTypeDef resume() {                                              // Leave PowerDown through the host link, the PN532 keeps its configuration
+            return wakeup();
+        }
+
+        virtual bool wakeSignalled() {                                                          // IRQ raised by a PowerDown wake source, never touches the bus
+            return readySignal && readySignal->isAsserted();
+        }
+
+        virtual uint16_t maxInformationLength() const {                                         // TFI + PD bytes a single frame can carry
+            #if HMS_PN532_EXTENDED_FRAMES
+                return HMS_PN532_EXTENDED_INFO_MAX;
+            #else
+                return HMS_PN532_NORMAL_INFO_MAX;
+            #endif
+        }
+
+        virtual void setReadySignal(HMS_PN532_ReadySignal *signal) {                            // nullptr, or a signal with no line behind it, falls back to polling
+            readySignal = signal;
+            if (!readySignal) return;
+
+            readySignal->begin();
+            if (!readySignal->isAvailable()) readySignal = nullptr;
+        }
+
+    protected:
+        HMS_PN532_ReadySignal *readySignal = nullptr;
+        #if HMS_PN532_METRICS_ENABLED
+            HMS_PN532_Metrics metrics;                                                          // Filled by the controller driving this interface
+        #endif
+
+        static uint16_t encodeFrame(
+            uint8_t *frame, const HMS_PN532_SegmentTypeDef *segments, uint8_t count, uint8_t tfi = HMS_PN532_HOSTTOPN532
+        );
+        static HMS_PN532_StatusTypeDef parseFrame(
+            const uint8_t *frame, uint8_t command, uint8_t *buffer, uint16_t len, uint16_t &resLen
+        );                                                                                      // frame points at the preamble
+
+        static uint8_t frameHeaderLength(const uint8_t *frame) {                                // 5 for normal frames, 8 for extended ones
+            return (frame[3] == HMS_PN532_EXTENDED_LEN && frame[4] == HMS_PN532_EXTENDED_LEN) ? 8 : 5;
+        }
+        static uint16_t frameLength(const uint8_t *frame);                                      // Whole frame from its header, 0 if the header is invalid
+
+        uint16_t responseFrameLength(uint16_t len) const {                                      // Largest frame whose payload fits len bytes on this link
+            uint16_t info = maxInformationLength();
+            if ((uint32_t)len + 2 < info) info = len + 2;                                       // TFI and response code ride ahead of the payload
+            return (info > HMS_PN532_NORMAL_INFO_MAX ? 8 : 5) + info + 2;
+        }
 };
 
 #endif // HMS_PN532_COMINTERFACE_H
\ No newline at end of file
@@ -44,17 +44,26 @@
   #endif
   #define HMS_PN532_PLATFORM_ARDUINO
 #elif defined(ESP_PLATFORM)
-  // ESP-IDF specific includes
+  #include <esp_timer.h>                                                               // pn532Micros()
+  #include <freertos/FreeRTOS.h>
+  #include <freertos/task.h>
   #define HMS_PLATFORM_ESP_IDF
 #elif defined(__ZEPHYR__)
-  // Zephyr specific includes
+  #include <zephyr/kernel.h>                                                           // k_msleep(), uptime and cycle counters
   #define HMS_PLATFORM_ZEPHYR
 #elif defined(__STM32__)
   // STM32 HAL specific includes
   #define HMS_PLATFORM_STM32_HAL
 #elif defined(__linux__) || defined(_WIN32) || defined(__APPLE__)
-  // Desktop specific includes
-  // #define HMS_PLATFORM_DESKTOP
+  #include <chrono>
+  #include <string>
+  #include <thread>
+  #include <cstdio>
+  #include <cstdint>
+  #include <cstdlib>
+  #include <cstring>
+  typedef uint8_t byte;
+  #define HMS_PLATFORM_DESKTOP
 #endif // Platform detection
 
 #define HMS_PN532_SPI                                   0x01                           // SPI Communication Interface
@@ -65,43 +74,94 @@
   #define HMS_PN532_COM_INTERFACE                       HMS_PN532_I2C                  // Define the communication interface
 #endif
 
-#if HMS_PN532_COM_INTERFACE == HMS_PN532_I2C                                           // Required for Arduino / ESP32 / ESP8266 platforms
-  #ifndef HMS_PN532_I2C_SDA_PIN
-    #define HMS_PN532_I2C_SDA_PIN                       8                              // I2C SDA Pin
-  #endif
-  #ifndef HMS_PN532_I2C_SCL_PIN
-    #define HMS_PN532_I2C_SCL_PIN                       9                              // I2C SCL Pin
-  #endif
-  #ifndef HMS_PN532_I2C_CLOCK_SPEED
-    #define HMS_PN532_I2C_CLOCK_SPEED                   10000                          // I2C Clock Speed
-  #endif
-#elif HMS_PN532_COM_INTERFACE == HMS_PN532_SPI
-  #ifndef HMS_PN532_SPI_SCK_PIN
-    #define HMS_PN532_SPI_SCK_PIN                       18                             // SPI SCK Pin
-  #endif
-  #ifndef HMS_PN532_SPI_MOSI_PIN
-    #define HMS_PN532_SPI_MOSI_PIN                      23                             // SPI MOSI Pin
-  #endif
-  #ifndef HMS_PN532_SPI_MISO_PIN
-    #define HMS_PN532_SPI_MISO_PIN                      19                             // SPI MISO Pin
-  #endif
-  #ifndef HMS_PN532_SPI_SS_PIN
-    #define HMS_PN532_SPI_SS_PIN                        5                              // SPI SS Pin
-  #endif
-  #ifndef HMS_PN532_SPI_CLOCK_SPEED
-    #define HMS_PN532_SPI_CLOCK_SPEED                   1000000                        // SPI Clock Speed
-  #endif
-#elif HMS_PN532_COM_INTERFACE == HMS_PN532_UART
-  #ifndef HMS_PN532_UART_RX_PIN
-    #define HMS_PN532_UART_RX_PIN                       16                             // UART RX Pin
-  #endif
-  #ifndef HMS_PN532_UART_TX_PIN
-    #define HMS_PN532_UART_TX_PIN                       17                             // UART TX Pin
+// Pin and speed defaults for every interface, so more than one transport can be built at once
+// Required for Arduino / ESP32 / ESP8266 platforms
+#ifndef HMS_PN532_I2C_SDA_PIN
+  #define HMS_PN532_I2C_SDA_PIN                         8                              // I2C SDA Pin
+#endif
+#ifndef HMS_PN532_I2C_SCL_PIN
+  #define HMS_PN532_I2C_SCL_PIN                         9                              // I2C SCL Pin
+#endif
+#ifndef HMS_PN532_I2C_CLOCK_SPEED
+  #define HMS_PN532_I2C_CLOCK_SPEED                     10000                          // I2C Clock Speed
+#endif
+#ifndef HMS_PN532_I2C_SPECULATIVE_READ
+  #define HMS_PN532_I2C_SPECULATIVE_READ                1                              // Poll the status byte, then read the response in one transfer (1=enabled, 0=length read + NACK resend)
+#endif
+#ifndef HMS_PN532_I2C_BUFFER_LENGTH
+  #define HMS_PN532_I2C_BUFFER_LENGTH                   128                            // Arduino Wire transmit/receive buffer size
+#endif
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note:     Extended frames carry up to 265 bytes, e.g. a 65-page     │
+  │           FAST_READ in one exchange, but cost RAM: transports       │
+  │           keep one or two HMS_PN532_FRAME_MAX_LEN buffers on the    │
+  │           stack per read/write and the controller packet buffer     │
+  │           grows to 263 bytes. Default: on for desktop only.         │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+#ifndef HMS_PN532_EXTENDED_FRAMES
+  #if defined(HMS_PLATFORM_DESKTOP)
+    #define HMS_PN532_EXTENDED_FRAMES                   1                              // Use extended information frames for >255-byte payloads (1=enabled, 0=normal frames only)
+  #else
+    #define HMS_PN532_EXTENDED_FRAMES                   0
   #endif
-  #ifndef HMS_PN532_UART_BAUDRATE
-    #define HMS_PN532_UART_BAUDRATE                     115200                         // UART Baudrate
+#endif
+
+#ifndef HMS_PN532_PACKET_BUFFER_LEN
+  #if defined(HMS_PLATFORM_DESKTOP) && HMS_PN532_EXTENDED_FRAMES
+    #define HMS_PN532_PACKET_BUFFER_LEN                 (HMS_PN532_EXTENDED_INFO_MAX - 2)   // Controller receive buffer, response views point into it (largest PD after TFI + response code)
+  #elif defined(HMS_PLATFORM_DESKTOP)
+    #define HMS_PN532_PACKET_BUFFER_LEN                 (HMS_PN532_NORMAL_INFO_MAX - 2)
+  #else
+    #define HMS_PN532_PACKET_BUFFER_LEN                 64                             // Raise it for InDataExchange/InCommunicateThru responses over 63 bytes
   #endif
-#endif // HMS_PN532_COM_INTERFACE
+#endif
+
+#ifndef HMS_PN532_ASYNC_QUEUE_LEN
+  #define HMS_PN532_ASYNC_QUEUE_LEN                     4                              // Commands a controller can hold queued or completed-but-unread
+#endif
+
+#ifndef HMS_PN532_READER_GROUP_QUEUE_LEN
+  #define HMS_PN532_READER_GROUP_QUEUE_LEN              16                             // Tag events a reader group holds before dropping the oldest
+#endif
+
+#ifndef HMS_PN532_SPI_SCK_PIN
+  #define HMS_PN532_SPI_SCK_PIN                         18                             // SPI SCK Pin
+#endif
+#ifndef HMS_PN532_SPI_MOSI_PIN
+  #define HMS_PN532_SPI_MOSI_PIN                        23                             // SPI MOSI Pin
+#endif
+#ifndef HMS_PN532_SPI_MISO_PIN
+  #define HMS_PN532_SPI_MISO_PIN                        19                             // SPI MISO Pin
+#endif
+#ifndef HMS_PN532_SPI_SS_PIN
+  #define HMS_PN532_SPI_SS_PIN                          5                              // SPI SS Pin
+#endif
+#ifndef HMS_PN532_SPI_CLOCK_SPEED
+  #define HMS_PN532_SPI_CLOCK_SPEED                     1000000                        // SPI Clock Speed
+#endif
+#ifndef HMS_PN532_SPI_SPECULATIVE_READ_LEN
+  #define HMS_PN532_SPI_SPECULATIVE_READ_LEN            74                             // DR byte + header + TFI/CMD + 64 data bytes + DCS/postamble
+#endif
+
+#ifndef HMS_PN532_UART_RX_PIN
+  #define HMS_PN532_UART_RX_PIN                         16                             // UART RX Pin
+#endif
+#ifndef HMS_PN532_UART_TX_PIN
+  #define HMS_PN532_UART_TX_PIN                         17                             // UART TX Pin
+#endif
+#ifndef HMS_PN532_UART_BAUDRATE
+  #define HMS_PN532_UART_BAUDRATE                       115200                         // UART Baudrate
+#endif
+#ifndef HMS_PN532_UART_HIGH_BAUDRATE
+  #define HMS_PN532_UART_HIGH_BAUDRATE                  921600                         // Baudrate negotiated after wake-up (= HMS_PN532_UART_BAUDRATE to stay)
+#endif
+
+#ifndef HMS_PN532_IRQ_PIN
+  #define HMS_PN532_IRQ_PIN                             -1                             // PN532 IRQ Pin (-1 = not wired, poll the bus for readiness)
+#endif
 
 /*
   ┌─────────────────────────────────────────────────────────────────────┐
@@ -125,6 +185,47 @@
   #endif
 #endif
 
+#ifndef HMS_PN532_METRICS_ENABLED
+  #define HMS_PN532_METRICS_ENABLED                     0                             // Per-command counters and latency histograms (1=enabled, 0=disabled)
+#endif
+#ifndef HMS_PN532_METRICS_COMMANDS
+  #define HMS_PN532_METRICS_COMMANDS                    16                            // Distinct command codes tracked, later ones are dropped
+#endif
+#ifndef HMS_PN532_METRICS_BUCKETS
+  #define HMS_PN532_METRICS_BUCKETS                     24                            // log2(us) latency buckets, the last one also takes overflow
+#endif
+#ifndef HMS_PN532_COUNT_COPIES
+  #define HMS_PN532_COUNT_COPIES                        0                             // Tally bytes copied out of response views, see HMS_PN532_ResponseView::copiedBytes() (1=enabled, 0=disabled)
+#endif
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note:     Every controller call takes a per-controller recursive    │
+  │           lock; hold HMS_PN532_ControllerLock across sequences.     │
+  │ Requires: std::thread (desktop), FreeRTOS (ESP32) or Zephyr         │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+#ifndef HMS_PN532_THREAD_SAFE
+  #define HMS_PN532_THREAD_SAFE                         0                             // Serialise controller commands across threads (1=enabled, 0=disabled)
+#endif
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note:     readTag() answers a tag seen before from RAM once one     │
+  │           short validation read still matches the cached copy.      │
+  │           ENTRIES and BUDGET (encoded NDEF bytes) bound its memory. │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+#ifndef HMS_PN532_TAG_CACHE_ENTRIES
+  #define HMS_PN532_TAG_CACHE_ENTRIES                   0                             // Decoded tags kept by UID and type, least recently used evicted (0=disabled)
+#endif
+#ifndef HMS_PN532_TAG_CACHE_BUDGET
+  #define HMS_PN532_TAG_CACHE_BUDGET                    1024                          // Encoded NDEF bytes the cache may hold across all entries
+#endif
+#ifndef HMS_PN532_TAG_CACHE_TTL_MS
+  #define HMS_PN532_TAG_CACHE_TTL_MS                    30000                         // ms an entry is trusted before the tag is read in full again
+#endif
+
 
 #define HMS_PN532_DEVICE_NAME                           "PN532"                       // Device Name
 #define HMS_PN532_DEVICE_ADDR                           (0x48 >> 1)                   // PN532 default i2c address w/ AD0 high
@@ -178,17 +279,37 @@
 #define HMS_PN532_COMMAND_TGSETGENERALBYTES             0x92
 #define HMS_PN532_COMMAND_TGSETMETADATA                 0x94
 
+#define HMS_PN532_DIAGNOSE_PRESENCE                     0x06                          // Diagnose NumTst: ISO/IEC14443-4 card presence detection
+
 // ======================================================
 // ================= RESPONSE CODES =====================
 // ======================================================
 #define HMS_PN532_RESPONSE_INDATAEXCHANGE               0x41
 #define HMS_PN532_RESPONSE_INLISTPASSIVETARGET          0x4B
+#define HMS_PN532_RESPONSE_INAUTOPOLL                   0x61
 
 // ======================================================
 // ================= PROTOCOL TYPES =====================
 // ======================================================
 #define HMS_PN532_MIFARE_ISO14443A                      0x00
 
+// ======================================================
+// ================ INAUTOPOLL TARGETS ==================
+// ======================================================
+#define HMS_PN532_AUTOPOLL_GENERIC_106A                 0x00                          // Any passive 106 kbps type A target
+#define HMS_PN532_AUTOPOLL_GENERIC_212                  0x01                          // Any passive 212 kbps target (FeliCa)
+#define HMS_PN532_AUTOPOLL_GENERIC_424                  0x02                          // Any passive 424 kbps target (FeliCa)
+#define HMS_PN532_AUTOPOLL_ISO14443B_106                0x03                          // Passive 106 kbps type B
+#define HMS_PN532_AUTOPOLL_JEWEL_106                    0x04                          // Innovision Jewel / Topaz
+#define HMS_PN532_AUTOPOLL_MIFARE                       0x10                          // MIFARE card
+#define HMS_PN532_AUTOPOLL_FELICA_212                   0x11                          // FeliCa 212 kbps
+#define HMS_PN532_AUTOPOLL_FELICA_424                   0x12                          // FeliCa 424 kbps
+#define HMS_PN532_AUTOPOLL_ISO14443_4A                  0x20                          // ISO/IEC 14443-4 type A
+#define HMS_PN532_AUTOPOLL_ISO14443_4B                  0x23                          // ISO/IEC 14443-4 type B
+#define HMS_PN532_AUTOPOLL_MAX_TYPES                    15                            // Target types one InAutoPoll can cycle through
+#define HMS_PN532_AUTOPOLL_PERIOD_MS                    150                           // ms, unit of the InAutoPoll period
+#define HMS_PN532_AUTOPOLL_FOREVER                      0xFF                          // PollNr: scan until a target shows up
+
 
 // ======================================================
 // ================== MIFARE COMMANDS ===================
@@ -203,6 +324,12 @@
 #define HMS_PN532_MIFARE_CMD_INCREMENT                  0xC1                          // Increment value block
 #define HMS_PN532_MIFARE_CMD_STORE                      0xC2                          // Store data into value block
 
+// ======================================================
+// =================== NTAG COMMANDS ====================
+// ======================================================
+#define HMS_PN532_NTAG_CMD_GET_VERSION                  0x60                          // Vendor, product and memory size (NTAG21x, Ultralight EV1)
+#define HMS_PN532_NTAG_CMD_FAST_READ                    0x3A                          // Read a page range in one exchange (NTAG21x, Ultralight EV1)
+
 // ======================================================
 // ================== FELICA COMMANDS ===================
 // ======================================================
@@ -292,9 +419,34 @@
 #define HMS_PN532_STARTCODE1                            0x00                          // Start code 1 byte
 #define HMS_PN532_STARTCODE2                            0xFF                          // Start code 2 byte
 
+#define HMS_PN532_EXTENDED_LEN                          0xFF                          // LEN/LCS marker of an extended information frame
+#define HMS_PN532_NORMAL_INFO_MAX                       0xFF                          // TFI + PD bytes in a normal information frame
+#define HMS_PN532_EXTENDED_INFO_MAX                     265                           // TFI + PD bytes in an extended information frame
+#if HMS_PN532_EXTENDED_FRAMES
+  #define HMS_PN532_FRAME_MAX_LEN                       (8 + HMS_PN532_EXTENDED_INFO_MAX + 2)   // Header, TFI..PD, DCS + postamble
+#else
+  #define HMS_PN532_FRAME_MAX_LEN                       (5 + HMS_PN532_NORMAL_INFO_MAX + 2)
+#endif
+
 #define HMS_PN532_HOSTTOPN532                           0xD4                          // Host to PN532 direction byte
 #define HMS_PN532_PN532TOHOST                           0xD5                          // PN532 to Host direction byte
 
+#define HMS_PN532_SPI_DATAWRITE                         0x01                          // SPI frame prefix: host writes a frame
+#define HMS_PN532_SPI_STATREAD                          0x02                          // SPI frame prefix: host reads the status byte
+#define HMS_PN532_SPI_DATAREAD                          0x03                          // SPI frame prefix: host reads a frame
+#define HMS_PN532_SPI_READY                             0x01                          // SPI status byte: frame ready
+
+#define HMS_PN532_HSU_WAKEUP_PREAMBLE                   0x55                          // HSU wake-up byte, followed by a run of 0x00
+
+#define HMS_PN532_WAKEUP_I2C                            0x80                          // PowerDown WakeUpEnable: I2C address match
+#define HMS_PN532_WAKEUP_GPIO                           0x40                          // PowerDown WakeUpEnable: P32/P34 edge
+#define HMS_PN532_WAKEUP_SPI                            0x20                          // PowerDown WakeUpEnable: SPI NSS low
+#define HMS_PN532_WAKEUP_HSU                            0x10                          // PowerDown WakeUpEnable: HSU preamble
+#define HMS_PN532_WAKEUP_RF                             0x08                          // PowerDown WakeUpEnable: RF level detector (external field only)
+#define HMS_PN532_WAKEUP_INT1                           0x02                          // PowerDown WakeUpEnable: INT1 pin
+#define HMS_PN532_WAKEUP_INT0                           0x01                          // PowerDown WakeUpEnable: INT0 pin
+#define HMS_PN532_WAKEUP_DELAY_MS                       2                             // ms, oscillator start-up after a host wake
+
 #define HMS_PN532_ACK_WAIT_TIME                         10                            // ms, timeout of waiting for ACK
 
 #define HMS_REVERSE_BITS_ORDER(b)                       \
@@ -304,6 +456,7 @@
   
 #define HMS_PN532_MAX_NDEF_RECORDS                      4                             // Max NDEF records in a message 
 #define HMS_PN532_MAX_CARD_NUM_SCAN                     1                             // Max number of cards to scan
+#define HMS_PN532_MAX_TARGETS                           2                             // InListPassiveTarget MaxTg, the PN532 tracks at most two
 
 
 typedef enum {
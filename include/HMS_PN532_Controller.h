@@ -4,17 +4,145 @@
 #include "HMS_PN532_Config.h"
 #include "HMS_PN532_ComInterface.h"
 
+#if HMS_PN532_THREAD_SAFE
+  #if defined(HMS_PLATFORM_DESKTOP)
+    #include <mutex>
+  #elif defined(HMS_PLATFORM_ESP_IDF) || defined(HMS_PN532_ARDUINO_ESP32)
+    #include <freertos/FreeRTOS.h>
+    #include <freertos/semphr.h>
+  #elif defined(HMS_PLATFORM_ZEPHYR)
+    #include <zephyr/kernel.h>
+  #else
+    #error "HMS_PN532_THREAD_SAFE is enabled but this platform has no supported mutex (desktop, FreeRTOS or Zephyr)."
+  #endif
+#endif
+
+class HMS_PN532_ResponseView {                                                  // Borrowed payload bytes, valid until the controller's next command
+    public:
+        HMS_PN532_ResponseView() {}
+        HMS_PN532_ResponseView(const uint8_t *data, uint16_t len) : viewData(data), viewLen(len) {}
+
+        const uint8_t *data() const                     { return viewData;                  }
+        uint16_t size() const                           { return viewLen;                   }
+        bool empty() const                              { return viewLen == 0;              }
+        uint8_t operator[](uint16_t index) const        { return viewData[index];           }
+
+        uint16_t copyTo(uint8_t *dest, uint16_t destLen) const {                // Only needed when the data must outlive the next command
+            uint16_t n = (viewLen < destLen) ? viewLen : destLen;
+            memcpy(dest, viewData, n);
+            #if HMS_PN532_COUNT_COPIES
+                copiedBytes() += n;
+            #endif
+            return n;
+        }
+
+        #if HMS_PN532_COUNT_COPIES
+            static uint32_t &copiedBytes() {                                    // Every byte that left a view through copyTo(), across all controllers
+                static uint32_t count = 0;
+                return count;
+            }
+        #endif
+
+    private:
+        const uint8_t   *viewData   = nullptr;
+        uint16_t        viewLen     = 0;
+};
+
+typedef uint16_t HMS_PN532_CommandHandle;                                       // 0 is never handed out
+
+typedef void (*HMS_PN532_CommandCallback)(
+    HMS_PN532_CommandHandle handle, HMS_PN532_StatusTypeDef status,
+    const uint8_t *response, uint16_t responseLen, void *context
+);
+
+typedef struct {
+    const HMS_PN532_SegmentTypeDef  *segments;                                  // Command code + parameters, valid until the command completes
+    uint8_t                         segmentCount;
+    uint8_t                         *response;                                  // Payload after the response code
+    uint16_t                        responseSize;
+    uint16_t                        timeoutMs;                                  // 0 waits forever
+    HMS_PN532_CommandCallback       callback;                                   // Optional, fired from poll()
+    void                            *context;
+} HMS_PN532_CommandTypeDef;
+
+typedef enum {
+    HMS_PN532_COMMAND_FREE,
+    HMS_PN532_COMMAND_QUEUED,
+    HMS_PN532_COMMAND_PENDING,                                                  // Written and ACKed, waiting for the response
+    HMS_PN532_COMMAND_DONE
+} HMS_PN532_CommandStateTypeDef;
+
+typedef struct {
+    HMS_PN532_CommandTypeDef        command;
+    HMS_PN532_CommandHandle         handle;
+    HMS_PN532_CommandStateTypeDef   state;
+    HMS_PN532_StatusTypeDef         status;
+    uint16_t                        responseLen;
+    uint32_t                        startedAt;
+    #if HMS_PN532_METRICS_ENABLED
+        uint8_t                     code;                                       // Command code the metrics are keyed by
+        uint32_t                    ackedAtUs;
+    #endif
+} HMS_PN532_CommandSlotTypeDef;
+
+typedef struct {
+    uint8_t                         type;                                       // HMS_PN532_AUTOPOLL_* the target answered to
+    uint8_t                         tg;
+    uint8_t                         uid[10];                                    // NFCID1, FeliCa IDm, type B PUPI or Jewel ID
+    uint8_t                         uidLength;
+    uint16_t                        atqa;                                       // Type A and Jewel SENS_RES
+    uint8_t                         sak;                                        // Type A SEL_RES
+    uint8_t                         ats[20];                                    // ISO14443-4A, TL first
+    uint8_t                         atsLength;
+    uint8_t                         pmm[8];                                     // FeliCa only
+    uint16_t                        systemCode;                                 // FeliCa, 0xFFFF unless the card reported it
+} HMS_PN532_AutoPollTargetTypeDef;
+
+typedef struct {
+    uint8_t                         tg;                                         // Logical number the PN532 gave the target
+    uint16_t                        atqa;                                       // SENS_RES
+    uint8_t                         sak;                                        // SEL_RES
+    uint8_t                         uid[10];                                    // NFCID1
+    uint8_t                         uidLength;
+    uint8_t                         ats[20];                                    // When SAK bit 5 is set, TL first
+    uint8_t                         atsLength;
+} HMS_PN532_TargetTypeDef;
+
 class HMS_PN532_Controller {
 public:
     HMS_PN532_Controller(HMS_PN532_Interface &interface);
     ~HMS_PN532_Controller();
 
     void begin();
+
+    /*
+      ┌─────────────────────────────────────────────────────────────────────┐
+      │ Note: With HMS_PN532_THREAD_SAFE every public call below locks the  │
+      │       controller for its own duration. Sequences that depend on     │
+      │       earlier results (auth then read, a response view, getBuffer)  │
+      │       must hold an HMS_PN532_ControllerLock for the whole sequence. │
+      │       The lock is recursive, so nested calls never deadlock.        │
+      └─────────────────────────────────────────────────────────────────────┘
+    */
+    void lock();
+    void unlock();
+
+    // Asynchronous command API, the blocking methods below are built on it
+    HMS_PN532_CommandHandle submit(const HMS_PN532_CommandTypeDef &command);
+    HMS_PN532_StatusTypeDef poll();                                             // Advance the state machine, HMS_PN532_BUSY while work remains
+    HMS_PN532_StatusTypeDef waitUntil(HMS_PN532_CommandHandle handle, uint32_t timeoutMs = 0, uint16_t *responseLen = nullptr);
+    HMS_PN532_StatusTypeDef getCommandStatus(HMS_PN532_CommandHandle handle, uint16_t *responseLen = nullptr);
+
+    #if HMS_PN532_METRICS_ENABLED
+        HMS_PN532_Metrics &getMetrics()                 { return interface->getMetrics();   }    // Per-command counters and ACK/ready/transfer histograms
+    #endif
+
     uint32_t getFirmwareVersion();
     HMS_PN532_StatusTypeDef samConfig();
-    HMS_PN532_StatusTypeDef tgGetData(uint8_t *buf, uint8_t len);
+    HMS_PN532_StatusTypeDef tgGetData(uint8_t *buf, uint16_t len);
+    HMS_PN532_StatusTypeDef tgGetData(HMS_PN532_ResponseView &data);
     HMS_PN532_StatusTypeDef inRelease(const uint8_t relevantTarget = 0);
-    HMS_PN532_StatusTypeDef tgSetData(const uint8_t *header, uint8_t hlen, const uint8_t *body = 0, uint8_t blen = 0);
+    HMS_PN532_StatusTypeDef tgSetData(const uint8_t *header, uint16_t hlen, const uint8_t *body = 0, uint16_t blen = 0);
 
     uint8_t readGPIO();
     HMS_PN532_StatusTypeDef writeGPIO(uint8_t pinstate);
@@ -35,6 +163,7 @@ public:
     
     HMS_PN532_StatusTypeDef setRFField(uint8_t autoRFCA, uint8_t rFOnOff);
     HMS_PN532_StatusTypeDef setPassiveActivationRetries(uint8_t maxRetries);
+    HMS_PN532_StatusTypeDef powerDown(uint8_t wakeUpEnable, bool generateIrq = false);    // HMS_PN532_WAKEUP_* bits
 
     HMS_PN532_StatusTypeDef tgInitAsTarget(uint16_t timeout = 0);
     HMS_PN532_StatusTypeDef tgInitAsTarget(const uint8_t* command, const uint8_t len, const uint16_t timeout = 0);
@@ -44,35 +173,123 @@ public:
     // ISO14443A functions
     HMS_PN532_StatusTypeDef inListPassiveTarget();
     HMS_PN532_StatusTypeDef readPassiveTargetID(uint8_t cardbaudrate, uint8_t *uid, uint8_t &uidLength, uint16_t timeout = 1000);
+
+    /*
+      ┌─────────────────────────────────────────────────────────────────────┐
+      │ Note: inListPassiveTargets() runs one anticollision pass for up to  │
+      │       HMS_PN532_MAX_TARGETS type A cards and keeps them in a table. │
+      │       The first one is left selected. inSelect() switches the       │
+      │       target every later command goes to, halting the previous one, │
+      │       so each card can be read without polling the field again.     │
+      └─────────────────────────────────────────────────────────────────────┘
+    */
+    HMS_PN532_StatusTypeDef inListPassiveTargets(uint8_t maxTargets = HMS_PN532_MAX_TARGETS, uint16_t timeout = 1000);
+    HMS_PN532_StatusTypeDef inSelect(uint8_t tg);
+    HMS_PN532_StatusTypeDef inDeselect(uint8_t tg = 0);                        // 0 deselects every target, they stay listed
+    uint8_t getTargetCount() const                      { return targetCount;               }
+    const HMS_PN532_TargetTypeDef *getTarget(uint8_t index) const   { return (index < targetCount) ? &targets[index] : nullptr; }
+    HMS_PN532_StatusTypeDef diagnosePresence();                                 // ISO-DEP presence check of the active target, no data exchanged
+    uint8_t getActiveTarget() const                     { return inListedTag;               }    // Tg every InDataExchange goes to
+    HMS_PN532_StatusTypeDef inAutoPoll(
+        const uint8_t *types, uint8_t typeCount, uint8_t pollCount, uint8_t period,
+        HMS_PN532_AutoPollTargetTypeDef &target, uint16_t timeout = 0
+    );                                                                          // First target found, timeout 0 derives it from pollCount x period
+    HMS_PN532_StatusTypeDef inDataExchange(uint8_t *send, uint16_t sendLength, uint8_t *response, uint16_t *responseLength);
     HMS_PN532_StatusTypeDef inDataExchange(uint8_t *send, uint8_t sendLength, uint8_t *response, uint8_t *responseLength);
+    HMS_PN532_StatusTypeDef inDataExchange(const uint8_t *send, uint16_t sendLength, HMS_PN532_ResponseView &response);
+    HMS_PN532_StatusTypeDef inCommunicateThru(
+        const uint8_t *send, uint16_t sendLength, uint8_t *response, uint16_t responseSize, uint16_t *responseLength, uint16_t timeout = 1000
+    );                                                                          // Raw frame to the active target, one copy out of the view below
+    HMS_PN532_StatusTypeDef inCommunicateThru(
+        const uint8_t *send, uint16_t sendLength, HMS_PN532_ResponseView &response, uint16_t timeout = 1000
+    );
 
     // Mifare Classic functions
     HMS_PN532_StatusTypeDef mifareclassicIsFirstBlock (uint32_t uiBlock);
     HMS_PN532_StatusTypeDef mifareclassicIsTrailerBlock (uint32_t uiBlock);
-    HMS_PN532_StatusTypeDef mifareclassicAuthenticateBlock (uint8_t *uid, uint8_t uidLen, uint32_t blockNumber, uint8_t keyNumber, uint8_t *keyData);
+    HMS_PN532_StatusTypeDef mifareclassicAuthenticateBlock (uint8_t *uid, uint8_t uidLen, uint32_t blockNumber, uint8_t keyNumber, uint8_t *keyData);   // No exchange while the same sector, key and UID are still unlocked
+    void mifareclassicInvalidateAuth()                  { authSector = -1;                  }    // After commands sent with submit(), which are not tracked
+    uint32_t getSkippedAuthCount() const                { return authsSkipped;              }
     HMS_PN532_StatusTypeDef mifareclassicReadDataBlock (uint8_t blockNumber, uint8_t *data);
+    HMS_PN532_StatusTypeDef mifareclassicReadDataBlock (uint8_t blockNumber, HMS_PN532_ResponseView &data);
     HMS_PN532_StatusTypeDef mifareclassicWriteDataBlock (uint8_t blockNumber, uint8_t *data);
-    HMS_PN532_StatusTypeDef mifareclassicFormatNDEF ();
+    HMS_PN532_StatusTypeDef mifareclassicFormatNDEF (uint8_t sectors = 16);                               // MAD1 maps sectors 1-15, those past the card's last sector are left free
     HMS_PN532_StatusTypeDef mifareclassicWriteNDEFURI (uint8_t sectorNumber, uint8_t uriIdentifier, const char *url);
 
     // Mifare Ultralight functions
     HMS_PN532_StatusTypeDef mifareultralightReadPage (uint8_t page, uint8_t *buffer);
+    HMS_PN532_StatusTypeDef mifareultralightReadPage (uint8_t page, HMS_PN532_ResponseView &buffer);
+    HMS_PN532_StatusTypeDef mifareultralightReadPages (uint8_t page, uint8_t *buffer);                 // One READ, 16 bytes
+    HMS_PN532_StatusTypeDef mifareultralightReadPages (uint8_t page, HMS_PN532_ResponseView &buffer);
     HMS_PN532_StatusTypeDef mifareultralightWritePage (uint8_t page, uint8_t *buffer);
 
+    // NTAG21x functions
+    HMS_PN532_StatusTypeDef ntagGetVersion(uint8_t *version);                   // 8 bytes; a NAK halts the tag, InSelect wakes it again
+    HMS_PN532_StatusTypeDef ntagFastRead(uint8_t startPage, uint8_t endPage, uint8_t *buffer, uint16_t bufferSize);   // As few frames as the link allows, bufferSize >= pages * 4
+
     uint8_t *getBuffer(uint8_t *len) {
-        *len = sizeof(pn532_packetbuffer) - 4;
+        *len = (sizeof(pn532_packetbuffer) - 4 > 0xFF) ? 0xFF : (uint8_t)(sizeof(pn532_packetbuffer) - 4);   // The buffer may outgrow a uint8_t length
         return pn532_packetbuffer;
     };
 
 private:
-    uint8_t             uid[7];                                         // ISO14443A uid
+    uint8_t             uid[10];                                        // UID of the last Mifare Classic auth
     uint8_t             uidLen;                                         // uid len
-    uint8_t             key[6];                                         // Mifare Classic key
-    uint8_t             inListedTag;                                    // Tg number of inlisted tag.
+    uint8_t             key[6];                                         // Key of the last Mifare Classic auth
+    int16_t             authSector = -1;                                // Sector that auth unlocked, -1 when none is
+    uint8_t             authKeyNumber = 0;                              // 0 = key A, 1 = key B
+    uint8_t             authTg = 0;
+    uint32_t            authsSkipped = 0;
+    uint8_t             inListedTag = 1;                                // Tg number of inlisted tag.
+    HMS_PN532_TargetTypeDef targets[HMS_PN532_MAX_TARGETS] = {};        // From the last type A InListPassiveTarget
+    uint8_t             targetCount = 0;
     uint8_t             felicaIDm[8];                                   // FeliCa IDm (NFCID2)
     uint8_t             felicaPMm[8];                                   // FeliCa PMm (PAD)
-    uint8_t             pn532_packetbuffer[64];
+    uint8_t             pn532_packetbuffer[HMS_PN532_PACKET_BUFFER_LEN];
     HMS_PN532_Interface *interface              = nullptr;
+
+    #if HMS_PN532_THREAD_SAFE
+      #if defined(HMS_PLATFORM_DESKTOP)
+        std::recursive_mutex        commandLock;
+      #elif defined(HMS_PLATFORM_ESP_IDF) || defined(HMS_PN532_ARDUINO_ESP32)
+        SemaphoreHandle_t           commandLock = nullptr;
+      #elif defined(HMS_PLATFORM_ZEPHYR)
+        struct k_mutex              commandLock;
+      #endif
+    #endif
+
+    HMS_PN532_CommandSlotTypeDef    commandSlots[HMS_PN532_ASYNC_QUEUE_LEN] = {};
+    HMS_PN532_CommandSlotTypeDef    *activeSlot = nullptr;
+    HMS_PN532_CommandHandle         nextHandle  = 1;
+
+    HMS_PN532_CommandSlotTypeDef *findSlot(HMS_PN532_CommandHandle handle);
+    bool startNext();                                                           // Write the oldest queued command and take its ACK, false if none is queued
+    void finishActive();                                                        // Read the active command's response, blocking in the interface
+    HMS_PN532_StatusTypeDef parseTargets(uint16_t responseLen);                 // Type A InListPassiveTarget response in pn532_packetbuffer
+    void completeCommand(HMS_PN532_CommandSlotTypeDef *slot, HMS_PN532_StatusTypeDef status, uint16_t responseLen);
+    void trackAuthState(
+        const uint8_t *frame, HMS_PN532_StatusTypeDef status, const uint8_t *response, uint16_t responseLen
+    );                                                                          // Drops the Classic auth once a command may have ended it, frame holds its first 4 bytes
+
+    HMS_PN532_StatusTypeDef transceive(
+        const HMS_PN532_SegmentTypeDef *segments, uint8_t count, uint8_t *response, uint16_t responseSize,
+        uint16_t timeoutMs = 1000, uint16_t *responseLen = nullptr
+    );
+    HMS_PN532_StatusTypeDef transceive(
+        uint16_t requestLen, uint16_t timeoutMs = 1000, uint16_t *responseLen = nullptr
+    );                                                                                          // pn532_packetbuffer in, pn532_packetbuffer out
+};
+
+class HMS_PN532_ControllerLock {                                                // Scoped HMS_PN532_Controller::lock(), a no-op unless HMS_PN532_THREAD_SAFE
+    public:
+        explicit HMS_PN532_ControllerLock(HMS_PN532_Controller &controller) : controller(controller) { controller.lock(); }
+        ~HMS_PN532_ControllerLock()                     { controller.unlock();              }
+
+        HMS_PN532_ControllerLock(const HMS_PN532_ControllerLock &) = delete;
+        HMS_PN532_ControllerLock &operator=(const HMS_PN532_ControllerLock &) = delete;
+
+    private:
+        HMS_PN532_Controller &controller;
 };
 
 #endif // HMS_PN532_CONTROLLER_H
\ No newline at end of file
@@ -33,6 +33,7 @@
 #include "HMS_PN532_Config.h"
 #include "HMS_PN532_NFC_Tag.h"
 #include "HMS_PN532_Controller.h"
+#include "HMS_PN532_TagCache.h"
 
 #include "HMS_PN532_MifareClassic.h"
 #include "HMS_PN532_MifareUltralight.h"
@@ -42,9 +43,11 @@
   #include "HMS_PN532_Interface_I2C.h"
   extern HMS_PN532_Interface_I2C default_interface;
 #elif (HMS_PN532_COM_INTERFACE == HMS_PN532_SPI)
-  // #include "HMS_PN532_Interface_SPI.h"
+  #include "HMS_PN532_Interface_SPI.h"
+  extern HMS_PN532_Interface_SPI default_interface;
 #elif (HMS_PN532_COM_INTERFACE == HMS_PN532_UART)
-  // #include "HMS_PN532_Interface_UART.h"
+  #include "HMS_PN532_Interface_UART.h"
+  extern HMS_PN532_Interface_UART default_interface;
 #else
   #error "Selected HMS_PN532_COM_INTERFACE is not supported. Please choose a valid interface."
 #endif
@@ -55,6 +58,18 @@ typedef enum {
   HMS_PN532_TAG_TYPE_MIFARE_CLASSIC
 } HMS_PN532_TagTypeDef;
 
+typedef enum {
+  HMS_PN532_TAG_FAMILY_UNKNOWN,                                                 // Also every non type A target
+  HMS_PN532_TAG_FAMILY_MIFARE_MINI,
+  HMS_PN532_TAG_FAMILY_MIFARE_CLASSIC_1K,                                       // Also MIFARE Plus 2K in SL1, which answers the same
+  HMS_PN532_TAG_FAMILY_MIFARE_CLASSIC_4K,                                       // Also MIFARE Plus 4K in SL1
+  HMS_PN532_TAG_FAMILY_MIFARE_PLUS_SL1,                                         // SL1 with ISO-DEP (SAK 0x28/0x38), left in ISO-DEP by the automatic RATS
+  HMS_PN532_TAG_FAMILY_ULTRALIGHT,                                              // Ultralight and NTAG, NFC Forum Type 2
+  HMS_PN532_TAG_FAMILY_ISO_DEP                                                  // DESFire, Plus SL3, smart cards, NFC Forum Type 4
+} HMS_PN532_TagFamilyTypeDef;
+
+typedef void (*HMS_PN532_TagRemovedCallback)(const uint8_t *uid, uint8_t uidLength, void *context);
+
 class HMS_PN532 {
   public:
     HMS_PN532(HMS_PN532_Interface *interface = &default_interface);
@@ -62,27 +77,92 @@ class HMS_PN532 {
 
     HMS_PN532_StatusTypeDef begin();
     HMS_PN532_StatusTypeDef tagAvailable(unsigned long timeout=0);
+    HMS_PN532_StatusTypeDef autoPoll(const uint8_t *types, uint8_t typeCount, uint8_t pollCount = 1, uint8_t period = 1);   // Firmware-side scan, HMS_PN532_AUTOPOLL_*
+
+    HMS_PN532_StatusTypeDef idle(uint8_t wakeSources = 0);                        // PowerDown, 0 = host link + RF level detector
+    HMS_PN532_StatusTypeDef resume();                                             // tagAvailable() also resumes on its own
+    bool     isIdle()                           { return idling;             }
+    bool     fieldWakePending()                 { return idling && pn532_interface->wakeSignalled(); }    // Needs an IRQ ready signal
+    uint32_t getWakeToDetectUs()                { return wakeToDetectUs;     }    // Last resume() to first detection, 0 until measured
+
+    /*
+      ┌─────────────────────────────────────────────────────────────────────┐
+      │ Note: isTagStillPresent() checks the tag found by the last          │
+      │       tagAvailable(), autoPoll() or readTags() with one short       │
+      │       transaction: a page read on Type 2, a FeliCa Request          │
+      │       Response, an ISO-DEP presence test or a re-select (Classic).  │
+      │       The first check that fails fires the tag removed callback.    │
+      └─────────────────────────────────────────────────────────────────────┘
+    */
+    bool isTagStillPresent();
+    void onTagRemoved(HMS_PN532_TagRemovedCallback callback, void *context = nullptr) { tagRemovedCallback = callback; tagRemovedContext = context; }
 
     uint8_t* getUid()                           { return uid;                }
     uint8_t  getUidLength()                     { return uidLength;          }
+    uint16_t getAtqa()                          { return atqa;               }    // Type A only, from the last detection
+    uint8_t  getSak()                           { return sak;                }
+    const uint8_t* getAts(uint8_t &length)      { length = atsLength; return ats; }    // ISO-DEP targets, TL first
+    HMS_PN532_TagFamilyTypeDef getTagFamily()   { return tagFamily;          }    // What readTag(), writeTag() and cleanTag() dispatch on
     uint8_t  getFirmwareVersion()               { return firmwareVersion;    }
     uint16_t getChipId()                        { return chipId;             }
+    HMS_PN532_Controller* getController()       { return pn532_controller;   }    // Asynchronous command API
+    const HMS_PN532_AutoPollTargetTypeDef& getAutoPollTarget() { return autoPollTarget; }    // Type-specific data of the last autoPoll() hit
+    const HMS_PN532_Type2InfoTypeDef* getType2Info();                             // GET_VERSION result of the current Type 2 tag, nullptr otherwise
+    #if HMS_PN532_TAG_CACHE_ENTRIES
+        HMS_PN532_TagCache& getTagCache()       { return tagCache;           }    // Hit/miss counters, TTL, clear()
+    #endif
 
-    HMS_PN532_NFC_Tag readTag();
+    HMS_PN532_NFC_Tag readTag();                                                 // Served from the tag cache when HMS_PN532_TAG_CACHE_ENTRIES is set
+    uint8_t readTags(HMS_PN532_NFC_Tag *tags, uint8_t maxTags, unsigned long timeout = 1000);   // Every type A tag in the field from one anticollision pass
     HMS_PN532_StatusTypeDef cleanTag();
     HMS_PN532_StatusTypeDef eraseTag();
     HMS_PN532_StatusTypeDef formatTag();
     HMS_PN532_StatusTypeDef writeTag(HMS_PN532_NDEF_Message& ndefMessage);
 
   private:
-    byte                  uid[7];                                 // Buffer to store the returned UID
+    byte                  uid[10];                                // Buffer to store the returned UID (8-byte FeliCa IDm from autoPoll)
     uint8_t               uidLength;                              // Length of the UID (4 or 7 bytes depending on ISO14443A card type)
     uint8_t               firmwareVersion;
     uint16_t              chipId;
+    uint8_t               targetType = HMS_PN532_AUTOPOLL_GENERIC_106A;   // How the current uid was detected
+    uint16_t              atqa = 0;
+    uint8_t               sak = 0;
+    uint8_t               ats[20];
+    uint8_t               atsLength = 0;
+    HMS_PN532_TagFamilyTypeDef tagFamily = HMS_PN532_TAG_FAMILY_UNKNOWN;
+    HMS_PN532_AutoPollTargetTypeDef autoPollTarget = {};
+    bool                  tagPresent = false;                     // Last detected tag has not been seen leaving
+    HMS_PN532_TagRemovedCallback tagRemovedCallback = nullptr;
+    void                  *tagRemovedContext = nullptr;
+    bool                  idling = false;
+    bool                  wakePending = false;                    // Detection latency still to be measured
+    uint32_t              wakeAtUs = 0;
+    uint32_t              wakeToDetectUs = 0;
     HMS_PN532_Interface   *pn532_interface = nullptr;
     HMS_PN532_Controller  *pn532_controller = nullptr;
 
+    #if HMS_PN532_TAG_CACHE_ENTRIES
+        HMS_PN532_TagCache  tagCache;
+    #endif
+
+    typedef struct {
+        uint8_t                     uid[10];
+        uint8_t                     uidLength;                                // 0 = free
+        HMS_PN532_Type2InfoTypeDef  info;
+    } Type2Slot;
+
+    Type2Slot             type2Slots[HMS_PN532_MAX_TARGETS] = {};  // GET_VERSION results by UID, one probe per tag
+    uint8_t               type2Next = 0;                          // Slot reused next when the UID is new
+
     HMS_PN532_TagTypeDef getTagType();
+    uint8_t classicSectors();                                                   // MIFARECLASSIC_SECTORS_* of the selected Classic tag
+    void setTypeA(uint16_t newAtqa, uint8_t newSak, const uint8_t *newAts, uint8_t newAtsLength);    // Keeps the identity, classifies it
+    HMS_PN532_Type2InfoTypeDef *type2InfoSlot();
+    HMS_PN532_NFC_Tag readTagFromCard();
+    void invalidateCurrentTag();                                                // Drops the cached copy of the selected tag
+    #if HMS_PN532_TAG_CACHE_ENTRIES
+        HMS_PN532_StatusTypeDef readCacheCheck(HMS_PN532_TagTypeDef type, uint8_t *check, uint8_t &checkLength);
+    #endif
 };
 
 #endif // HMS_PN532_DRIVER_H
\ No newline at end of file
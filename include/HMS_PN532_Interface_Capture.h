@@ -0,0 +1,182 @@
+#ifndef HMS_PN532_INTERFACE_CAPTURE_H
+#define HMS_PN532_INTERFACE_CAPTURE_H
+
+#include "HMS_PN532_ComInterface.h"
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: A capture is an append-only run of records, each a 12-byte    │
+  │       little-endian header followed by len payload bytes:           │
+  │         type(1) status(1) len(2) timestampUs(4) durationUs(4)       │
+  │       timestampUs counts from the SESSION record that opens every   │
+  │       recording, so several sessions can share one file. WRITE      │
+  │       payloads are the frame body (command code first, no TFI),     │
+  │       READ payloads the response data (after TFI and code).         │
+  │       INIT carries the wake source bit of the recorded link (v2).   │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+#define HMS_PN532_CAPTURE_VERSION                       0x02                           // Replay also accepts version 1 captures
+#define HMS_PN532_CAPTURE_HEADER_LEN                    12
+#define HMS_PN532_CAPTURE_DATA_MAX                      HMS_PN532_EXTENDED_INFO_MAX    // Longer payloads are truncated
+
+typedef enum {
+  HMS_PN532_CAPTURE_SESSION = 0x00,                                                     // Payload "PNCP" + version
+  HMS_PN532_CAPTURE_INIT    = 0x01,
+  HMS_PN532_CAPTURE_WAKEUP  = 0x02,
+  HMS_PN532_CAPTURE_WRITE   = 0x03,
+  HMS_PN532_CAPTURE_READ    = 0x04,
+  HMS_PN532_CAPTURE_RESUME  = 0x05                                                      // Leaving PowerDown, may differ from a wakeup() on the same link
+} HMS_PN532_CaptureRecordType;
+
+typedef enum {
+  HMS_PN532_REPLAY_FAST,                                                                // Serve every record immediately
+  HMS_PN532_REPLAY_TIMED                                                                // Reproduce the recorded device latency
+} HMS_PN532_ReplayModeTypeDef;
+
+typedef struct {
+    uint8_t                 type;
+    HMS_PN532_StatusTypeDef status;
+    uint16_t                len;                                                        // Payload bytes that follow the header
+    uint32_t                timestampUs;                                                // Call start, relative to the session
+    uint32_t                durationUs;
+} HMS_PN532_CaptureRecordTypeDef;
+
+class HMS_PN532_CaptureStream {
+    public:
+        virtual ~HMS_PN532_CaptureStream() {}
+
+        virtual bool write(const uint8_t *data, uint32_t len) = 0;                      // All or nothing
+        virtual uint32_t read(uint8_t *data, uint32_t len) = 0;                         // Short count at the end of the capture
+
+        bool appendRecord(const HMS_PN532_CaptureRecordTypeDef &record, const HMS_PN532_SegmentTypeDef *segments, uint8_t count);
+        bool nextRecord(HMS_PN532_CaptureRecordTypeDef &record, uint8_t *data, uint16_t maxLen);     // false at the end or on a torn record
+
+    private:
+        uint8_t scratch[HMS_PN532_CAPTURE_HEADER_LEN + HMS_PN532_CAPTURE_DATA_MAX];     // One record is written in a single call
+};
+
+class HMS_PN532_CaptureBuffer : public HMS_PN532_CaptureStream {                        // RAM capture, usable on every platform
+    public:
+        HMS_PN532_CaptureBuffer(uint8_t *buffer, uint32_t size, uint32_t used = 0)
+            : buffer(buffer), size(size), used(used) {}
+
+        bool write(const uint8_t *data, uint32_t len) override;
+        uint32_t read(uint8_t *data, uint32_t len) override;
+
+        void rewind()                                   { position = 0;                                             }
+        uint32_t length() const                         { return used;                                              }
+
+    private:
+        uint8_t     *buffer;
+        uint32_t    size;
+        uint32_t    used;
+        uint32_t    position = 0;
+};
+
+#if defined(HMS_PLATFORM_DESKTOP)
+class HMS_PN532_CaptureFile : public HMS_PN532_CaptureStream {
+    public:
+        HMS_PN532_CaptureFile(const char *path, bool append);                           // append = record, otherwise replay
+        ~HMS_PN532_CaptureFile();
+
+        bool isOpen() const                             { return file != nullptr;                                   }
+        bool write(const uint8_t *data, uint32_t len) override;
+        uint32_t read(uint8_t *data, uint32_t len) override;
+
+    private:
+        FILE        *file = nullptr;
+};
+#endif
+
+class HMS_PN532_Interface_Recorder : public HMS_PN532_Interface {                      // Forwards to a real transport and logs every call
+    public:
+        HMS_PN532_Interface_Recorder(HMS_PN532_Interface *inner, HMS_PN532_CaptureStream *stream)
+            : inner(inner), stream(stream) {}
+
+        HMS_PN532_StatusTypeDef init() override;                                        // Also opens a new SESSION
+        HMS_PN532_StatusTypeDef wakeup() override;
+
+        HMS_PN532_StatusTypeDef read(
+            uint8_t* buffer, uint16_t len, uint16_t timeoutMs = 1000
+        ) override;
+
+        HMS_PN532_StatusTypeDef read(
+            uint8_t* buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs
+        ) override;
+
+        using HMS_PN532_Interface::write;
+        HMS_PN532_StatusTypeDef write(
+            const HMS_PN532_SegmentTypeDef *segments, uint8_t count
+        ) override;
+
+        HMS_PN532_StatusTypeDef resume() override;
+
+        bool isResponseReady() override                 { return inner->isResponseReady();                          }
+        HMS_PN532_StatusTypeDef waitResponseReady(uint16_t timeoutMs) override  { return inner->waitResponseReady(timeoutMs);   }
+        uint16_t maxInformationLength() const override  { return inner->maxInformationLength();                     }
+        uint8_t hostWakeSource() const override         { return inner->hostWakeSource();                           }
+        bool wakeSignalled() override                   { return inner->wakeSignalled();                            }
+        void setReadySignal(HMS_PN532_ReadySignal *signal) override     { inner->setReadySignal(signal);            }    // The transport below owns the line
+
+        bool isTruncated() const                        { return truncated;                                         }    // The stream filled up, later calls went unrecorded
+
+    private:
+        HMS_PN532_Interface     *inner;
+        HMS_PN532_CaptureStream *stream;
+        uint32_t                sessionStart = 0;
+        bool                    started = false;
+        bool                    truncated = false;
+
+        void startSession();
+
+        void record(
+            HMS_PN532_CaptureRecordType type, HMS_PN532_StatusTypeDef status, uint32_t startUs,
+            const HMS_PN532_SegmentTypeDef *segments = nullptr, uint8_t count = 0
+        );
+};
+
+class HMS_PN532_Interface_Replay : public HMS_PN532_Interface {                        // Serves a capture back in place of a transport
+    public:
+        HMS_PN532_Interface_Replay(HMS_PN532_CaptureStream *stream, HMS_PN532_ReplayModeTypeDef mode = HMS_PN532_REPLAY_FAST)
+            : stream(stream), mode(mode) {}
+
+        HMS_PN532_StatusTypeDef init() override;
+        HMS_PN532_StatusTypeDef wakeup() override;
+
+        HMS_PN532_StatusTypeDef read(
+            uint8_t* buffer, uint16_t len, uint16_t timeoutMs = 1000
+        ) override;
+
+        HMS_PN532_StatusTypeDef read(
+            uint8_t* buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs
+        ) override;
+
+        using HMS_PN532_Interface::write;
+        HMS_PN532_StatusTypeDef write(
+            const HMS_PN532_SegmentTypeDef *segments, uint8_t count
+        ) override;                                                                     // HMS_PN532_ERROR if the host diverges from the capture
+
+        HMS_PN532_StatusTypeDef resume() override;
+
+        bool isResponseReady() override;
+        uint8_t hostWakeSource() const override         { return wakeSource;                                        }    // As recorded in INIT
+
+        uint32_t getMismatches() const                  { return mismatches;                                        }
+
+    private:
+        HMS_PN532_CaptureStream         *stream;
+        HMS_PN532_ReplayModeTypeDef     mode;
+        HMS_PN532_CaptureRecordTypeDef  pending;
+        bool                            hasPending = false;
+        uint8_t                         pendingData[HMS_PN532_CAPTURE_DATA_MAX];
+        uint8_t                         previousType = HMS_PN532_CAPTURE_SESSION;
+        uint32_t                        recordedEnd = 0;                                // End of the previous record, capture time
+        uint32_t                        replayedEnd = 0;                                // End of the previous call, replay time
+        uint32_t                        mismatches = 0;
+        uint8_t                         wakeSource = 0;
+
+        const HMS_PN532_CaptureRecordTypeDef *peek();
+        HMS_PN532_StatusTypeDef take(HMS_PN532_CaptureRecordType type, uint32_t startUs);
+};
+
+#endif // HMS_PN532_INTERFACE_CAPTURE_H
@@ -0,0 +1,208 @@
+#ifndef HMS_PN532_INTERFACE_EMULATOR_H
+#define HMS_PN532_INTERFACE_EMULATOR_H
+
+#include "HMS_PN532_ComInterface.h"
+
+#if defined(HMS_PLATFORM_DESKTOP)
+  #include <mutex>
+  #include <condition_variable>
+#endif
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: The emulator is an in-process PN532. Every write() is encoded │
+  │       and checked as a real frame, every read() parses a real       │
+  │       checksummed response frame, and the delays below are slept    │
+  │       so that benchmarks see realistic timing without hardware.     │
+  │       Card memory is a caller-owned image: 16-byte blocks for       │
+  │       MIFARE Classic and FeliCa, 4-byte pages for Ultralight/NTAG.  │
+  │       read() waits the way the host transport would: I2C and SPI    │
+  │       check the status every millisecond, HSU waits for the frame.  │
+  │       enableReadyEvent() raises an HMS_PN532_ReadyEvent when the    │
+  │       response is ready instead, like the PN532 IRQ line.           │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+typedef enum {
+  HMS_PN532_EMULATED_MIFARE_CLASSIC_1K,                                                 // 1024-byte image
+  HMS_PN532_EMULATED_MIFARE_CLASSIC_4K,                                                 // 4096-byte image
+  HMS_PN532_EMULATED_MIFARE_ULTRALIGHT,                                                 // Also NTAG21x/EV1, the image size sets the pages and GET_VERSION
+  HMS_PN532_EMULATED_FELICA                                                             // One service, image holds its blocks
+} HMS_PN532_EmulatedCardType;
+
+typedef struct {
+    uint32_t    busUsPerByte;                                                           // Host link: ~90 at 100 kHz I2C, ~87 at 115200 baud, ~8 at 1 MHz SPI
+    uint32_t    ackUs;                                                                  // Frame received until the ACK is ready
+    uint32_t    processingUs;                                                           // PN532 firmware time per command
+    uint32_t    rfUsPerByte;                                                            // Card link: ~94 at 106 kbps, ~47 at 212 kbps
+    uint32_t    cardResponseUs;                                                         // Card turnaround per exchange (auth, EEPROM write)
+    uint32_t    pollCycleUs;                                                            // One passive activation attempt with nothing in the field
+    uint32_t    wakeUs;                                                                 // PowerDown exit until the first frame is accepted
+} HMS_PN532_EmulatorTimingTypeDef;
+
+class HMS_PN532_EmulatedCard {
+    public:
+        HMS_PN532_EmulatedCard(
+            HMS_PN532_EmulatedCardType type, const uint8_t *uid, uint8_t uidLen, uint8_t *memory, uint32_t memorySize
+        );
+
+        void format();                                                                  // Transport keys / empty NDEF TLV, as shipped
+        bool loadImage(const uint8_t *image, uint32_t len);
+        #if defined(HMS_PLATFORM_DESKTOP)
+            bool loadImage(const char *path);                                           // Raw dump, e.g. from a reader tool
+            bool saveImage(const char *path) const;
+        #endif
+
+        void setIdentity(uint16_t atqa, uint8_t sak)    { cardAtqa = atqa; cardSak = sak;                           }
+        void setFelicaIds(const uint8_t *idm, const uint8_t *pmm, uint16_t systemCode);
+        void setVersion(const uint8_t *version);                                        // GET_VERSION answer, nullptr NAKs it like an original Ultralight
+
+        HMS_PN532_EmulatedCardType getType() const      { return cardType;                                          }
+        const uint8_t *getUid() const                   { return cardUid;                                           }
+        uint8_t getUidLength() const                    { return cardUidLen;                                        }
+        uint16_t getAtqa() const                        { return cardAtqa;                                          }
+        uint8_t getSak() const                          { return cardSak;                                           }
+        const uint8_t *getIdm() const                   { return felicaIdm;                                         }
+        const uint8_t *getVersion() const               { return hasVersion ? cardVersion : nullptr;                }
+        const uint8_t *getPmm() const                   { return felicaPmm;                                         }
+        uint16_t getSystemCode() const                  { return felicaSystemCode;                                  }
+        uint8_t *getMemory()                            { return cardMemory;                                        }
+        uint32_t getMemorySize() const                  { return cardMemorySize;                                    }
+
+    private:
+        HMS_PN532_EmulatedCardType  cardType;
+        uint8_t                     cardUid[10];
+        uint8_t                     cardUidLen;
+        uint16_t                    cardAtqa;
+        uint8_t                     cardSak;
+        uint8_t                     felicaIdm[8];
+        uint8_t                     felicaPmm[8];
+        uint16_t                    felicaSystemCode = 0xFFFF;
+        uint8_t                     cardVersion[8] = {};
+        bool                        hasVersion = false;
+        uint8_t                     ccSize;                                             // CC byte 2 written by format()
+        uint8_t                     *cardMemory;
+        uint32_t                    cardMemorySize;
+};
+
+class HMS_PN532_Interface_Emulator : public HMS_PN532_Interface {
+    public:
+        static const HMS_PN532_EmulatorTimingTypeDef TIMING_NONE;                       // As fast as possible
+        static const HMS_PN532_EmulatorTimingTypeDef TIMING_I2C_100K;
+        static const HMS_PN532_EmulatorTimingTypeDef TIMING_SPI_1M;
+        static const HMS_PN532_EmulatorTimingTypeDef TIMING_HSU_115200;
+
+        HMS_PN532_Interface_Emulator(const HMS_PN532_EmulatorTimingTypeDef &timing = TIMING_I2C_100K)
+            : timing(timing) {}
+        #if defined(HMS_PLATFORM_DESKTOP)
+            ~HMS_PN532_Interface_Emulator();
+        #endif
+
+        HMS_PN532_StatusTypeDef init() override;
+        HMS_PN532_StatusTypeDef wakeup() override;
+
+        HMS_PN532_StatusTypeDef read(
+            uint8_t* buffer, uint16_t len, uint16_t timeoutMs = 1000
+        ) override;
+
+        HMS_PN532_StatusTypeDef read(
+            uint8_t* buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs
+        ) override;
+
+        using HMS_PN532_Interface::write;
+        HMS_PN532_StatusTypeDef write(
+            const HMS_PN532_SegmentTypeDef *segments, uint8_t count
+        ) override;
+
+        bool isResponseReady() override;
+        HMS_PN532_StatusTypeDef waitResponseReady(uint16_t timeoutMs) override;                     // Emulated status polling or IRQ, as read() waits
+
+        HMS_PN532_StatusTypeDef writeRawFrame(const uint8_t *hostFrame, uint16_t len);                      // Byte-level entry for fake I2C, SPI and HSU devices
+        HMS_PN532_StatusTypeDef readRawFrame(uint8_t *buffer, uint16_t size, uint16_t &frameSize, uint16_t timeoutMs);
+
+        uint8_t hostWakeSource() const override         { return hostLink;                                          }
+        uint16_t maxInformationLength() const override  { return maxInfoLength;                                     }
+        HMS_PN532_StatusTypeDef resume() override;
+        bool wakeSignalled() override                   { return wakeIrq;                                           }
+
+        void setTiming(const HMS_PN532_EmulatorTimingTypeDef &newTiming)    { timing = newTiming;                   }
+        void setFirmwareVersion(uint32_t version)       { firmwareVersion = version;                                }
+        void insertCard(HMS_PN532_EmulatedCard *newCard);                               // Replaces the whole field, nullptr empties it
+        bool addCard(HMS_PN532_EmulatedCard *newCard);                                  // Up to HMS_PN532_MAX_TARGETS cards at once
+        void removeCard()                               { insertCard(nullptr);                                      }
+        void setHostLink(uint8_t wakeSource)            { hostLink = wakeSource;                                    }    // HMS_PN532_WAKEUP_I2C, _SPI or _HSU
+        void setMaxInformationLength(uint16_t len) {                                                                            // HMS_PN532_NORMAL_INFO_MAX models a link without extended frames
+            maxInfoLength = len < HMS_PN532_Interface::maxInformationLength() ? len : HMS_PN532_Interface::maxInformationLength();
+        }
+        void applyExternalField();                                                      // A phone or reader field, wakes PowerDown if RF is enabled
+        bool isPoweredDown() const                      { return poweredDown;                                       }
+        #if defined(HMS_PLATFORM_DESKTOP)
+            void enableReadyEvent(bool enable);                                         // Drive the IRQ line from a thread, read() then sleeps on it
+        #endif
+
+        uint32_t getCommandCount() const                { return commandCount;                                      }
+        uint32_t getBytesOut() const                    { return bytesOut;                                          }    // Host frames
+        uint32_t getBytesIn() const                     { return bytesIn;                                           }    // ACKs and response frames
+
+    private:
+        HMS_PN532_EmulatorTimingTypeDef timing;
+        HMS_PN532_EmulatedCard          *field[HMS_PN532_MAX_TARGETS] = {};             // Cards in the RF field
+        HMS_PN532_EmulatedCard          *listed[HMS_PN532_MAX_TARGETS] = {};            // Tg - 1 from the last InListPassiveTarget
+        uint8_t                         listedCount = 0;
+        HMS_PN532_EmulatedCard          *card = nullptr;                                // Selected target
+        uint32_t                        firmwareVersion = 0x32010607;                   // PN532, firmware 1.6, ISO18092 + ISO/IEC14443 A/B
+        uint8_t                         maxRetries = 0xFF;                              // MxRtyPassiveActivation, 0xFF retries forever
+        bool                            targetActive = false;
+        int16_t                         authSector = -1;                                // MIFARE Classic sector unlocked by the last auth
+        uint32_t                        commandCount = 0;
+        uint32_t                        bytesOut = 0;
+        uint32_t                        bytesIn = 0;
+
+        uint8_t                         hostLink = HMS_PN532_WAKEUP_I2C;
+        uint16_t                        maxInfoLength = HMS_PN532_Interface::maxInformationLength();
+        uint8_t                         wakeSources = 0;                                // WakeUpEnable of the last PowerDown
+        bool                            wakeIrqEnabled = false;
+        bool                            powerDownPending = false;                       // Entered once its response has been read
+        bool                            poweredDown = false;
+        bool                            wakeIrq = false;
+
+        uint8_t                         command = 0;
+        bool                            responsePending = false;
+        bool                            responseNever = false;                          // Waiting on a card that is not there
+        uint32_t                        readyAtUs = 0;
+        uint16_t                        frameLen = 0;
+        uint8_t                         frame[HMS_PN532_FRAME_MAX_LEN];                 // Response frame as it would sit in the PN532
+
+        #if defined(HMS_PLATFORM_DESKTOP)
+            HMS_PN532_ReadyEvent        irqEvent;                                       // Set by irqThread at irqAtUs, reset by write() and read()
+            std::thread                 irqThread;
+            std::mutex                  irqLock;
+            std::condition_variable     irqArmed;
+            uint32_t                    irqAtUs = 0;
+            bool                        irqPending = false;
+            bool                        irqStop = false;
+
+            void raiseReadyEvents();
+            void scheduleReadyEvent(bool pending, uint32_t atUs = 0);
+        #endif
+
+        uint32_t busTime(uint16_t bytes) const          { return bytes * timing.busUsPerByte;                       }
+        uint32_t rfTime(uint16_t bytes) const           { return timing.cardResponseUs + bytes * timing.rfUsPerByte;}
+        uint16_t statusBytes() const                    { return hostLink == HMS_PN532_WAKEUP_SPI ? 2 : 10;         }    // SPI status read, I2C status + frame header
+
+        bool waitForResponse(uint16_t timeoutMs);
+        HMS_PN532_StatusTypeDef takeResponse(uint16_t timeoutMs);                      // Waits as read() does, leaves the frame in frame[]
+
+        HMS_PN532_StatusTypeDef checkFrame(const uint8_t *hostFrame, uint16_t len, const uint8_t *&body, uint16_t &bodyLen);
+        bool inField(const HMS_PN532_EmulatedCard *target) const;
+        bool selectTarget(uint8_t tg, uint32_t &busyUs);                                // Switches the selected card to a listed Tg
+        uint16_t execute(const uint8_t *body, uint16_t bodyLen, uint8_t *out, uint32_t &busyUs);
+        uint16_t inListPassiveTarget(const uint8_t *body, uint16_t bodyLen, uint8_t *out, uint32_t &busyUs);
+        uint16_t inAutoPoll(const uint8_t *body, uint16_t bodyLen, uint8_t *out, uint32_t &busyUs);
+        uint16_t inDataExchange(const uint8_t *body, uint16_t bodyLen, uint8_t *out, uint32_t &busyUs);
+        uint16_t inCommunicateThru(const uint8_t *body, uint16_t bodyLen, uint8_t *out, uint32_t &busyUs);
+        uint16_t mifareClassicExchange(const uint8_t *data, uint16_t len, uint8_t *out, uint32_t &busyUs);
+        uint16_t mifareUltralightExchange(const uint8_t *data, uint16_t len, uint8_t *out, uint32_t &busyUs);
+        uint16_t felicaExchange(const uint8_t *data, uint16_t len, uint8_t *out, uint32_t &busyUs);
+};
+
+#endif // HMS_PN532_INTERFACE_EMULATOR_H
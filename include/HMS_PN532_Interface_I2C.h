@@ -26,26 +26,41 @@ class HMS_PN532_Interface_I2C : public HMS_PN532_Interface {
                 TwoWire *theWire = &Wire, uint8_t addr = HMS_PN532_DEVICE_ADDR
             );
         #endif
+        ~HMS_PN532_Interface_I2C();
         
         HMS_PN532_StatusTypeDef init() override;
         HMS_PN532_StatusTypeDef wakeup() override;
 
         HMS_PN532_StatusTypeDef read(
-            uint8_t* buffer, uint8_t len, uint16_t timeoutMs = 1000
+            uint8_t* buffer, uint16_t len, uint16_t timeoutMs = 1000
         ) override;
 
         HMS_PN532_StatusTypeDef read(
-            uint8_t* buffer, uint8_t len, uint8_t &resLen, uint16_t timeoutMs = 1000
+            uint8_t* buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs
         ) override;
 
+        bool isResponseReady() override;                                                                    // Status byte only, the frame is read by read()
+
+        uint8_t hostWakeSource() const override         { return HMS_PN532_WAKEUP_I2C;      }
+        HMS_PN532_StatusTypeDef resume() override;                                                          // Skips the 500 ms power-on settle of wakeup()
+
+        #if defined(HMS_PN532_PLATFORM_ARDUINO)
+            uint16_t maxInformationLength() const override {                                                // Status byte + header + DCS/postamble must fit the Wire buffer
+                uint16_t limit = HMS_PN532_I2C_BUFFER_LENGTH - 11;
+                return limit < HMS_PN532_Interface::maxInformationLength() ? limit : HMS_PN532_Interface::maxInformationLength();
+            }
+        #endif
+
+        using HMS_PN532_Interface::write;
         HMS_PN532_StatusTypeDef write(
-            const uint8_t *header, uint8_t headerLen, const uint8_t *body = 0, uint8_t bodyLen = 0
+            const HMS_PN532_SegmentTypeDef *segments, uint8_t count
         ) override;
 
     private:
         uint8_t command;
         uint8_t deviceAddress;
         #if defined(HMS_PLATFORM_DESKTOP)
+            int pn532_fd = -1;
             const char* pn532_device;
         #elif defined(HMS_PN532_PLATFORM_ZEPHYR)
             struct device *pn532_i2c_dev;
@@ -59,7 +74,12 @@ class HMS_PN532_Interface_I2C : public HMS_PN532_Interface {
         #endif
 
         HMS_PN532_StatusTypeDef readACKFrame();
-        HMS_PN532_StatusTypeDef getResponseLength(uint8_t &length, uint16_t timeoutMs = 1000);
+        HMS_PN532_StatusTypeDef getResponseLength(uint16_t &frameLen, uint16_t timeoutMs = 1000);
+        HMS_PN532_StatusTypeDef readFrame(uint8_t *frame, uint16_t frameLen, uint16_t timeoutMs);          // Poll until the status byte reports ready
+
+    protected:
+        virtual HMS_PN532_StatusTypeDef busRead(uint8_t *data, uint16_t len);                              // One bus transaction per call, a fake bus may override
+        virtual HMS_PN532_StatusTypeDef busWrite(const uint8_t *data, uint16_t len);
 };
 
 #endif // HMS_PN532_INTERFACE_I2C_H
\ No newline at end of file
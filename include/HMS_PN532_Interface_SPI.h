@@ -0,0 +1,61 @@
+#ifndef HMS_PN532_INTERFACE_SPI_H
+#define HMS_PN532_INTERFACE_SPI_H
+
+#include "HMS_PN532_ComInterface.h"
+
+#if defined(HMS_PN532_PLATFORM_ARDUINO)
+  #include <SPI.h>
+#endif
+
+class HMS_PN532_Interface_SPI : public HMS_PN532_Interface {
+    public:
+        #if defined(HMS_PLATFORM_DESKTOP)
+            HMS_PN532_Interface_SPI(
+                const char* device = "/dev/spidev0.0", uint32_t speed = HMS_PN532_SPI_CLOCK_SPEED
+            );
+        #elif defined(HMS_PN532_PLATFORM_ARDUINO) && (defined(HMS_PN532_ARDUINO_ESP32) || defined(HMS_PN532_ARDUINO_ESP8266))
+            HMS_PN532_Interface_SPI(
+                SPIClass *theSPI = &SPI, uint8_t ss = HMS_PN532_SPI_SS_PIN
+            );
+        #endif
+        ~HMS_PN532_Interface_SPI();
+
+        HMS_PN532_StatusTypeDef init() override;
+        HMS_PN532_StatusTypeDef wakeup() override;
+
+        HMS_PN532_StatusTypeDef read(
+            uint8_t* buffer, uint16_t len, uint16_t timeoutMs = 1000
+        ) override;
+
+        HMS_PN532_StatusTypeDef read(
+            uint8_t* buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs
+        ) override;
+
+        bool isResponseReady() override;                                                                    // One status read, no polling loop
+        uint8_t hostWakeSource() const override         { return HMS_PN532_WAKEUP_SPI;      }
+
+        using HMS_PN532_Interface::write;
+        HMS_PN532_StatusTypeDef write(
+            const HMS_PN532_SegmentTypeDef *segments, uint8_t count
+        ) override;
+
+    private:
+        uint8_t command = 0;
+        #if defined(HMS_PLATFORM_DESKTOP)
+            int pn532_fd = -1;
+            bool reverseBits = false;                                                                  // Controller can't shift LSB first, flip bits in software
+            uint32_t clockSpeed;
+            const char* pn532_device;
+        #elif defined(HMS_PN532_PLATFORM_ARDUINO) && (defined(HMS_PN532_ARDUINO_ESP32) || defined(HMS_PN532_ARDUINO_ESP8266))
+            uint8_t ssPin;
+            SPIClass *pn532_spi = NULL;
+        #endif
+
+        HMS_PN532_StatusTypeDef readACKFrame();
+        HMS_PN532_StatusTypeDef waitReady(uint16_t timeoutMs);                                         // Poll the status byte (or sleep on IRQ)
+
+    protected:
+        virtual HMS_PN532_StatusTypeDef transfer(const uint8_t *tx, uint8_t *rx, uint16_t len);        // One full-duplex transfer under a single CS assertion, a fake device may override
+};
+
+#endif // HMS_PN532_INTERFACE_SPI_H
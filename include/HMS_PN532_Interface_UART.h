@@ -0,0 +1,61 @@
+#ifndef HMS_PN532_INTERFACE_UART_H
+#define HMS_PN532_INTERFACE_UART_H
+
+#include "HMS_PN532_ComInterface.h"
+
+class HMS_PN532_Interface_UART : public HMS_PN532_Interface {
+    public:
+        #if defined(HMS_PLATFORM_DESKTOP)
+            HMS_PN532_Interface_UART(
+                const char* device = "/dev/ttyUSB0", uint32_t baudrate = HMS_PN532_UART_BAUDRATE
+            );
+        #elif defined(HMS_PN532_PLATFORM_ARDUINO) && (defined(HMS_PN532_ARDUINO_ESP32) || defined(HMS_PN532_ARDUINO_ESP8266))
+            HMS_PN532_Interface_UART(
+                HardwareSerial *theSerial = &Serial1, uint32_t baudrate = HMS_PN532_UART_BAUDRATE
+            );
+        #endif
+        ~HMS_PN532_Interface_UART();
+
+        HMS_PN532_StatusTypeDef init() override;
+        HMS_PN532_StatusTypeDef wakeup() override;                                                    // HSU wake-up, then escalate to HMS_PN532_UART_HIGH_BAUDRATE
+
+        HMS_PN532_StatusTypeDef read(
+            uint8_t* buffer, uint16_t len, uint16_t timeoutMs = 1000
+        ) override;
+
+        HMS_PN532_StatusTypeDef read(
+            uint8_t* buffer, uint16_t len, uint16_t &resLen, uint16_t timeoutMs
+        ) override;
+
+        bool isResponseReady() override;                                                                    // Response bytes have started to arrive
+        uint8_t hostWakeSource() const override         { return HMS_PN532_WAKEUP_HSU;      }
+
+        using HMS_PN532_Interface::write;
+        HMS_PN532_StatusTypeDef write(
+            const HMS_PN532_SegmentTypeDef *segments, uint8_t count
+        ) override;
+
+        HMS_PN532_StatusTypeDef setBaudRate(uint32_t baudrate);                                        // SetSerialBaudRate (0x10) + host port switch
+        uint32_t getBaudRate() const                    { return currentBaudrate;                                                   }
+
+    private:
+        uint8_t command = 0;
+        uint32_t initialBaudrate;
+        uint32_t currentBaudrate;
+        #if defined(HMS_PLATFORM_DESKTOP)
+            int pn532_fd = -1;
+            const char* pn532_device;
+        #elif defined(HMS_PN532_PLATFORM_ARDUINO) && (defined(HMS_PN532_ARDUINO_ESP32) || defined(HMS_PN532_ARDUINO_ESP8266))
+            HardwareSerial *pn532_serial = NULL;
+        #endif
+
+        HMS_PN532_StatusTypeDef readACKFrame();
+
+        bool portAvailable();
+        void portFlush();                                                                              // Drop anything left in the receive buffer
+        HMS_PN532_StatusTypeDef portSetBaud(uint32_t baudrate);
+        HMS_PN532_StatusTypeDef portWrite(const uint8_t *data, uint16_t len);
+        HMS_PN532_StatusTypeDef portRead(uint8_t *data, uint16_t len, uint16_t timeoutMs);             // Exactly len bytes or HMS_PN532_TIMEOUT
+};
+
+#endif // HMS_PN532_INTERFACE_UART_H
@@ -0,0 +1,55 @@
+#ifndef HMS_PN532_METRICS_H
+#define HMS_PN532_METRICS_H
+
+#include "HMS_PN532_Config.h"
+
+#if HMS_PN532_METRICS_ENABLED
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Counters are updated with relaxed atomic adds and read with   │
+  │       relaxed atomic loads, so recording never takes a lock and a   │
+  │       snapshot can be taken from any thread. Bucket i of a latency  │
+  │       histogram holds samples in [2^i, 2^(i+1)) microseconds.       │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+typedef enum {
+    HMS_PN532_PHASE_ACK_WAIT,                                                   // Frame write until the PN532 ACK
+    HMS_PN532_PHASE_READY_WAIT,                                                 // ACK until the response is ready
+    HMS_PN532_PHASE_TRANSFER,                                                   // Response read off the bus
+    HMS_PN532_PHASE_COUNT
+} HMS_PN532_MetricsPhaseTypeDef;
+
+typedef struct {
+    uint16_t    key;                                                            // Command code + 1, 0 while the slot is unused
+    uint32_t    count;
+    uint32_t    bytesOut;
+    uint32_t    bytesIn;
+    uint32_t    ackTimeouts;
+    uint32_t    responseTimeouts;
+    uint32_t    invalidFrames;                                                  // Bad ACK, bad header or checksum mismatch
+    uint32_t    errors;                                                         // Any other failure
+    uint32_t    latency[HMS_PN532_PHASE_COUNT][HMS_PN532_METRICS_BUCKETS];
+} HMS_PN532_CommandMetricsTypeDef;
+
+class HMS_PN532_Metrics {
+    public:
+        void recordWrite(uint8_t command, uint16_t bytesOut, HMS_PN532_StatusTypeDef status, uint32_t ackWaitUs);
+        void recordRead(uint8_t command, uint16_t bytesIn, HMS_PN532_StatusTypeDef status, uint32_t readyWaitUs, uint32_t transferUs);
+        void recordTimeout(uint8_t command);
+
+        uint8_t snapshot(HMS_PN532_CommandMetricsTypeDef *out, uint8_t maxCommands) const;    // Returns the number of commands copied
+        void reset();
+
+        static uint8_t bucketOf(uint32_t us);
+        static uint8_t commandOf(const HMS_PN532_CommandMetricsTypeDef &entry)   { return (uint8_t)(entry.key - 1); }
+
+    private:
+        HMS_PN532_CommandMetricsTypeDef entries[HMS_PN532_METRICS_COMMANDS] = {};
+
+        HMS_PN532_CommandMetricsTypeDef *entryFor(uint8_t command);
+};
+
+#endif // HMS_PN532_METRICS_ENABLED
+
+#endif // HMS_PN532_METRICS_H
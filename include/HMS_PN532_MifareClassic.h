@@ -16,6 +16,15 @@
 #define MIFARECLASSIC_NR_BLOCK_OF_SHORTSECTOR                 4                                                       // Number of blocks in a short sector
 #define MIFARECLASSIC_NR_BLOCK_OF_LONGSECTOR                  16                                                      // Number of blocks in a long sector
 
+#define MIFARECLASSIC_SECTORS_MINI                            5                                                       // 320 bytes
+#define MIFARECLASSIC_SECTORS_1K                              16
+#define MIFARECLASSIC_SECTORS_4K                              40                                                      // 32 short sectors, then 8 long ones
+#define MIFARECLASSIC_MAD1_SECTORS                            16                                                      // Sector 0 holds MAD1, which maps sectors 1-15 only
+
+#define MIFARECLASSIC_NR_BLOCK_OF_SECTOR(sector)              ( \
+  ((sector) < MIFARECLASSIC_NR_SHORTSECTOR) ? MIFARECLASSIC_NR_BLOCK_OF_SHORTSECTOR : MIFARECLASSIC_NR_BLOCK_OF_LONGSECTOR \
+)
+
 #define MIFARECLASSIC_BLOCK_NUMBER_OF_SECTOR_TRAILER(sector)  ( \
   (                                                             \
     (sector) < MIFARECLASSIC_NR_SHORTSECTOR                     \
@@ -31,10 +40,14 @@
   )                                                             \
 )                                                                                                                   // Determine the sector trailer block based on sector number
 
+#define MIFARECLASSIC_FIRST_BLOCK_OF_SECTOR(sector)           ( \
+  MIFARECLASSIC_BLOCK_NUMBER_OF_SECTOR_TRAILER(sector) + 1 - MIFARECLASSIC_NR_BLOCK_OF_SECTOR(sector) \
+)
+
 
 class HMS_PN532_MifareClassic {
     public:
-        HMS_PN532_MifareClassic(HMS_PN532_Controller& controller);
+        HMS_PN532_MifareClassic(HMS_PN532_Controller& controller, uint8_t sectors = MIFARECLASSIC_SECTORS_1K);   // MIFARECLASSIC_SECTORS_*, from the tag family
         ~HMS_PN532_MifareClassic();
 
         HMS_PN532_NFC_Tag readTag(byte *uid, uint8_t uidLength);
@@ -43,6 +56,10 @@ class HMS_PN532_MifareClassic {
         HMS_PN532_StatusTypeDef writeTag(HMS_PN532_NDEF_Message &ndefMessage, byte *uid, uint8_t uidLength);
     private:
         HMS_PN532_Controller *controller;
+        uint8_t sectors;
+
+        uint8_t ndefSectors() const;                                            // Sectors 1 up to this one carry the NDEF TLV
+        int ndefCapacity() const;                                               // Bytes, data blocks of those sectors
 
         int getNdefStartIndex(byte *data);
         int getBufferSize(int messageLength);
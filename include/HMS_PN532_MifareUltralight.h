@@ -8,18 +8,39 @@
 #define MIFAREULTRALIGHT_TYPE_NAME                  "NFC Forum Type 2"
 
 #define MIFAREULTRALIGHT_PAGE_SIZE                  4
-#define MIFAREULTRALIGHT_READ_SIZE                  4
+#define MIFAREULTRALIGHT_READ_SIZE                  16                      // READ returns four pages
 
+#define MIFAREULTRALIGHT_CC_PAGE                    3
 #define MIFAREULTRALIGHT_DATA_START_PAGE            4
 #define MIFAREULTRALIGHT_MESSAGE_LENGTH_INDEX       1
 #define MIFAREULTRALIGHT_DATA_START_INDEX           2
-#define MIFAREULTRALIGHT_MAX_PAGE                   63
+
+typedef enum {
+    HMS_PN532_TYPE2_NOT_PROBED,
+    HMS_PN532_TYPE2_ULTRALIGHT,                                                 // NAKs GET_VERSION: MF0ICU1 or Ultralight C
+    HMS_PN532_TYPE2_ULTRALIGHT_EV1,
+    HMS_PN532_TYPE2_NTAG210,
+    HMS_PN532_TYPE2_NTAG212,
+    HMS_PN532_TYPE2_NTAG213,
+    HMS_PN532_TYPE2_NTAG215,
+    HMS_PN532_TYPE2_NTAG216,
+    HMS_PN532_TYPE2_OTHER                                                       // Answers GET_VERSION, product or size not known here
+} HMS_PN532_Type2ModelTypeDef;
+
+typedef struct {
+    HMS_PN532_Type2ModelTypeDef model;
+    uint8_t                     version[8];                                     // GET_VERSION response, zeros when NAKed
+    uint16_t                    userBytes;                                      // User memory from the storage size, 0 leaves it to the CC
+} HMS_PN532_Type2InfoTypeDef;
 
 class HMS_PN532_MifareUltralight {
     public:
-        HMS_PN532_MifareUltralight(HMS_PN532_Controller& controller);
+        HMS_PN532_MifareUltralight(HMS_PN532_Controller& controller, HMS_PN532_Type2InfoTypeDef *info = nullptr);   // info: probe result kept by the caller
         ~HMS_PN532_MifareUltralight();
 
+        bool identify();                                                        // GET_VERSION once per info, false when the tag is gone
+        const HMS_PN532_Type2InfoTypeDef& getInfo() const   { return *info;     }
+
         HMS_PN532_StatusTypeDef cleanTag();
         HMS_PN532_NFC_Tag readTag(byte *uid, uint8_t uidLength);
         HMS_PN532_StatusTypeDef writeTag(HMS_PN532_NDEF_Message& ndefMessage, byte *uid, uint8_t uidLength);
@@ -30,11 +51,13 @@ class HMS_PN532_MifareUltralight {
         unsigned int            bufferSize;
         unsigned int            ndefStartIndex;
         HMS_PN532_Controller    *controller;
+        HMS_PN532_Type2InfoTypeDef  ownInfo = {};
+        HMS_PN532_Type2InfoTypeDef  *info;
 
-        bool isUnformatted();
-        void findNdefMessage();
+        bool readHeader(byte *header);                                          // Identifies the tag, reads pages 3-6, sets tagCapacity
+        bool isUnformatted(const byte *header);
+        void findNdefMessage(const byte *header);
         void calculateBufferSize();
-        void readCapabilityContainer();
 };
 
 #endif // HMS_PN532_MIFAREULTRALIGHT_H
\ No newline at end of file
@@ -12,6 +12,7 @@ class HMS_PN532_NFC_Tag {
         HMS_PN532_NFC_Tag(byte *uid, unsigned int uidLength, std::string tagType, HMS_PN532_NDEF_Message& ndefMessage);
         HMS_PN532_NFC_Tag(byte *uid, unsigned int uidLength, std::string tagType, const byte *ndefData, const int ndefDataLength);
 
+        HMS_PN532_NFC_Tag(const HMS_PN532_NFC_Tag& rhs);
         ~HMS_PN532_NFC_Tag();
 
         HMS_PN532_NFC_Tag& operator=(const HMS_PN532_NFC_Tag& rhs);
@@ -26,7 +27,7 @@ class HMS_PN532_NFC_Tag {
         std::string getUidString();
 
     private:
-        byte                        *uid;
+        byte                        uid[10];                                    // Copied, the reader's buffer changes with the next scan
         std::string                 tagType;                                    // Mifare Classic, NFC Forum Type {1,2,3,4}, Unknown
         unsigned int                uidLength;
         HMS_PN532_NDEF_Message      *ndefMessage;
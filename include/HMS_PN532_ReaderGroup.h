@@ -0,0 +1,88 @@
+#ifndef HMS_PN532_READERGROUP_H
+#define HMS_PN532_READERGROUP_H
+
+#include "HMS_PN532_DRIVER.h"
+
+#if defined(HMS_PLATFORM_DESKTOP) || defined(HMS_PN532_ARDUINO_ESP32)
+#include <mutex>
+#include <atomic>
+#include <deque>
+#include <vector>
+#include <thread>
+#include <condition_variable>
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: Each reader is tagged with the bus it sits on. A worker only  │
+  │       takes a reader whose bus no other worker is using, so readers │
+  │       sharing a bus are serialised while readers on different buses │
+  │       run in parallel, up to the number of workers. Readers are     │
+  │       visited round-robin and every tag seen lands in one queue.    │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+typedef struct {
+    uint8_t     workers;                                                        // Worker threads, at most one per bus is ever busy
+    uint16_t    pollTimeoutMs;                                                  // tagAvailable() timeout per visit
+    bool        readNdef;                                                       // readTag() after detection, otherwise UID only
+    uint16_t    repeatMs;                                                       // Same UID on the same reader is reported once per window
+    uint16_t    retryMs;                                                        // Back-off after a reader fails begin()
+} HMS_PN532_ReaderGroupConfigTypeDef;
+
+typedef struct {
+    uint8_t                 reader;                                             // Index returned by addReader()
+    uint32_t                timestampMs;
+    HMS_PN532_NFC_Tag       tag;
+} HMS_PN532_TagEventTypeDef;
+
+class HMS_PN532_ReaderGroup {
+    public:
+        static const HMS_PN532_ReaderGroupConfigTypeDef DEFAULT_CONFIG;
+
+        HMS_PN532_ReaderGroup(const HMS_PN532_ReaderGroupConfigTypeDef &config = DEFAULT_CONFIG) : config(config) {}
+        ~HMS_PN532_ReaderGroup();
+
+        int16_t addReader(HMS_PN532_Interface *interface, uint8_t bus);        // Takes ownership, -1 when full or running
+        HMS_PN532 *getReader(uint8_t reader);                                   // Drive only while stopped, unless HMS_PN532_THREAD_SAFE
+
+        HMS_PN532_StatusTypeDef start();
+        void stop();                                                            // Finishes the visits in progress, then joins the workers
+
+        bool pollEvent(HMS_PN532_TagEventTypeDef &event);
+        bool waitEvent(HMS_PN532_TagEventTypeDef &event, uint32_t timeoutMs);   // timeoutMs = 0 waits forever
+
+        uint32_t getScanCount() const                   { return scans;                     }    // tagAvailable() calls across all readers
+        uint32_t getDroppedEvents() const               { return dropped;                   }    // Oldest events pushed out of a full queue
+
+    private:
+        typedef struct {
+            HMS_PN532   *nfc;
+            uint8_t     bus;
+            bool        started;
+            bool        busy;
+            uint32_t    retryAt;
+            uint8_t     lastUid[10];
+            uint8_t     lastUidLength;
+            uint32_t    lastSeenAt;
+        } ReaderSlot;
+
+        HMS_PN532_ReaderGroupConfigTypeDef      config;
+        std::vector<ReaderSlot>                 readers;
+        std::vector<std::thread>                workers;
+        std::deque<HMS_PN532_TagEventTypeDef>   events;
+        std::mutex                              lock;
+        std::condition_variable                 readerFreed;
+        std::condition_variable                 eventAdded;
+        bool                                    busBusy[256] = {};
+        uint8_t                                 cursor = 0;                     // Next reader in the round-robin
+        bool                                    running = false;
+        std::atomic<uint32_t>                   scans{0};
+        std::atomic<uint32_t>                   dropped{0};
+
+        void workerLoop();
+        int16_t nextReader(uint32_t now);                                       // Caller holds lock
+        void visit(ReaderSlot &slot, uint8_t index);
+        uint32_t groupMillis();
+};
+#endif
+
+#endif // HMS_PN532_READERGROUP_H
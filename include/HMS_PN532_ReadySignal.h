@@ -0,0 +1,67 @@
+#ifndef HMS_PN532_READYSIGNAL_H
+#define HMS_PN532_READYSIGNAL_H
+
+#include "HMS_PN532_Config.h"
+
+#if defined(HMS_PLATFORM_DESKTOP)
+  #include <mutex>
+  #include <condition_variable>
+#elif defined(HMS_PN532_ARDUINO_ESP32)
+  #include <freertos/semphr.h>
+#endif
+
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: The PN532 pulls its IRQ line low while a frame (ACK or        │
+  │       response) is waiting to be read. A ready signal lets the      │
+  │       transport sleep on that line instead of polling the bus.      │
+  │       wait() returns true once the line is asserted; timeoutMs = 0  │
+  │       waits forever. isAsserted() checks the level without waiting. │
+  │       A signal that is not wired (isAvailable() false) is dropped   │
+  │       by setReadySignal() and the transport polls the bus instead.  │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+class HMS_PN532_ReadySignal {
+    public:
+        virtual ~HMS_PN532_ReadySignal() {}
+
+        virtual void begin() {}
+        virtual bool isAvailable()          { return true; }
+        virtual bool wait(uint32_t timeoutMs) = 0;
+        virtual bool isAsserted() = 0;
+};
+
+#if defined(HMS_PLATFORM_DESKTOP)
+class HMS_PN532_ReadyEvent : public HMS_PN532_ReadySignal {                        // Set/reset by a GPIO monitor thread or a simulated device
+    public:
+        void set();
+        void reset();
+        bool wait(uint32_t timeoutMs) override;
+        bool isAsserted() override;
+
+    private:
+        bool                    asserted = false;
+        std::mutex              lock;
+        std::condition_variable changed;
+};
+#elif defined(HMS_PN532_PLATFORM_ARDUINO)
+class HMS_PN532_ReadyPin : public HMS_PN532_ReadySignal {                          // PN532 IRQ wired to a GPIO
+    public:
+        HMS_PN532_ReadyPin(int pin = HMS_PN532_IRQ_PIN) : irqPin(pin) {}
+        ~HMS_PN532_ReadyPin();
+
+        void begin() override;
+        bool isAvailable() override         { return irqPin >= 0; }
+        bool wait(uint32_t timeoutMs) override;
+        bool isAsserted() override          { return irqPin < 0 || digitalRead(irqPin) == LOW; }          // No pin: let the status read decide
+
+    private:
+        int                 irqPin;
+        #if defined(HMS_PN532_ARDUINO_ESP32)
+            SemaphoreHandle_t   irqSemaphore = nullptr;
+            static void IRAM_ATTR onFallingEdge(void *arg);
+        #endif
+};
+#endif
+
+#endif // HMS_PN532_READYSIGNAL_H
@@ -0,0 +1,69 @@
+#ifndef HMS_PN532_TAGCACHE_H
+#define HMS_PN532_TAGCACHE_H
+
+#include "HMS_PN532_Config.h"
+#include "HMS_PN532_NFC_Tag.h"
+
+#if HMS_PN532_TAG_CACHE_ENTRIES
+/*
+  ┌─────────────────────────────────────────────────────────────────────┐
+  │ Note: An entry is served only while it is younger than the TTL and  │
+  │       the check bytes read from the tag still match the ones stored │
+  │       with it. The check covers the start of the NDEF TLV, so a     │
+  │       rewrite by another reader that keeps the same length and      │
+  │       first bytes is only noticed once the TTL runs out.            │
+  └─────────────────────────────────────────────────────────────────────┘
+*/
+typedef struct {
+    uint32_t    hits;
+    uint32_t    misses;                                                         // No entry, expired or the check bytes differed
+    uint32_t    evictions;                                                      // Pushed out by the entry count or the byte budget
+    uint32_t    invalidations;                                                  // Dropped by a write through the driver
+} HMS_PN532_TagCacheStatsTypeDef;
+
+class HMS_PN532_TagCache {
+    public:
+        HMS_PN532_TagCache(uint32_t ttlMs = HMS_PN532_TAG_CACHE_TTL_MS) : ttlMs(ttlMs) {}
+
+        const HMS_PN532_NFC_Tag *lookup(
+            const uint8_t *uid, uint8_t uidLength, uint8_t tagType, const uint8_t *check, uint8_t checkLength, uint32_t nowMs
+        );
+        void store(
+            const HMS_PN532_NFC_Tag &tag, const uint8_t *uid, uint8_t uidLength, uint8_t tagType,
+            const uint8_t *check, uint8_t checkLength, uint32_t nowMs
+        );
+        void invalidate(const uint8_t *uid, uint8_t uidLength);                 // Every tag type stored under that UID
+        void clear();
+
+        void setTtl(uint32_t newTtlMs)                  { ttlMs = newTtlMs;                 }
+        uint16_t getUsedBytes() const                   { return usedBytes;                 }
+        const HMS_PN532_TagCacheStatsTypeDef &getStats() const  { return stats;             }
+        void resetStats()                               { stats = {};                       }
+
+    private:
+        typedef struct {
+            bool                used;
+            uint8_t             uid[10];
+            uint8_t             uidLength;
+            uint8_t             tagType;                                        // HMS_PN532_TagTypeDef of the driver
+            uint8_t             check[16];
+            uint8_t             checkLength;
+            uint16_t            cost;                                           // Encoded NDEF bytes, counted against the budget
+            uint32_t            storedAtMs;
+            uint32_t            lastUsed;                                       // useClock value of the last hit or store
+            HMS_PN532_NFC_Tag   tag;
+        } Entry;
+
+        Entry                           entries[HMS_PN532_TAG_CACHE_ENTRIES] = {};
+        uint32_t                        ttlMs;
+        uint32_t                        useClock = 0;
+        uint16_t                        usedBytes = 0;
+        HMS_PN532_TagCacheStatsTypeDef  stats = {};
+
+        Entry *find(const uint8_t *uid, uint8_t uidLength, uint8_t tagType);
+        void drop(Entry &entry);
+        Entry *evictOldest();
+};
+#endif
+
+#endif // HMS_PN532_TAGCACHE_H